@@ -0,0 +1,189 @@
+#include "ACAnalysis.hpp"
+#include "Parallel.hpp"
+#include "Resistor.hpp"
+#include "Capacitor.hpp"
+#include "Inductor.hpp"
+#include "ACVoltageSource.hpp"
+#include "NonlinearComponent.hpp"
+#include "ReducedNetwork.hpp"
+#include <cmath>
+#include <memory>
+
+namespace ecim {
+    namespace {
+        typedef std::complex<double> Complex;
+        typedef Eigen::SparseMatrix<Complex> ComplexMatrix;
+        typedef std::vector<Eigen::Triplet<double>> Triplets;
+
+        int RowOf(const Node* node) {
+            return node ? node->Index : -1;
+        }
+
+        // Two-terminal admittance stamp
+        void StampAdmittance(Triplets& triplets, int i, int j, double value) {
+            if (i >= 0) triplets.emplace_back(i, i, value);
+            if (j >= 0) triplets.emplace_back(j, j, value);
+            if (i >= 0 && j >= 0) {
+                triplets.emplace_back(i, j, -value);
+                triplets.emplace_back(j, i, -value);
+            }
+        }
+
+        // Per-thread factorization, the pattern is analyzed on first use
+        struct Worker {
+            ComplexMatrix Y;
+            Eigen::SparseLU<ComplexMatrix, Eigen::COLAMDOrdering<int>> lu;
+            bool analyzed = false;
+        };
+    }
+
+    ACAnalysis::ACAnalysis(CircuitBuilder& circuit) : m_Circuit(circuit) {}
+
+    int ACAnalysis::AddProbe(const Node* node) {
+        m_Probes.push_back(node);
+        return static_cast<int>(m_Probes.size()) - 1;
+    }
+
+    void ACAnalysis::SetExcitation(const VoltageSource* source, std::complex<double> phasor) {
+        m_Excitations[source] = phasor;
+    }
+
+    std::vector<ACPoint> ACAnalysis::Run(const std::vector<double>& frequencies) {
+        if (!m_Circuit.IsCompiled()) m_Circuit.Compile();
+        const int nodeRows = m_Circuit.GetNodeRowCount();
+
+        // Reduced networks keep their internal states as extra rows past the circuit's
+        int size = m_Circuit.GetMatrixSize();
+        for (auto network : m_Circuit.GetReducedNetworks()) size += network->GetStateCount();
+
+        // G, C and B entries, each padded with explicit zeros at the others' positions
+        // so that all three compress to the same pattern and value layout
+        Triplets g, c, b;
+        for (auto resistor : m_Circuit.GetResistors()) {
+            StampAdmittance(g, RowOf(resistor->GetNode1()), RowOf(resistor->GetNode2()), 1.0 / resistor->GetResistance());
+        }
+        for (auto capacitor : m_Circuit.GetCapacitors()) {
+            StampAdmittance(c, RowOf(capacitor->GetNode1()), RowOf(capacitor->GetNode2()), capacitor->GetCapacitance());
+        }
+        for (auto inductor : m_Circuit.GetInductors()) {
+            StampAdmittance(b, RowOf(inductor->GetNode1()), RowOf(inductor->GetNode2()), 1.0 / inductor->GetInductance());
+        }
+
+        int stateRow = m_Circuit.GetMatrixSize();
+        for (auto network : m_Circuit.GetReducedNetworks()) {
+            const int ports = static_cast<int>(network->GetPortCount());
+            const int order = ports + network->GetStateCount();
+            std::vector<int> rows(order);
+            for (int k = 0; k < ports; k++) rows[k] = RowOf(network->GetPort(k));
+            for (int k = ports; k < order; k++) rows[k] = stateRow++;
+
+            const Eigen::MatrixXd& Gr = network->GetConductanceMatrix();
+            const Eigen::MatrixXd& Cr = network->GetCapacitanceMatrix();
+            for (int a = 0; a < order; a++) {
+                if (rows[a] < 0) continue;
+                for (int b = 0; b < order; b++) {
+                    if (rows[b] < 0) continue;
+                    if (Gr(a, b) != 0.0) g.emplace_back(rows[a], rows[b], Gr(a, b));
+                    if (Cr(a, b) != 0.0) c.emplace_back(rows[a], rows[b], Cr(a, b));
+                }
+            }
+        }
+
+        // Nonlinear devices contribute their small-signal conductances, linearized at
+        // the present node voltages (normally the DC operating point)
+        Eigen::VectorXd unused = Eigen::VectorXd::Zero(size);
+        SimulationState state{nullptr, &g, unused, 0.0, -1, m_Circuit.GetCurrentTime()};
+        for (auto device : m_Circuit.GetNonlinearComponents()) {
+            device->Update(0.0);
+            device->Stamp(state);
+        }
+
+        // Sources: branch rows as in the transient system, excitation in the right-hand side
+        Eigen::VectorXcd u = Eigen::VectorXcd::Zero(size);
+        const auto& sources = m_Circuit.GetVoltageSources();
+        for (size_t k = 0; k < sources.size(); k++) {
+            int row = nodeRows + static_cast<int>(k);
+            int i = RowOf(sources[k]->GetNode1());
+            int j = RowOf(sources[k]->GetNode2());
+            if (i >= 0) { g.emplace_back(i, row, 1.0); g.emplace_back(row, i, 1.0); }
+            if (j >= 0) { g.emplace_back(j, row, -1.0); g.emplace_back(row, j, -1.0); }
+
+            auto excitation = m_Excitations.find(sources[k]);
+            if (excitation != m_Excitations.end()) {
+                u(row) = excitation->second;
+            } else if (auto ac = dynamic_cast<const ACVoltageSource*>(sources[k])) {
+                u(row) = std::polar(ac->GetAmplitude(), ac->GetPhase());
+            }
+        }
+
+        auto padded = [&](const Triplets& values) {
+            Triplets all;
+            all.reserve(g.size() + c.size() + b.size());
+            for (auto list : {&g, &c, &b}) {
+                for (auto& t : *list) all.emplace_back(t.row(), t.col(), list == &values ? t.value() : 0.0);
+            }
+            SparseMatrix matrix(size, size);
+            matrix.setFromTriplets(all.begin(), all.end());
+            return matrix;
+        };
+        const SparseMatrix G = padded(g), C = padded(c), B = padded(b);
+        const int nnz = static_cast<int>(G.nonZeros());
+
+        std::vector<int> probeRows;
+        for (auto node : m_Probes) probeRows.push_back(RowOf(node));
+
+        std::vector<ACPoint> results(frequencies.size());
+        int threads = m_ThreadCount > 0 ? m_ThreadCount : DefaultThreadCount();
+        std::vector<std::unique_ptr<Worker>> workers(threads);
+
+        ParallelFor(frequencies.size(), threads, [&](size_t point, int index) {
+            if (!workers[index]) {
+                workers[index].reset(new Worker());
+                workers[index]->Y = G.cast<Complex>();
+            }
+            Worker& worker = *workers[index];
+
+            // Y = G + jwC + B/(jw), written straight into the shared value layout
+            const double omega = 2.0 * 3.14159265358979323846 * frequencies[point];
+            Complex* y = worker.Y.valuePtr();
+            const double *gv = G.valuePtr(), *cv = C.valuePtr(), *bv = B.valuePtr();
+            for (int k = 0; k < nnz; k++) y[k] = Complex(gv[k], omega * cv[k] - bv[k] / omega);
+
+            if (!worker.analyzed) {
+                worker.lu.analyzePattern(worker.Y);
+                worker.analyzed = true;
+            }
+            worker.lu.factorize(worker.Y);
+
+            ACPoint& result = results[point];
+            result.frequency = frequencies[point];
+            if (worker.lu.info() != Eigen::Success) {
+                result.values.assign(probeRows.size(), Complex(NAN, NAN));  // Singular at this frequency
+                return;
+            }
+            result.values.assign(probeRows.size(), Complex(0.0, 0.0));     // Ground probes stay at 0
+            Eigen::VectorXcd x = worker.lu.solve(u);
+            for (size_t p = 0; p < probeRows.size(); p++) {
+                if (probeRows[p] >= 0) result.values[p] = x(probeRows[p]);
+            }
+        });
+
+        return results;
+    }
+
+    std::vector<ACPoint> ACAnalysis::Sweep(double startHz, double stopHz, int points) {
+        return Run(LogSpace(startHz, stopHz, points));
+    }
+
+    std::vector<double> ACAnalysis::LogSpace(double start, double stop, int points) {
+        std::vector<double> values;
+        if (points <= 0 || start <= 0.0 || stop <= 0.0) return values;
+        if (points == 1) return {start};
+
+        const double first = std::log10(start);
+        const double step = (std::log10(stop) - first) / (points - 1);
+        for (int k = 0; k < points; k++) values.push_back(std::pow(10.0, first + k * step));
+        values.back() = stop;
+        return values;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <complex>
+#include <unordered_map>
+#include <vector>
+#include "CircuitBuilder.hpp"
+
+namespace ecim {
+    // Node phasors at one frequency of an AC analysis
+    struct ACPoint {
+        double frequency = 0.0;                         // Hz
+        std::vector<std::complex<double>> values;       // One phasor per probe
+
+        double Magnitude(int probe) const { return std::abs(values[probe]); }
+        double Phase(int probe) const { return std::arg(values[probe]); }   // Radians
+        double MagnitudeDb(int probe) const { return 20.0 * std::log10(Magnitude(probe)); }
+    };
+
+    // Small-signal frequency-domain analysis. The circuit is linearized into the
+    // complex MNA system (G + jwC + B/(jw)) x = u: resistors and source incidence
+    // go into G, capacitors into C and inductors into B. The three matrices share one
+    // sparsity pattern, so every frequency only refills the values. Points are solved
+    // in parallel, each worker thread analyzing the pattern once.
+    //
+    // ACVoltageSources drive the circuit with their amplitude and phase (as the
+    // phasor of amplitude * sin(wt + phase)), other sources are small-signal shorts.
+    // Nonlinear devices are linearized at the present node voltages, so solve the
+    // operating point first (CircuitBuilder::SolveOperatingPoint()).
+    class ACAnalysis {
+        CircuitBuilder& m_Circuit;
+        std::vector<const Node*> m_Probes;
+        std::unordered_map<const VoltageSource*, std::complex<double>> m_Excitations;
+        int m_ThreadCount = 0;
+
+    public:
+        ACAnalysis(CircuitBuilder& circuit);
+
+        // Record a node phasor at every frequency, returns the probe index
+        int AddProbe(const Node* node);
+
+        // Override the excitation phasor of a source (e.g. 0 to silence an AC source,
+        // or 1 to turn a DC source into the small-signal input)
+        void SetExcitation(const VoltageSource* source, std::complex<double> phasor);
+
+        // Worker threads, 0 = hardware concurrency
+        void SetThreadCount(int threads) { m_ThreadCount = threads; }
+        int GetThreadCount() const { return m_ThreadCount; }
+
+        // Solve at every frequency (Hz, > 0), results in the same order
+        std::vector<ACPoint> Run(const std::vector<double>& frequencies);
+
+        // Solve at `points` log-spaced frequencies from startHz to stopHz inclusive
+        std::vector<ACPoint> Sweep(double startHz, double stopHz, int points);
+
+        static std::vector<double> LogSpace(double start, double stop, int points);
+    };
+}
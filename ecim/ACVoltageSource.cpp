@@ -8,4 +8,27 @@ namespace ecim {
         const double PI = 3.14159265358979323846;
         return m_Amplitude * std::sin(2.0 * PI * m_Frequency * time + m_Phase);
     }
+
+    void ACVoltageSource::EvaluateBlock(double start, double step, int count, double* values) const {
+        const double PI = 3.14159265358979323846;
+        const double delta = 2.0 * PI * m_Frequency * step;
+        const double cosDelta = std::cos(delta), sinDelta = std::sin(delta);
+
+        // sin/cos of the angle advanced by the angle-addition recurrence, re-seeded
+        // exactly every few samples so rounding can't accumulate
+        const int reseed = 64;
+        double s = 0.0, c = 1.0;
+        for (int k = 0; k < count; k++) {
+            if (k % reseed == 0) {
+                double angle = 2.0 * PI * m_Frequency * (start + k * step) + m_Phase;
+                s = std::sin(angle);
+                c = std::cos(angle);
+            } else {
+                double next = s * cosDelta + c * sinDelta;
+                c = c * cosDelta - s * sinDelta;
+                s = next;
+            }
+            values[k] = m_Amplitude * s;
+        }
+    }
 }
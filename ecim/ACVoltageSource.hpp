@@ -15,10 +15,20 @@ namespace ecim {
     public:
         ACVoltageSource(double amplitude, double frequency, double phase = 0.0);
         double GetVoltage(double time) const override;
+        // Rotates the phasor by the step angle instead of calling sin() per sample
+        void EvaluateBlock(double start, double step, int count, double* values) const override;
+        Component* Clone() const override { return new ACVoltageSource(*this); }
         
         // Getters for AC parameters
         double GetAmplitude() const { return m_Amplitude; }
         double GetFrequency() const { return m_Frequency; }
         double GetPhase() const { return m_Phase; }
+
+        // Setters for AC parameters
+        void SetAmplitude(double amplitude) { m_Amplitude = amplitude; }
+        void SetFrequency(double frequency) { m_Frequency = frequency; }
+        void SetPhase(double phase) { m_Phase = phase; }
     };
+
+    template <> struct ArenaSkipsDestructor<ACVoltageSource> : std::true_type {};
 }
@@ -0,0 +1,46 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace ecim {
+    Arena::Arena(size_t blockSize) : m_BlockSize(std::max<size_t>(blockSize, 256)) {}
+
+    Arena::~Arena() {
+        Release();
+    }
+
+    void* Arena::Allocate(size_t size, size_t alignment) {
+        if (!m_Blocks.empty()) {
+            Block& block = m_Blocks.back();
+            std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data.get());
+            size_t offset = ((base + block.used + alignment - 1) & ~(alignment - 1)) - base;
+            if (offset + size <= block.size) {
+                block.used = offset + size;
+                m_BytesUsed += size;
+                return block.data.get() + offset;
+            }
+        }
+
+        // New block, doubling so the block count stays logarithmic in the circuit size
+        size_t blockSize = m_Blocks.empty() ? m_BlockSize : 2 * m_Blocks.back().size;
+        blockSize = std::max(blockSize, size + alignment);
+        m_Blocks.push_back({std::unique_ptr<char[]>(new char[blockSize]), blockSize, 0});
+        return Allocate(size, alignment);
+    }
+
+    bool Arena::Owns(const void* pointer) const {
+        const char* p = static_cast<const char*>(pointer);
+        for (const auto& block : m_Blocks) {
+            if (p >= block.data.get() && p < block.data.get() + block.used) return true;
+        }
+        return false;
+    }
+
+    void Arena::Release() {
+        // Reverse creation order, like the destruction of locals
+        for (auto it = m_Destructors.rbegin(); it != m_Destructors.rend(); ++it) it->destroy(it->object);
+        m_Destructors.clear();
+        m_Blocks.clear();
+        m_BytesUsed = 0;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecim {
+    // Whether an Arena may skip T's destructor when it is released. True for trivially
+    // destructible types. Types whose destructor does nothing but can't be trivial
+    // (it is virtual, as for every Component) opt in by specializing this next to
+    // their definition. That is only allowed for types that own no resources, and
+    // it doesn't carry over to derived classes.
+    template <class T>
+    struct ArenaSkipsDestructor : std::is_trivially_destructible<T> {};
+
+    // Bump allocator for the nodes and components of one circuit. Objects are placed
+    // back to back in large blocks (in creation order, so a circuit built in order is
+    // laid out in order) and are all released together: blocks are freed wholesale
+    // and only objects that need it (see ArenaSkipsDestructor) get a destructor call.
+    // Nodes and the built-in components other than PWL, custom sources and reduced
+    // networks don't, so releasing a circuit of them costs one free per block.
+    class Arena {
+        struct Block {
+            std::unique_ptr<char[]> data;
+            size_t size;
+            size_t used;
+        };
+        struct Destructor {
+            void (*destroy)(void*);
+            void* object;
+        };
+
+        std::vector<Block> m_Blocks;
+        std::vector<Destructor> m_Destructors;
+        size_t m_BlockSize;
+        size_t m_BytesUsed = 0;
+
+    public:
+        // Blocks start at blockSize bytes and double as the arena grows
+        explicit Arena(size_t blockSize = 64 * 1024);
+        ~Arena();
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* Allocate(size_t size, size_t alignment);
+
+        template <class T, class... Args>
+        T* Create(Args&&... args) {
+            T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if (!ArenaSkipsDestructor<T>::value) {
+                m_Destructors.push_back({[](void* p) { static_cast<T*>(p)->~T(); }, object});
+            }
+            return object;
+        }
+
+        // True if pointer lies in memory handed out by this arena
+        bool Owns(const void* pointer) const;
+
+        // Destroy every object and free every block
+        void Release();
+
+        size_t GetBytesUsed() const { return m_BytesUsed; }
+        size_t GetBlockCount() const { return m_Blocks.size(); }
+        // Objects whose destructor Release() will call
+        size_t GetDestructorCount() const { return m_Destructors.size(); }
+    };
+}
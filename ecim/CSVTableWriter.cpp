@@ -0,0 +1,56 @@
+#include "CSVTableWriter.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace ecim {
+    namespace {
+        // Longest std::to_chars output of a double ("-2.2250738585072014e-308") plus the separator
+        const size_t MaxFieldLength = 32;
+    }
+
+    CSVTableWriter::CSVTableWriter(std::ostream& out, size_t bufferSize)
+        : m_Out(out), m_Buffer(std::max<size_t>(bufferSize, 4 * MaxFieldLength)) {}
+
+    bool CSVTableWriter::AddColumn(const std::string& label, const std::string& unit) {
+        if (m_HeaderWritten) return false;
+        m_Labels.push_back(label);
+        return true;
+    }
+
+    void CSVTableWriter::WriteBuffer() {
+        m_Out.write(m_Buffer.data(), m_Used);
+        m_Used = 0;
+    }
+
+    void CSVTableWriter::Append(double time, const double* values) {
+        if (!m_HeaderWritten) {
+            std::string header = "time";
+            for (const auto& label : m_Labels) header += "," + label;
+            header += '\n';
+            m_Out.write(header.data(), header.size());
+            m_HeaderWritten = true;
+        }
+
+        // Make room for the longest possible row; rows are never split across writes
+        const size_t rowLength = (m_Labels.size() + 1) * MaxFieldLength;
+        if (m_Used + rowLength > m_Buffer.size()) WriteBuffer();
+        if (rowLength > m_Buffer.size()) m_Buffer.resize(rowLength);
+
+        char* position = m_Buffer.data() + m_Used;
+        char* const end = m_Buffer.data() + m_Buffer.size();
+        position = std::to_chars(position, end, time).ptr;
+        for (size_t k = 0; k < m_Labels.size(); k++) {
+            *position++ = ',';
+            position = std::to_chars(position, end, values[k]).ptr;
+        }
+        *position++ = '\n';
+        m_Used = position - m_Buffer.data();
+        m_Rows++;
+    }
+
+    void CSVTableWriter::Flush() {
+        if (m_Used == 0) return;
+        WriteBuffer();
+        m_Out.flush();
+    }
+}
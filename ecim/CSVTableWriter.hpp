@@ -0,0 +1,35 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "SampleWriter.hpp"
+
+namespace ecim {
+    // Wide CSV table: a "time,<label>,..." header and then one row per time with
+    // a value for every column. Numbers are formatted with std::to_chars (the
+    // shortest text that reads back to the same double) into a large buffer that
+    // is written to the stream whenever it fills up. The destructor doesn't touch
+    // the stream: rows that weren't flushed are dropped.
+    class CSVTableWriter : public SampleWriter {
+        std::ostream& m_Out;
+        std::vector<std::string> m_Labels;
+        std::vector<char> m_Buffer;
+        size_t m_Used = 0;
+        size_t m_Rows = 0;
+        bool m_HeaderWritten = false;
+
+        void WriteBuffer();
+
+    public:
+        // out must outlive the writer; bufferSize bytes are collected per write
+        CSVTableWriter(std::ostream& out, size_t bufferSize = 1 << 16);
+
+        // The unit isn't part of the header; labels are written as given
+        bool AddColumn(const std::string& label, const std::string& unit = "") override;
+        void Append(double time, const double* values) override;
+        void Flush() override;
+        size_t GetRowCount() const override { return m_Rows; }
+        size_t GetColumnCount() const { return m_Labels.size(); }
+    };
+}
@@ -2,29 +2,28 @@
 
 namespace ecim {
     Capacitor::Capacitor(double capacitance) 
-        : m_Capacitance(capacitance), m_Voltage(0.0), m_Current(0.0) {}
-
-    // For transient analysis using backward Euler method
-    // The capacitor is modeled as: I = C * dV/dt
-    // Using backward Euler: I(t) = C * (V(t) - V(t-dt)) / dt
-    // Rearranging: V(t) = V(t-dt) + I(t) * dt / C
-    // This is equivalent to: I(t) = (C/dt) * V(t) - (C/dt) * V(t-dt)
-    // Which looks like a conductance (C/dt) with a current source -(C/dt)*V(t-dt)
+        : m_Capacitance(capacitance), m_Current(0.0) {}
+
+    // For transient analysis the capacitor is modeled as: I = C * dV/dt
+    // The integration method approximates dV/dt = alpha * V(t) - beta, e.g.
+    // backward Euler: dV/dt = (V(t) - V(t-dt)) / dt
+    // This gives: I(t) = (alpha*C) * V(t) - beta*C
+    // Which looks like a conductance (alpha*C) with a current source beta*C
     void Capacitor::Stamp(SimulationState &state) {
         if (state.dt <= 0.0) return;
 
-        double Geq = m_Capacitance / state.dt;  // Equivalent conductance
-        double Ieq = Geq * m_Voltage;           // Equivalent current source
+        double Geq, Ieq;    // Equivalent conductance and current source
+        BeginStep(state.dt, state.method, Geq, Ieq);
 
-        int i = (m_Node1 && m_Node1->Id > 0) ? m_Node1->Id - 1 : -1;
-        int j = (m_Node2 && m_Node2->Id > 0) ? m_Node2->Id - 1 : -1;
+        int i = m_Node1 ? m_Node1->Index : -1;
+        int j = m_Node2 ? m_Node2->Index : -1;
 
         // Add equivalent conductance (like resistor)
-        if (i >= 0) state.G(i, i) += Geq;
-        if (j >= 0) state.G(j, j) += Geq;
+        if (i >= 0) state.StampG(i, i, Geq);
+        if (j >= 0) state.StampG(j, j, Geq);
         if (i >= 0 && j >= 0) {
-            state.G(i, j) -= Geq;
-            state.G(j, i) -= Geq;
+            state.StampG(i, j, -Geq);
+            state.StampG(j, i, -Geq);
         }
 
         // Add equivalent current source
@@ -32,11 +31,59 @@ namespace ecim {
         if (j >= 0) state.I(j) -= Ieq;
     }
 
-    void Capacitor::UpdateState() {
-        // Update voltage across capacitor for next timestep
-        if (m_Node1 && m_Node2) {
-            m_Voltage = m_Node1->Voltage - m_Node2->Voltage;
+    void Capacitor::BeginStep(double dt, IntegrationMethod method, double& conductance, double& current) {
+        m_Method = method;
+        m_StepDt = dt;
+        if (dt <= 0.0) {
+            conductance = current = 0.0;
+            return;
         }
+        m_History.Companion(dt, method, m_Alpha, m_Beta);
+        conductance = m_Alpha * m_Capacitance;
+        current = m_Beta * m_Capacitance;
+    }
+
+    void Capacitor::UpdateState() {
+        AcceptVoltage(GetSolvedVoltage());
+    }
+
+    void Capacitor::AcceptVoltage(double voltage) {
+        // Update voltage history and current for next timestep
+        if (m_StepDt <= 0.0) return;
+
+        double derivative = m_Alpha * voltage - m_Beta;
+        m_Current = m_Capacitance * derivative;
+        m_History.Accept(voltage, m_StepDt, derivative);
+    }
+
+    void Capacitor::SaveState(double* values) const {
+        values[0] = m_Current;
+        m_History.Save(values + 1);
+    }
+
+    void Capacitor::RestoreState(const double* values) {
+        m_Current = values[0];
+        m_History.Restore(values + 1);
+    }
+
+    void Capacitor::SetInitialVoltage(double voltage) {
+        m_History.Reset(voltage);
+        m_Current = 0.0;
+    }
+
+    double Capacitor::GetSolvedVoltage() const {
+        return (m_Node1 ? m_Node1->Voltage : 0.0) - (m_Node2 ? m_Node2->Voltage : 0.0);
+    }
+
+    double Capacitor::GetCompanionConductance(double dt, IntegrationMethod method) const {
+        double alpha, beta;
+        m_History.Companion(dt, method, alpha, beta);
+        return alpha * m_Capacitance;
+    }
+
+    double Capacitor::EstimateError(double relTol, double absTol) const {
+        if (m_StepDt <= 0.0) return 0.0;
+        return m_History.EstimateError(GetSolvedVoltage(), m_StepDt, m_Method, relTol, absTol);
     }
 
     double Capacitor::GetCurrent() const {
@@ -5,14 +5,49 @@
 namespace ecim {
     class Capacitor : public Component {
         double m_Capacitance = 0.0;
-        double m_Voltage = 0.0;      // Voltage across capacitor at previous timestep
-        double m_Current = 0.0;       // Current through capacitor
+        double m_Current = 0.0;       // Current through capacitor at previous timestep
+        IntegrationHistory m_History; // Voltage across capacitor at previous timesteps
+
+        // Companion model of the step being solved: I = m_Alpha * C * V - m_Beta * C
+        IntegrationMethod m_Method = IntegrationMethod::BackwardEuler;
+        double m_StepDt = 0.0;
+        double m_Alpha = 0.0, m_Beta = 0.0;
+
+        double GetSolvedVoltage() const;
 
     public:
         Capacitor(double capacitance);
         void Stamp(SimulationState &state) override;
+        Component* Clone() const override { return new Capacitor(*this); }
+        size_t GetStateSize() const override { return 1 + IntegrationHistory::StateSize; }
+        void SaveState(double* values) const override;
+        void RestoreState(const double* values) override;
         void UpdateState();
+
+        // Companion model for a step of length dt: the conductance and the current it
+        // injects into node1. Stamp() and CircuitBuilder's packed loops both use it.
+        void BeginStep(double dt, IntegrationMethod method, double& conductance, double& current);
+        // UpdateState() with the solved voltage across the capacitor already known
+        void AcceptVoltage(double voltage);
         double GetCurrent() const;
         void SetCurrent(double current);
+
+        double GetCapacitance() const { return m_Capacitance; }
+        void SetCapacitance(double capacitance) { m_Capacitance = capacitance; }
+
+        // Voltage across the capacitor at the last accepted step
+        double GetVoltage() const { return m_History.GetValue(); }
+
+        // Start the next transient from a steady-state voltage (zero current)
+        void SetInitialVoltage(double voltage);
+
+        // Equivalent conductance of the companion model for a step of length dt
+        double GetCompanionConductance(double dt, IntegrationMethod method) const;
+
+        // Local truncation error of the step just solved (before UpdateState()),
+        // relative to relTol * |V| + absTol. Values above 1 mean the step is too long.
+        double EstimateError(double relTol, double absTol) const;
     };
+
+    template <> struct ArenaSkipsDestructor<Capacitor> : std::true_type {};
 }
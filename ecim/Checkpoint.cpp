@@ -0,0 +1,86 @@
+#include "Checkpoint.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace ecim {
+    namespace {
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;     // ByteOrderMark as the writer stored it
+            double time;
+            double nextStep;
+            uint64_t nodeCount;
+            uint64_t stateCount;
+            uint64_t solutionCount;
+        };
+
+        const char Magic[8] = {'E', 'C', 'I', 'M', 'C', 'K', 'P', 'T'};
+        const uint32_t ByteOrderMark = 0x01020304;
+
+        void WriteValues(std::ofstream& out, const std::vector<double>& values) {
+            if (!values.empty()) out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+        }
+
+        bool ReadValues(std::ifstream& in, std::vector<double>& values, uint64_t count) {
+            values.resize(count);
+            if (count > 0) in.read(reinterpret_cast<char*>(values.data()), count * sizeof(double));
+            return static_cast<bool>(in);
+        }
+    }
+
+    bool Checkpoint::Write(const std::string& path) const {
+        Header header = {};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.byteOrder = ByteOrderMark;
+        header.time = time;
+        header.nextStep = nextStep;
+        header.nodeCount = nodeVoltages.size();
+        header.stateCount = componentState.size();
+        header.solutionCount = solution.size();
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteValues(out, nodeVoltages);
+        WriteValues(out, componentState);
+        WriteValues(out, solution);
+        return static_cast<bool>(out);
+    }
+
+    bool Checkpoint::Read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        in.seekg(0, std::ios::end);
+        const uint64_t size = static_cast<uint64_t>(in.tellg());
+        in.seekg(0, std::ios::beg);
+
+        Header header;
+        if (size < sizeof(Header) || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.byteOrder != ByteOrderMark ||
+            header.version != Version) {
+            return false;
+        }
+        // The counts must account for the file exactly (this also bounds them)
+        const uint64_t values = (size - sizeof(Header)) / sizeof(double);
+        if ((size - sizeof(Header)) % sizeof(double) != 0 || header.nodeCount > values ||
+            header.stateCount > values - header.nodeCount ||
+            header.solutionCount != values - header.nodeCount - header.stateCount) {
+            return false;
+        }
+
+        Checkpoint read;
+        read.time = header.time;
+        read.nextStep = header.nextStep;
+        if (!ReadValues(in, read.nodeVoltages, header.nodeCount) ||
+            !ReadValues(in, read.componentState, header.stateCount) ||
+            !ReadValues(in, read.solution, header.solutionCount)) {
+            return false;
+        }
+        *this = std::move(read);
+        return true;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ecim {
+    // Dynamic state of a circuit at one instant: the clock, node voltages and the
+    // state of every component (capacitor voltages, inductor currents, source
+    // currents, integration history, device linearizations). Taken with
+    // CircuitBuilder::SaveCheckpoint() and applied with RestoreCheckpoint() to the
+    // same circuit, a Clone() of it or one loaded from its CircuitSnapshot, so a
+    // common prefix can be simulated once and continued many times.
+    struct Checkpoint {
+        static const unsigned Version = 1;
+
+        double time = 0.0;
+        double nextStep = 0.0;                  // Step SimulateAdaptive() would take next
+        std::vector<double> nodeVoltages;       // By matrix row
+        std::vector<double> componentState;     // Component::SaveState() of each component in compiled order
+        std::vector<double> solution;           // Last MNA solution (warm start of iterative solvers)
+
+        // Compact binary file: a small header followed by the three arrays, in the
+        // machine's byte order. Read() returns false for a missing, damaged or
+        // foreign file and leaves the checkpoint unchanged.
+        bool Write(const std::string& path) const;
+        bool Read(const std::string& path);
+    };
+}
@@ -1,144 +1,939 @@
 #include "CircuitBuilder.hpp"
 #include "VoltageSource.hpp"
+#include "DCVoltageSource.hpp"
+#include "ACVoltageSource.hpp"
 #include "Resistor.hpp"
 #include "Capacitor.hpp"
 #include "Inductor.hpp"
+#include "NonlinearComponent.hpp"
+#include "ReducedNetwork.hpp"
+#include "GraphPartition.hpp"
 #include <algorithm>
+#include <cmath>
+#include <unordered_map>
 
 namespace ecim {
     CircuitBuilder::~CircuitBuilder() {
-        for (auto comp : m_Components) delete comp;
-        for (auto node : m_Nodes) delete node;
+        // Arena objects are released with m_Arena
+        for (auto comp : m_OwnedComponents) delete comp;
+        for (auto node : m_OwnedNodes) delete node;
     }
 
     void CircuitBuilder::AddComponent(Component *component, Node *node1, Node *node2) {
         component->Connect(node1, node2);
         m_Components.push_back(component);
+        if (!m_Arena.Owns(component)) m_OwnedComponents.push_back(component);
+        m_Compiled = false;
 
         // Ensure nodes are tracked
-        if (std::find(m_Nodes.begin(), m_Nodes.end(), node1) == m_Nodes.end()) {
-            m_Nodes.push_back(node1);
+        TrackNode(node1);
+        TrackNode(node2);
+        if (Node* control = component->GetControlNode()) TrackNode(control);
+    }
+
+    bool CircuitBuilder::AddComponent(Component *component, const std::vector<Node*>& ports) {
+        if (ports.size() != component->GetPortCount()) return false;
+        component->Connect(nullptr, nullptr);
+        for (size_t k = 0; k < ports.size(); k++) {
+            component->SetPort(k, ports[k]);
+            TrackNode(ports[k]);
         }
-        if (std::find(m_Nodes.begin(), m_Nodes.end(), node2) == m_Nodes.end()) {
-            m_Nodes.push_back(node2);
+        m_Components.push_back(component);
+        if (!m_Arena.Owns(component)) m_OwnedComponents.push_back(component);
+        m_Compiled = false;
+        return true;
+    }
+
+    void CircuitBuilder::TrackNode(Node* node) {
+        if (m_NodeSet.insert(node).second) {
+            m_Nodes.push_back(node);
+            if (!m_Arena.Owns(node)) m_OwnedNodes.push_back(node);
         }
     }
 
+    Node* CircuitBuilder::CreateNode() {
+        Node* node = m_Arena.Create<Node>(m_NextNodeId++);
+        TrackNode(node);
+        return node;
+    }
+
+    void CircuitBuilder::Reserve(size_t components, size_t nodes) {
+        m_Components.reserve(components);
+        m_Nodes.reserve(nodes);
+        m_NodeSet.reserve(nodes);
+    }
+
+    Node* CircuitBuilder::GetGround() {
+        if (!m_Ground) SetGround(m_Arena.Create<Node>(0));
+        return m_Ground;
+    }
+
+    void CircuitBuilder::SetGround(Node* node) {
+        m_Ground = node;
+        TrackNode(node);
+        m_Compiled = false;
+    }
+
+    Resistor* CircuitBuilder::AddResistor(Node* node1, Node* node2, double resistance) {
+        return Add<Resistor>(node1, node2, resistance);
+    }
+
+    Capacitor* CircuitBuilder::AddCapacitor(Node* node1, Node* node2, double capacitance) {
+        return Add<Capacitor>(node1, node2, capacitance);
+    }
+
+    Inductor* CircuitBuilder::AddInductor(Node* node1, Node* node2, double inductance) {
+        return Add<Inductor>(node1, node2, inductance);
+    }
+
+    DCVoltageSource* CircuitBuilder::AddDCVoltageSource(Node* node1, Node* node2, double voltage) {
+        return Add<DCVoltageSource>(node1, node2, voltage);
+    }
+
+    ACVoltageSource* CircuitBuilder::AddACVoltageSource(Node* node1, Node* node2, double amplitude, double frequency, double phase) {
+        return Add<ACVoltageSource>(node1, node2, amplitude, frequency, phase);
+    }
+
+    const Arena& CircuitBuilder::GetArena() const {
+        return m_Arena;
+    }
+
     const std::vector<Node*>& CircuitBuilder::GetNodes() const {
         return m_Nodes;
     }
 
+    const std::vector<Component*>& CircuitBuilder::GetComponents() const {
+        return m_Components;
+    }
+
     double CircuitBuilder::GetCurrentTime() const {
         return m_CurrentTime;
     }
 
+    void CircuitBuilder::Compile() {
+        // Node index map: ground has no row, every other node gets a compact row
+        // in ID order so gaps in the ID space don't leave empty rows
+        std::vector<Node*> ordered(m_Nodes);
+        std::stable_sort(ordered.begin(), ordered.end(), [](Node* a, Node* b) { return a->Id < b->Id; });
+        m_NodeCount = 0;
+        for (auto node : ordered) {
+            bool ground = m_Ground ? node == m_Ground : node->Id == 0;
+            node->Index = ground ? -1 : m_NodeCount++;
+        }
+
+        // Per-type component lists, one dynamic_cast per component for the lifetime of the plan
+        m_Resistors.clear();
+        m_Capacitors.clear();
+        m_Inductors.clear();
+        m_VoltageSources.clear();
+        m_Nonlinear.clear();
+        m_ReducedNetworks.clear();
+        for (auto comp : m_Components) {
+            if (auto device = dynamic_cast<NonlinearComponent*>(comp)) {
+                m_Nonlinear.push_back(device);
+            } else if (auto network = dynamic_cast<ReducedNetwork*>(comp)) {
+                m_ReducedNetworks.push_back(network);
+            } else if (auto resistor = dynamic_cast<Resistor*>(comp)) {
+                m_Resistors.push_back(resistor);
+            } else if (auto capacitor = dynamic_cast<Capacitor*>(comp)) {
+                m_Capacitors.push_back(capacitor);
+            } else if (auto inductor = dynamic_cast<Inductor*>(comp)) {
+                m_Inductors.push_back(inductor);
+            } else if (auto voltageSource = dynamic_cast<VoltageSource*>(comp)) {
+                m_VoltageSources.push_back(voltageSource);
+            }
+        }
+
+        m_ResistorArrays.Assign(m_Resistors);
+        m_CapacitorArrays.Assign(m_Capacitors);
+        m_InductorArrays.Assign(m_Inductors);
+        m_SourceArrays.Assign(m_VoltageSources);
+
+        // Voltage source k owns row m_NodeCount + k
+        m_MatrixSize = m_NodeCount + static_cast<int>(m_VoltageSources.size());
+
+        // Solver backend and workspaces
+        if (!m_Solver || m_Solver->GetType() != m_SolverType) m_Solver = CreateLinearSolver(m_SolverType);
+        if (auto iterative = dynamic_cast<IterativeSolver*>(m_Solver.get())) {
+            iterative->SetSettings(m_IterativeSettings);
+        }
+        if (auto partitioned = dynamic_cast<PartitionedSolver*>(m_Solver.get())) {
+            partitioned->SetSettings(m_PartitionSettings);
+        }
+        if (m_ColumnOrdering) m_Solver->SetColumnOrdering(m_ColumnOrdering);
+        m_G.resize(0, 0);
+        if (!m_Solver->IsSparse()) m_G.resize(m_MatrixSize, m_MatrixSize);
+        m_I.resize(m_MatrixSize);
+        m_V = Eigen::VectorXd::Zero(m_MatrixSize);  // Initial guess for warm-started iterative solves
+        m_Triplets.clear();
+        m_Triplets.reserve(4 * (m_Resistors.size() + m_Capacitors.size() + m_Inductors.size() + m_VoltageSources.size()));
+        m_SparseG.resize(m_MatrixSize, m_MatrixSize);
+        m_FactorValid = false;
+        m_JacobianCurrent = false;
+        m_RowPartition.clear();  // Latency partitions follow the rows
+
+        m_Compiled = true;
+    }
+
+    bool CircuitBuilder::IsCompiled() const {
+        return m_Compiled;
+    }
+
+    int CircuitBuilder::GetMatrixSize() const {
+        return m_MatrixSize;
+    }
+
+    int CircuitBuilder::GetNodeRowCount() const {
+        return m_NodeCount;
+    }
+
+    const std::vector<Resistor*>& CircuitBuilder::GetResistors() const {
+        return m_Resistors;
+    }
+
+    const std::vector<Capacitor*>& CircuitBuilder::GetCapacitors() const {
+        return m_Capacitors;
+    }
+
+    const std::vector<Inductor*>& CircuitBuilder::GetInductors() const {
+        return m_Inductors;
+    }
+
+    const std::vector<VoltageSource*>& CircuitBuilder::GetVoltageSources() const {
+        return m_VoltageSources;
+    }
+
+    const std::vector<NonlinearComponent*>& CircuitBuilder::GetNonlinearComponents() const {
+        return m_Nonlinear;
+    }
+
+    const std::vector<ReducedNetwork*>& CircuitBuilder::GetReducedNetworks() const {
+        return m_ReducedNetworks;
+    }
+
     // Time-based simulation: step forward by deltaTime
     void CircuitBuilder::Step(double deltaTime) {
+        if (m_LatencySettings.enabled) {
+            StepLatent(deltaTime);
+            return;
+        }
+        Solve(deltaTime);
+        Accept();
+    }
+
+    void CircuitBuilder::Solve(double deltaTime) {
+        if (!m_Compiled) Compile();
+
         // Advance time first - we solve for the state at the new time
         m_CurrentTime += deltaTime;
-        
-        // Update continuous probes before solving (will show pre-step state)
-        // Alternatively, move this after solving to show post-step state
-        
-        int N = 0;
+        SolveSystem(deltaTime);
+    }
+
+    void CircuitBuilder::SolveSystem(double deltaTime) {
+        m_LatencyMatrixValid = false;  // The key may change without the reduced system noticing
+
+        if (!m_Nonlinear.empty()) {
+            SolveNewton(deltaTime);
+        } else {
+            // When the cached factorization is still valid only the right-hand side is rebuilt
+            const bool refactor = UpdateFactorizationKey(deltaTime) || !m_FactorValid;
+            if (!refactor) {
+                Assemble(deltaTime, nullptr, nullptr);
+            } else if (m_Solver->IsSparse()) {
+                m_Triplets.clear();
+                Assemble(deltaTime, nullptr, &m_Triplets);
+            } else {
+                m_G.setZero();
+                Assemble(deltaTime, &m_G, nullptr);
+            }
+
+            // Solve the system
+            if (refactor) Factorize();
+            m_Solver->Solve(m_I, m_V);
+        }
+
+        ExtractSolution();
+    }
+
+    void CircuitBuilder::ExtractSolution() {
+        // Extract node voltages
         for (auto node : m_Nodes) {
-            if (node->Id > N) N = node->Id;
+            node->Voltage = (node->Index >= 0) ? m_V(node->Index) : 0.0;
         }
-        N += 1; // Total number of nodes
 
-        int M = 0; // Number of voltage sources
-        for (auto comp : m_Components) {
-            if (dynamic_cast<VoltageSource*>(comp)) {
-                M++;
-            }
+        // Extract voltage source currents
+        for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+            m_VoltageSources[k]->SetCurrent(m_V(m_NodeCount + static_cast<int>(k)));
         }
+    }
+
+    void CircuitBuilder::Accept() {
+        // Update state of reactive components for next timestep
+        for (size_t k = 0; k < m_Capacitors.size(); k++) m_Capacitors[k]->AcceptVoltage(m_CapacitorArrays.Voltage(m_V, k));
+        for (size_t k = 0; k < m_Inductors.size(); k++) m_Inductors[k]->AcceptVoltage(m_InductorArrays.Voltage(m_V, k));
+        for (auto network : m_ReducedNetworks) network->UpdateState();
+        
+        // Update continuous probes after solving (shows current state)
+        m_ProbeManager.UpdateContinuousProbes(m_CurrentTime);
+    }
 
-        int matrixSize = (N > 0 ? N - 1 : 0) + M;
-        Eigen::MatrixXd G = Eigen::MatrixXd::Zero(matrixSize, matrixSize);
-        Eigen::VectorXd I = Eigen::VectorXd::Zero(matrixSize);
+    void CircuitBuilder::Assemble(double deltaTime, Eigen::MatrixXd* G, std::vector<Eigen::Triplet<double>>* triplets) {
+        // Without a matrix target StampG() calls are no-ops
+        m_I.setZero();
+        SimulationState state{G, triplets, m_I, deltaTime, -1, m_CurrentTime, m_IntegrationMethod};
+        const bool matrix = G || triplets;
+        if (matrix) {
+            for (size_t k = 0; k < m_Resistors.size(); k++) m_ResistorArrays.conductance[k] = 1.0 / m_Resistors[k]->GetResistance();
+            m_ResistorArrays.StampConductances(state);  // No RHS contribution
+        }
 
-        // Stamp resistors
-        for (auto comp : m_Components) {
-            if (auto resistor = dynamic_cast<Resistor*>(comp)) {
-                SimulationState state{G, I, deltaTime, -1, m_CurrentTime};
-                resistor->Stamp(state);
+        // Companion models: the components keep their integration state, the stamps
+        // run over the packed rows
+        for (size_t k = 0; k < m_Capacitors.size(); k++) {
+            m_Capacitors[k]->BeginStep(deltaTime, m_IntegrationMethod, m_CapacitorArrays.conductance[k], m_CapacitorArrays.current[k]);
+        }
+        for (size_t k = 0; k < m_Inductors.size(); k++) {
+            m_Inductors[k]->BeginStep(deltaTime, m_IntegrationMethod, m_InductorArrays.conductance[k], m_InductorArrays.current[k]);
+        }
+        if (matrix) {
+            m_CapacitorArrays.StampConductances(state);
+            m_InductorArrays.StampConductances(state);
+        }
+        m_CapacitorArrays.StampCurrents(m_I);
+        m_InductorArrays.StampCurrents(m_I);
+        for (auto network : m_ReducedNetworks) network->Stamp(state);
+
+        // Voltage source k: +-1 couplings to its branch row, the voltage in that row
+        for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+            const int row = m_NodeCount + static_cast<int>(k);
+            const int i = m_SourceArrays.row1[k], j = m_SourceArrays.row2[k];
+            if (matrix) {
+                if (i >= 0) { state.StampG(i, row, 1.0); state.StampG(row, i, 1.0); }
+                if (j >= 0) { state.StampG(j, row, -1.0); state.StampG(row, j, -1.0); }
             }
+            m_I(row) += GetSourceVoltage(k, m_CurrentTime);
         }
+        for (auto device : m_Nonlinear) device->Stamp(state);
+    }
 
-        // Stamp capacitors
-        for (auto comp : m_Components) {
-            if (auto capacitor = dynamic_cast<Capacitor*>(comp)) {
-                SimulationState state{G, I, deltaTime, -1, m_CurrentTime};
-                capacitor->Stamp(state);
+    bool CircuitBuilder::UpdateDevices(bool& limited) {
+        bool changed = false;
+        limited = false;
+        for (auto device : m_Nonlinear) {
+            if (device->Update(m_NewtonSettings.bypassTolerance)) {
+                limited = limited || device->IsLimited();
+                m_NewtonStats.evaluations++;
+                changed = true;
+            } else {
+                m_NewtonStats.bypasses++;
             }
         }
+        return changed;
+    }
 
-        // Stamp inductors
-        for (auto comp : m_Components) {
-            if (auto inductor = dynamic_cast<Inductor*>(comp)) {
-                SimulationState state{G, I, deltaTime, -1, m_CurrentTime};
-                inductor->Stamp(state);
+    void CircuitBuilder::SolveNewton(double deltaTime) {
+        const NewtonSettings& settings = m_NewtonSettings;
+        const bool sparse = m_Solver->IsSparse();
+
+        // A new timestep or component value changes the linear part of the Jacobian
+        if (UpdateFactorizationKey(deltaTime) || !m_FactorValid) m_JacobianCurrent = false;
+
+        Eigen::VectorXd previous;
+        double previousChange = 0.0;
+        bool refactor = false;      // Chord iterations stopped contracting
+        bool converged = false;
+        int iteration = 0;
+        while (!converged && iteration < settings.maxIterations) {
+            iteration++;
+
+            // Linearize around the present iterate: node voltages hold the last solution
+            bool limited;
+            if (UpdateDevices(limited)) m_JacobianCurrent = false;
+            if (sparse) {
+                m_Triplets.clear();
+                Assemble(deltaTime, nullptr, &m_Triplets);
+            } else {
+                m_G.setZero();
+                Assemble(deltaTime, &m_G, nullptr);
+            }
+
+            previous = m_V;
+            bool chord = false;
+            if (m_JacobianCurrent) {
+                // Factors match this linearization exactly (every device bypassed)
+                m_Solver->Solve(m_I, m_V);
+            } else if (settings.reuseJacobian && m_FactorValid && !refactor) {
+                // Chord step with the old factors: J_old * dV = I - J * V
+                BuildMatrix();
+                Eigen::VectorXd residual = sparse ? Eigen::VectorXd(m_I - m_SparseG * m_V) : Eigen::VectorXd(m_I - m_G * m_V);
+                Eigen::VectorXd delta = Eigen::VectorXd::Zero(m_MatrixSize);
+                m_Solver->Solve(residual, delta);
+                m_V += delta;
+                chord = true;
+            } else {
+                m_JacobianCurrent = Factorize();
+                m_NewtonStats.factorizations++;
+                m_Solver->Solve(m_I, m_V);
+            }
+
+            double change = 0.0;
+            for (int row = 0; row < m_NodeCount; row++) {
+                change = std::max(change, std::abs(m_V(row) - previous(row)));
+            }
+
+            // Chord iterations converge linearly, so the last update understates the
+            // remaining error by rate / (1 - rate). The first one has no rate to go by
+            // and can't be accepted.
+            double rate = (previousChange > 0.0) ? change / previousChange : 1.0;
+            double errorScale = chord ? std::max(1.0, rate / std::max(1.0 - rate, 1e-3)) : 1.0;
+
+            // Converged when no node voltage moves beyond tolerance and no device was limited
+            converged = !limited && !(chord && iteration == 1);
+            for (int row = 0; row < m_NodeCount; row++) {
+                double delta = std::abs(m_V(row) - previous(row)) * errorScale;
+                double scale = std::max(std::abs(m_V(row)), std::abs(previous(row)));
+                if (delta > settings.relTol * scale + settings.vnTol) converged = false;
+            }
+            refactor = chord && iteration > 1 && change > 0.5 * previousChange;
+            previousChange = change;
+
+            for (auto node : m_Nodes) {
+                node->Voltage = (node->Index >= 0) ? m_V(node->Index) : 0.0;
             }
         }
 
-        // Stamp voltage sources
-        int vsIndex = 0;
-        for (auto comp : m_Components) {
-            if (auto voltageSource = dynamic_cast<VoltageSource*>(comp)) {
-                SimulationState state{G, I, deltaTime, (N > 0 ? N - 1 : 0) + vsIndex, m_CurrentTime};
-                voltageSource->Stamp(state);
-                vsIndex++;
+        m_NewtonStats.steps++;
+        m_NewtonStats.iterations += iteration;
+        m_NewtonStats.maxIterations = std::max(m_NewtonStats.maxIterations, iteration);
+        if (!converged) m_NewtonStats.failedSteps++;
+    }
+
+    bool CircuitBuilder::UpdateFactorizationKey(double deltaTime) {
+        // Topology changes reset m_FactorValid in Compile(); here we only compare the
+        // timestep and the conductances in plan order. Reactive components contribute
+        // their companion conductance, which also covers the method and its start-up.
+        bool changed = (deltaTime != m_FactorDt);
+        m_FactorDt = deltaTime;
+
+        size_t count = m_Resistors.size() + m_Capacitors.size() + m_Inductors.size() + m_ReducedNetworks.size();
+        if (m_FactorValues.size() != count) {
+            m_FactorValues.assign(count, 0.0);
+            changed = true;
+        }
+
+        size_t k = 0;
+        auto record = [&](double value) {
+            if (m_FactorValues[k] != value) {
+                m_FactorValues[k] = value;
+                changed = true;
             }
+            k++;
+        };
+        for (auto resistor : m_Resistors) record(resistor->GetResistance());
+        for (auto capacitor : m_Capacitors) record(capacitor->GetCompanionConductance(deltaTime, m_IntegrationMethod));
+        for (auto inductor : m_Inductors) record(inductor->GetCompanionConductance(deltaTime, m_IntegrationMethod));
+        for (auto network : m_ReducedNetworks) record(network->GetCompanionAlpha(deltaTime, m_IntegrationMethod));
+
+        return changed;
+    }
+
+    void CircuitBuilder::BuildMatrix() {
+        if (m_Solver->IsSparse()) {
+            m_SparseG.setFromTriplets(m_Triplets.begin(), m_Triplets.end());  // Duplicates are summed
         }
+    }
 
-        // Solve the system
-        Eigen::VectorXd V = G.colPivHouseholderQr().solve(I);
+    bool CircuitBuilder::Factorize() {
+        BuildMatrix();
+        const bool ok = m_Solver->IsSparse() ? m_Solver->Factorize(m_SparseG) : m_Solver->Factorize(m_G);
+        // A failed factorization is retried on the next step instead of being reused
+        m_FactorValid = ok;
+        m_FactorizationCount++;
+        return ok;
+    }
 
-        // Extract node voltages
-        for (auto node : m_Nodes) {
-            if (node->Id == 0) {
-                node->Voltage = 0.0;
-            } else {
-                int idx = node->Id - 1;
-                if (idx >= 0 && idx < V.size()) {
-                    node->Voltage = V(idx);
+    // Simulate for a given duration with specified timestep
+    // Steps are shortened to land on source breakpoints, so edges are hit exactly
+    // whatever the timestep
+    void CircuitBuilder::Simulate(double duration, double deltaTime, const std::function<void()>& afterStep) {
+        if (!m_Compiled) Compile();
+        double endTime = m_CurrentTime + duration;
+        const double epsilon = deltaTime * 0.01; // Small tolerance for floating point comparison
+        m_SourceBlockCount = 0;
+        while (m_CurrentTime < endTime - epsilon) {
+            const double breakpoint = GetNextBreakpoint(m_CurrentTime + epsilon);
+            const double remaining = breakpoint - m_CurrentTime;
+            if (breakpoint >= endTime - epsilon || remaining >= 2.0 * deltaTime - epsilon) {
+                // Regular step: its source values come from the block
+                if (m_SourceBlockSize > 0 && GetSourceBlockSample(m_CurrentTime + deltaTime) < 0) {
+                    FillSourceBlock(m_CurrentTime + deltaTime, deltaTime);
                 }
+                Step(deltaTime);
+            } else if (std::abs(remaining - deltaTime) <= epsilon) {
+                Step(remaining);
+                m_CurrentTime = breakpoint;     // Only rounding is left to clean up
+            } else {
+                // Split the last two steps evenly rather than leave a sliver before the breakpoint
+                Step(remaining < deltaTime ? remaining : 0.5 * remaining);
+                if (remaining < deltaTime) m_CurrentTime = breakpoint;
             }
+            if (afterStep) afterStep();
         }
+        m_SourceBlockCount = 0;
+        m_ProbeManager.Flush();
+    }
 
-        // Extract voltage source currents
-        vsIndex = 0;
+    void CircuitBuilder::FillSourceBlock(double start, double step) {
+        const int count = m_SourceBlockSize;
+        m_SourceBlock.resize(m_VoltageSources.size() * count);
+        for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+            m_VoltageSources[k]->EvaluateBlock(start, step, count, &m_SourceBlock[k * count]);
+        }
+        m_SourceBlockStart = start;
+        m_SourceBlockStep = step;
+        m_SourceBlockCount = count;
+    }
+
+    int CircuitBuilder::GetSourceBlockSample(double time) const {
+        if (m_SourceBlockCount == 0) return -1;
+        // Times accumulated step by step drift from start + k * step by a few ulps
+        const double position = (time - m_SourceBlockStart) / m_SourceBlockStep;
+        const double sample = std::round(position);
+        if (sample < 0.0 || sample >= m_SourceBlockCount || std::abs(position - sample) > 1e-6) return -1;
+        return static_cast<int>(sample);
+    }
+
+    double CircuitBuilder::GetSourceVoltage(size_t source, double time) const {
+        int sample = GetSourceBlockSample(time);
+        if (sample < 0) return m_VoltageSources[source]->GetVoltage(time);
+        return m_SourceBlock[source * m_SourceBlockCount + sample];
+    }
+
+    void CircuitBuilder::SetSourceBlockSize(int steps) {
+        m_SourceBlockSize = std::max(steps, 0);
+    }
+
+    int CircuitBuilder::GetSourceBlockSize() const {
+        return m_SourceBlockSize;
+    }
+
+    double CircuitBuilder::GetNextBreakpoint(double time) const {
+        double next = INFINITY;
+        for (auto source : m_VoltageSources) next = std::min(next, source->GetNextBreakpoint(time));
+        return next;
+    }
+
+    double CircuitBuilder::EstimateError(double relTol, double absTol) const {
+        double ratio = 0.0;
+        for (auto capacitor : m_Capacitors) ratio = std::max(ratio, capacitor->EstimateError(relTol, absTol));
+        for (auto inductor : m_Inductors) ratio = std::max(ratio, inductor->EstimateError(relTol, absTol));
+        for (auto network : m_ReducedNetworks) ratio = std::max(ratio, network->EstimateError(relTol, absTol));
+        return ratio;
+    }
+
+    void CircuitBuilder::SimulateAdaptive(double duration, const AdaptiveSettings& settings) {
+        const double endTime = m_CurrentTime + duration;
+        const double minStep = settings.minStep > 0.0 ? settings.minStep : duration * 1e-12;
+        const double maxStep = settings.maxStep > 0.0 ? settings.maxStep : duration / 10.0;
+        const int order = IntegrationOrder(m_IntegrationMethod);
+
+        double step = settings.initialStep > 0.0 ? settings.initialStep : duration / 1000.0;
+        step = std::min(std::max(step, minStep), maxStep);
+
+        if (!m_Compiled) Compile();
+        m_AdaptiveStats = AdaptiveStats();
+        while (endTime - m_CurrentTime > minStep) {
+            // Land exactly on the end time and on source breakpoints
+            const double breakpoint = GetNextBreakpoint(m_CurrentTime + minStep);
+            double dt = std::min(step, std::min(endTime, breakpoint) - m_CurrentTime);
+            const double startTime = m_CurrentTime;
+
+            Solve(dt);
+            double ratio = EstimateError(settings.relTol, settings.absTol);
+
+            // Step proposal from error ~ h^(order+1)
+            double factor = (ratio > 0.0) ? settings.safety * std::pow(1.0 / ratio, 1.0 / (order + 1)) : settings.maxGrowth;
+
+            if (ratio > 1.0 && dt > minStep) {
+                // Reject: nothing was committed yet, only the clock moved
+                m_CurrentTime = startTime;
+                m_AdaptiveStats.rejectedSteps++;
+                step = std::max(dt * std::max(factor, 0.1), minStep);
+                continue;
+            }
+
+            if (dt == breakpoint - startTime) m_CurrentTime = breakpoint;
+            Accept();
+            m_AdaptiveStats.acceptedSteps++;
+            if (m_AdaptiveStats.acceptedSteps == 1 || dt < m_AdaptiveStats.smallestStep) m_AdaptiveStats.smallestStep = dt;
+            m_AdaptiveStats.largestStep = std::max(m_AdaptiveStats.largestStep, dt);
+
+            // Keep the step (and the cached factorization) unless it can grow noticeably.
+            // A step shortened to hit the end time says nothing about the step size.
+            if (dt < step && factor >= 1.0) continue;
+            if (factor >= 1.2 || factor < 1.0) step = dt * std::min(factor, settings.maxGrowth);
+            else step = dt;
+            step = std::min(std::max(step, minStep), maxStep);
+        }
+        m_AdaptiveStats.lastStep = step;
+        m_ProbeManager.Flush();
+    }
+
+    bool CircuitBuilder::SolveOperatingPoint(double gmin) {
+        if (!m_Compiled) Compile();
+
+        // Transient rows plus one branch row per inductor
+        const int size = m_MatrixSize + static_cast<int>(m_Inductors.size());
+        std::vector<Eigen::Triplet<double>> triplets;
+        Eigen::VectorXd I(size);
+        Eigen::VectorXd x = Eigen::VectorXd::Zero(size);
+        SimulationState state{nullptr, &triplets, I, 0.0, -1, m_CurrentTime, m_IntegrationMethod};
+
+        // One-off solve, so the robust sparse LU is used whatever the transient backend is
+        auto solver = CreateLinearSolver(SolverType::SparseLU);
+        SparseMatrix A(size, size);
+
+        // Linear circuits solve in one pass, nonlinear devices iterate from the present node voltages
+        const NewtonSettings& settings = m_NewtonSettings;
+        const int maxIterations = m_Nonlinear.empty() ? 1 : settings.maxIterations;
+        bool converged = m_Nonlinear.empty();
+        int iteration = 0;
+        while (iteration < maxIterations) {
+            iteration++;
+            bool limited;
+            UpdateDevices(limited);
+
+            triplets.clear();
+            I.setZero();
+            for (auto resistor : m_Resistors) resistor->Stamp(state);
+            for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+                state.vsIndex = m_NodeCount + static_cast<int>(k);
+                m_VoltageSources[k]->Stamp(state);
+            }
+            for (size_t k = 0; k < m_Inductors.size(); k++) {
+                state.vsIndex = m_MatrixSize + static_cast<int>(k);
+                m_Inductors[k]->StampOperatingPoint(state);
+            }
+            for (auto network : m_ReducedNetworks) network->StampOperatingPoint(state);
+            for (auto device : m_Nonlinear) device->Stamp(state);
+            for (int row = 0; row < m_NodeCount; row++) state.StampG(row, row, gmin);
+
+            A.setFromTriplets(triplets.begin(), triplets.end());
+            if (!solver->Factorize(A)) return false;
+            Eigen::VectorXd previous = x;
+            solver->Solve(I, x);
+            if (!x.allFinite()) return false;
+
+            for (auto node : m_Nodes) {
+                node->Voltage = (node->Index >= 0) ? x(node->Index) : 0.0;
+            }
+            if (m_Nonlinear.empty()) break;
+
+            converged = iteration > 1 && !limited;
+            for (int row = 0; row < m_NodeCount && converged; row++) {
+                double scale = std::max(std::abs(x(row)), std::abs(previous(row)));
+                if (std::abs(x(row) - previous(row)) > settings.relTol * scale + settings.vnTol) converged = false;
+            }
+            if (converged) break;
+        }
+        if (!m_Nonlinear.empty()) {
+            m_NewtonStats.steps++;
+            m_NewtonStats.iterations += iteration;
+            m_NewtonStats.factorizations += iteration;
+            m_NewtonStats.maxIterations = std::max(m_NewtonStats.maxIterations, iteration);
+            if (!converged) m_NewtonStats.failedSteps++;
+        }
+
+        for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+            m_VoltageSources[k]->SetCurrent(x(m_NodeCount + static_cast<int>(k)));
+        }
+
+        // Seed the reactive state; the next step starts its integration history over
+        for (auto capacitor : m_Capacitors) {
+            Node* node1 = capacitor->GetNode1();
+            Node* node2 = capacitor->GetNode2();
+            capacitor->SetInitialVoltage((node1 ? node1->Voltage : 0.0) - (node2 ? node2->Voltage : 0.0));
+        }
+        for (size_t k = 0; k < m_Inductors.size(); k++) {
+            m_Inductors[k]->SetInitialCurrent(x(m_MatrixSize + static_cast<int>(k)));
+        }
+        for (auto network : m_ReducedNetworks) network->SetInitialState();
+
+        m_V = x.head(m_MatrixSize);  // Initial guess for warm-started iterative solves
+        return converged;
+    }
+
+    void CircuitBuilder::SetNewtonSettings(const NewtonSettings& settings) {
+        m_NewtonSettings = settings;
+    }
+
+    const NewtonSettings& CircuitBuilder::GetNewtonSettings() const {
+        return m_NewtonSettings;
+    }
+
+    const NewtonStats& CircuitBuilder::GetNewtonStats() const {
+        return m_NewtonStats;
+    }
+
+    void CircuitBuilder::ResetNewtonStats() {
+        m_NewtonStats = NewtonStats();
+    }
+
+    void CircuitBuilder::SetLatencySettings(const LatencySettings& settings) {
+        m_LatencySettings = settings;
+        m_RowPartition.clear();  // Repartition, everything starts active
+    }
+
+    const LatencySettings& CircuitBuilder::GetLatencySettings() const {
+        return m_LatencySettings;
+    }
+
+    const LatencyStats& CircuitBuilder::GetLatencyStats() const {
+        return m_LatencyStats;
+    }
+
+    void CircuitBuilder::ResetLatencyStats() {
+        m_LatencyStats = LatencyStats();
+    }
+
+    void CircuitBuilder::PartitionLatency() {
+        int count = m_LatencySettings.partitions > 0 ? m_LatencySettings.partitions
+                                                     : m_NodeCount / std::max(1, m_LatencySettings.partitionSize);
+        count = std::max(1, std::min(count, m_NodeCount));
+
+        // Node graph: every component ties its terminals together
+        std::vector<std::vector<int>> adjacency(m_NodeCount);
+        std::vector<int> rows;
         for (auto comp : m_Components) {
-            if (auto voltageSource = dynamic_cast<VoltageSource*>(comp)) {
-                int currentIdx = (N > 0 ? N - 1 : 0) + vsIndex;
-                if (currentIdx >= 0 && currentIdx < V.size()) {
-                    voltageSource->SetCurrent(V(currentIdx));
+            rows.clear();
+            const Node* terminals[3] = {comp->GetNode1(), comp->GetNode2(), comp->GetControlNode()};
+            for (auto node : terminals) {
+                if (node && node->Index >= 0) rows.push_back(node->Index);
+            }
+            for (size_t k = 0; k < comp->GetPortCount(); k++) {
+                const Node* port = comp->GetPort(k);
+                if (port && port->Index >= 0) rows.push_back(port->Index);
+            }
+            for (size_t a = 0; a < rows.size(); a++) {
+                for (size_t b = a + 1; b < rows.size(); b++) {
+                    if (rows[a] == rows[b]) continue;
+                    adjacency[rows[a]].push_back(rows[b]);
+                    adjacency[rows[b]].push_back(rows[a]);
                 }
-                vsIndex++;
             }
         }
+        std::vector<int> part = PartitionGraph(adjacency, count);
 
-        // Update state of reactive components for next timestep
-        for (auto comp : m_Components) {
-            if (auto capacitor = dynamic_cast<Capacitor*>(comp)) {
-                capacitor->UpdateState();
+        // Source rows belong to the partition of their terminal
+        m_PartitionCount = count;
+        m_RowPartition.assign(m_MatrixSize, 0);
+        for (int row = 0; row < m_NodeCount; row++) m_RowPartition[row] = part[row];
+        for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+            const Node* node1 = m_VoltageSources[k]->GetNode1();
+            const Node* node2 = m_VoltageSources[k]->GetNode2();
+            int row = (node1 && node1->Index >= 0) ? node1->Index : ((node2 && node2->Index >= 0) ? node2->Index : -1);
+            if (row >= 0) m_RowPartition[m_NodeCount + k] = part[row];
+        }
+
+        m_QuietSteps.assign(count, 0);
+        m_Latent.assign(count, 0);
+        m_ReducedLatent.clear();
+        m_LatencyMatrixValid = false;
+    }
+
+    bool CircuitBuilder::IsFrozen(const Component* component) const {
+        const Node* terminals[2] = {component->GetNode1(), component->GetNode2()};
+        bool frozen = false;
+        for (auto node : terminals) {
+            if (!node || node->Index < 0) continue;
+            if (!m_Latent[m_RowPartition[node->Index]]) return false;
+            frozen = true;
+        }
+        return frozen;
+    }
+
+    void CircuitBuilder::StepLatent(double deltaTime) {
+        if (!m_Compiled) Compile();
+        if (!m_Nonlinear.empty() || m_NodeCount == 0) {
+            Solve(deltaTime);
+            Accept();
+            return;
+        }
+        if (m_RowPartition.size() != static_cast<size_t>(m_MatrixSize)) PartitionLatency();
+
+        const double tolerance = m_LatencySettings.tolerance;
+        const double previousTime = m_CurrentTime;
+        m_CurrentTime += deltaTime;
+        m_LatencyStats.steps++;
+
+        // A partition whose source moves is active for this step
+        std::vector<char> driven(m_PartitionCount, 0);
+        for (size_t k = 0; k < m_VoltageSources.size(); k++) {
+            double change = GetSourceVoltage(k, m_CurrentTime) - GetSourceVoltage(k, previousTime);
+            if (std::abs(change) > tolerance) driven[m_RowPartition[m_NodeCount + k]] = 1;
+        }
+        for (int p = 0; p < m_PartitionCount; p++) {
+            if (driven[p] && m_Latent[p]) {
+                m_Latent[p] = 0;
+                m_LatencyStats.wakeups++;
             }
-            if (auto inductor = dynamic_cast<Inductor*>(comp)) {
-                inductor->UpdateState();
+        }
+
+        // Solve with the latent partitions frozen until their boundaries balance
+        Eigen::VectorXd previous = m_V;
+        bool solved = false;
+        std::vector<int> woken;
+        while (!solved && std::find(m_Latent.begin(), m_Latent.end(), 1) != m_Latent.end()) {
+            woken.clear();
+            SolveReduced(deltaTime, woken);
+            solved = woken.empty();
+            for (int p : woken) {
+                m_Latent[p] = 0;
+                m_QuietSteps[p] = 0;
+                m_LatencyStats.wakeups++;
             }
+            if (!solved) m_LatencyStats.resolves++;
         }
-        
-        // Update continuous probes after solving (shows current state)
+        if (solved) {
+            ExtractSolution();
+        } else {
+            SolveSystem(deltaTime);  // Everything is active
+        }
+
+        // Frozen reactive components hold their state
+        for (size_t k = 0; k < m_Capacitors.size(); k++) {
+            if (!IsFrozen(m_Capacitors[k])) m_Capacitors[k]->AcceptVoltage(m_CapacitorArrays.Voltage(m_V, k));
+        }
+        for (size_t k = 0; k < m_Inductors.size(); k++) {
+            if (!IsFrozen(m_Inductors[k])) m_Inductors[k]->AcceptVoltage(m_InductorArrays.Voltage(m_V, k));
+        }
+        for (auto network : m_ReducedNetworks) network->UpdateState();
         m_ProbeManager.UpdateContinuousProbes(m_CurrentTime);
+
+        // Freeze the partitions that stayed quiet long enough
+        std::vector<double> movement(m_PartitionCount, 0.0);
+        for (int row = 0; row < m_NodeCount; row++) {
+            double& largest = movement[m_RowPartition[row]];
+            largest = std::max(largest, std::abs(m_V(row) - previous(row)));
+        }
+        m_LatencyStats.partitionSteps += m_PartitionCount;
+        bool froze = false;
+        for (int p = 0; p < m_PartitionCount; p++) {
+            if (m_Latent[p]) {
+                m_LatencyStats.latentPartitionSteps++;
+                continue;
+            }
+            bool quiet = !driven[p] && movement[p] <= tolerance;
+            m_QuietSteps[p] = quiet ? m_QuietSteps[p] + 1 : 0;
+            if (m_QuietSteps[p] >= m_LatencySettings.quietSteps) {
+                m_Latent[p] = 1;
+                m_LatencyStats.freezes++;
+                froze = true;
+            }
+        }
+
+        // Newly frozen state restarts from rest, so the companion models hold it exactly
+        if (froze) {
+            for (auto capacitor : m_Capacitors) {
+                if (IsFrozen(capacitor)) capacitor->SetInitialVoltage(capacitor->GetVoltage());
+            }
+            for (auto inductor : m_Inductors) {
+                if (IsFrozen(inductor)) inductor->SetInitialCurrent(inductor->GetCurrent());
+            }
+        }
     }
 
-    // Simulate for a given duration with specified timestep
-    void CircuitBuilder::Simulate(double duration, double deltaTime) {
-        double endTime = m_CurrentTime + duration;
-        const double epsilon = deltaTime * 0.01; // Small tolerance for floating point comparison
-        while (m_CurrentTime < endTime - epsilon) {
-            Step(deltaTime);
+    void CircuitBuilder::SolveReduced(double deltaTime, std::vector<int>& woken) {
+        const int size = m_MatrixSize;
+
+        // Full G for the residual of the frozen rows; a new key also stales the main factors
+        if (UpdateFactorizationKey(deltaTime)) {
+            m_FactorValid = false;
+            m_LatencyMatrixValid = false;
+        }
+        if (!m_LatencyMatrixValid) {
+            m_Triplets.clear();
+            Assemble(deltaTime, nullptr, &m_Triplets);
+            m_LatencyMatrix.resize(size, size);
+            m_LatencyMatrix.setFromTriplets(m_Triplets.begin(), m_Triplets.end());
+            m_LatencyRows = m_LatencyMatrix;
+            m_LatencyMatrixValid = true;
+            m_ReducedLatent.clear();
+        } else {
+            Assemble(deltaTime, nullptr, nullptr);
         }
+
+        // Reduced system over the active rows, refactored when the latent set changes
+        if (m_ReducedLatent != m_Latent) {
+            m_ReducedIndex.assign(size, -1);
+            m_ActiveRows.clear();
+            for (int row = 0; row < size; row++) {
+                if (m_Latent[m_RowPartition[row]]) continue;
+                m_ReducedIndex[row] = static_cast<int>(m_ActiveRows.size());
+                m_ActiveRows.push_back(row);
+            }
+
+            std::vector<Eigen::Triplet<double>> triplets;
+            std::vector<char> boundary(size, 0);
+            m_ReducedCoupling.clear();
+            for (int col = 0; col < size; col++) {
+                for (SparseMatrix::InnerIterator it(m_LatencyMatrix, col); it; ++it) {
+                    int row = static_cast<int>(it.row());
+                    int reducedRow = m_ReducedIndex[row], reducedCol = m_ReducedIndex[col];
+                    if (reducedRow >= 0 && reducedCol >= 0) triplets.emplace_back(reducedRow, reducedCol, it.value());
+                    else if (reducedRow >= 0) m_ReducedCoupling.emplace_back(reducedRow, col, it.value());
+                    else if (reducedCol >= 0) boundary[row] = 1;
+                }
+            }
+            m_BoundaryRows.clear();
+            for (int row = 0; row < size; row++) {
+                if (boundary[row]) m_BoundaryRows.push_back(row);
+            }
+
+            const int active = static_cast<int>(m_ActiveRows.size());
+            m_ReducedMatrix.resize(active, active);
+            m_ReducedMatrix.setFromTriplets(triplets.begin(), triplets.end());
+            if (!m_ReducedSolver) m_ReducedSolver = CreateLinearSolver(SolverType::SparseLU);
+            m_ReducedSolver->Factorize(m_ReducedMatrix);
+            m_FactorizationCount++;
+            m_ReducedLatent = m_Latent;
+        }
+
+        // G_AA x_A = I_A - G_AF x_F with the frozen rows at their last solution
+        Eigen::VectorXd rhs(m_ActiveRows.size());
+        for (size_t k = 0; k < m_ActiveRows.size(); k++) rhs(k) = m_I(m_ActiveRows[k]);
+        for (const auto& entry : m_ReducedCoupling) rhs(entry.row()) -= entry.value() * m_V(entry.col());
+        Eigen::VectorXd active = Eigen::VectorXd::Zero(rhs.size());
+        m_ReducedSolver->Solve(rhs, active);
+        for (size_t k = 0; k < m_ActiveRows.size(); k++) m_V(m_ActiveRows[k]) = active(k);
+
+        // A frozen row next to the active ones has to keep balancing. Its residual over
+        // the diagonal estimates how far the node would move (source rows are in volts).
+        for (int row : m_BoundaryRows) {
+            double residual = m_I(row);
+            double diagonal = 0.0;
+            for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(m_LatencyRows, row); it; ++it) {
+                residual -= it.value() * m_V(it.col());
+                if (it.col() == row) diagonal = it.value();
+            }
+            double change = (diagonal != 0.0) ? std::abs(residual / diagonal) : std::abs(residual);
+            int p = m_RowPartition[row];
+            if (change > m_LatencySettings.tolerance && std::find(woken.begin(), woken.end(), p) == woken.end()) {
+                woken.push_back(p);
+            }
+        }
+    }
+
+    void CircuitBuilder::SetIntegrationMethod(IntegrationMethod method) {
+        m_IntegrationMethod = method;
+    }
+
+    IntegrationMethod CircuitBuilder::GetIntegrationMethod() const {
+        return m_IntegrationMethod;
+    }
+
+    const AdaptiveStats& CircuitBuilder::GetAdaptiveStats() const {
+        return m_AdaptiveStats;
     }
 
     // Reset simulation time
@@ -146,6 +941,172 @@ namespace ecim {
         m_CurrentTime = 0.0;
     }
 
+    // Linear solver backend selection
+    void CircuitBuilder::SetSolverType(SolverType type) {
+        if (type != m_SolverType) m_Compiled = false;  // Workspaces depend on the backend
+        m_SolverType = type;
+    }
+
+    SolverType CircuitBuilder::GetSolverType() const {
+        return m_SolverType;
+    }
+
+    LinearSolver& CircuitBuilder::GetLinearSolver() {
+        if (!m_Compiled) Compile();
+        return *m_Solver;
+    }
+
+    size_t CircuitBuilder::GetFactorizationCount() const {
+        return m_FactorizationCount;
+    }
+
+    void CircuitBuilder::SetIterativeSettings(const IterativeSettings& settings) {
+        m_IterativeSettings = settings;
+        if (auto iterative = dynamic_cast<IterativeSolver*>(m_Solver.get())) {
+            iterative->SetSettings(settings);
+            m_FactorValid = false;  // Rebuild the preconditioner with the new settings
+        }
+    }
+
+    const IterativeSettings& CircuitBuilder::GetIterativeSettings() const {
+        return m_IterativeSettings;
+    }
+
+    void CircuitBuilder::SetPartitionSettings(const PartitionSettings& settings) {
+        m_PartitionSettings = settings;
+        if (auto partitioned = dynamic_cast<PartitionedSolver*>(m_Solver.get())) {
+            partitioned->SetSettings(settings);
+            m_FactorValid = false;  // Repartition with the new settings
+        }
+    }
+
+    const PartitionSettings& CircuitBuilder::GetPartitionSettings() const {
+        return m_PartitionSettings;
+    }
+
+    void CircuitBuilder::SetColumnOrdering(ColumnOrdering ordering) {
+        m_ColumnOrdering = ordering;
+        if (m_Solver) {
+            m_Solver->SetColumnOrdering(ordering);
+            m_FactorValid = false;
+        }
+    }
+
+    ColumnOrdering CircuitBuilder::GetColumnOrdering() const {
+        if (m_ColumnOrdering) return m_ColumnOrdering;
+        return m_Solver ? m_Solver->GetColumnOrdering() : nullptr;
+    }
+
+    ColumnOrdering CircuitBuilder::AnalyzeOrdering(double deltaTime) {
+        if (!m_Compiled) Compile();
+
+        // The ordering only depends on the pattern; m_I is rebuilt by every step anyway
+        std::vector<Eigen::Triplet<double>> triplets;
+        Assemble(deltaTime, nullptr, &triplets);
+        SparseMatrix A(m_MatrixSize, m_MatrixSize);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+        return SparseLUSolver::ComputeColumnOrdering(A);
+    }
+
+    std::unique_ptr<CircuitBuilder> CircuitBuilder::Clone() const {
+        std::unique_ptr<CircuitBuilder> copy(new CircuitBuilder());
+
+        // Nodes keep their IDs so the clone compiles to the same node indices
+        std::unordered_map<const Node*, Node*> nodes;
+        for (auto node : m_Nodes) {
+            Node* clone = copy->m_Arena.Create<Node>(*node);
+            nodes[node] = clone;
+            copy->TrackNode(clone);
+        }
+        if (m_Ground) copy->m_Ground = nodes[m_Ground];
+        copy->m_NextNodeId = m_NextNodeId;
+
+        for (auto comp : m_Components) {
+            Component* clone = comp->Clone();
+            if (!clone) return nullptr;
+            clone->Connect(nodes[comp->GetNode1()], nodes[comp->GetNode2()]);
+            if (comp->GetControlNode()) clone->SetControlNode(nodes[comp->GetControlNode()]);
+            for (size_t k = 0; k < comp->GetPortCount(); k++) clone->SetPort(k, nodes[comp->GetPort(k)]);
+            copy->m_Components.push_back(clone);
+            copy->m_OwnedComponents.push_back(clone);
+        }
+
+        copy->m_CurrentTime = m_CurrentTime;
+        copy->m_SolverType = m_SolverType;
+        copy->m_IterativeSettings = m_IterativeSettings;
+        copy->m_PartitionSettings = m_PartitionSettings;
+        copy->m_IntegrationMethod = m_IntegrationMethod;
+        copy->m_NewtonSettings = m_NewtonSettings;
+        copy->m_LatencySettings = m_LatencySettings;
+        copy->m_SourceBlockSize = m_SourceBlockSize;
+        copy->m_ColumnOrdering = m_ColumnOrdering;
+        return copy;
+    }
+
+    std::vector<Component*> CircuitBuilder::GetStateComponents() const {
+        std::vector<Component*> components;
+        components.insert(components.end(), m_Capacitors.begin(), m_Capacitors.end());
+        components.insert(components.end(), m_Inductors.begin(), m_Inductors.end());
+        components.insert(components.end(), m_VoltageSources.begin(), m_VoltageSources.end());
+        components.insert(components.end(), m_Nonlinear.begin(), m_Nonlinear.end());
+        components.insert(components.end(), m_ReducedNetworks.begin(), m_ReducedNetworks.end());
+        return components;
+    }
+
+    Checkpoint CircuitBuilder::SaveCheckpoint() {
+        if (!m_Compiled) Compile();
+
+        Checkpoint checkpoint;
+        checkpoint.time = m_CurrentTime;
+        checkpoint.nextStep = m_AdaptiveStats.lastStep;
+        checkpoint.nodeVoltages.assign(m_NodeCount, 0.0);
+        for (auto node : m_Nodes) {
+            if (node->Index >= 0) checkpoint.nodeVoltages[node->Index] = node->Voltage;
+        }
+
+        std::vector<Component*> components = GetStateComponents();
+        size_t size = 0;
+        for (auto comp : components) size += comp->GetStateSize();
+        checkpoint.componentState.resize(size);
+        double* values = checkpoint.componentState.data();
+        for (auto comp : components) {
+            comp->SaveState(values);
+            values += comp->GetStateSize();
+        }
+
+        if (m_V.size() == m_MatrixSize) checkpoint.solution.assign(m_V.data(), m_V.data() + m_V.size());
+        return checkpoint;
+    }
+
+    bool CircuitBuilder::RestoreCheckpoint(const Checkpoint& checkpoint) {
+        if (!m_Compiled) Compile();
+
+        std::vector<Component*> components = GetStateComponents();
+        size_t size = 0;
+        for (auto comp : components) size += comp->GetStateSize();
+        if (checkpoint.nodeVoltages.size() != static_cast<size_t>(m_NodeCount) || checkpoint.componentState.size() != size ||
+            (!checkpoint.solution.empty() && checkpoint.solution.size() != static_cast<size_t>(m_MatrixSize))) {
+            return false;
+        }
+
+        m_CurrentTime = checkpoint.time;
+        m_AdaptiveStats.lastStep = checkpoint.nextStep;
+        for (auto node : m_Nodes) node->Voltage = node->Index >= 0 ? checkpoint.nodeVoltages[node->Index] : 0.0;
+        const double* values = checkpoint.componentState.data();
+        for (auto comp : components) {
+            comp->RestoreState(values);
+            values += comp->GetStateSize();
+        }
+        if (!checkpoint.solution.empty()) m_V = Eigen::Map<const Eigen::VectorXd>(checkpoint.solution.data(), m_MatrixSize);
+
+        // The device linearizations no longer match the factored Jacobian, and every
+        // partition starts out active again
+        m_JacobianCurrent = false;
+        std::fill(m_Latent.begin(), m_Latent.end(), 0);
+        std::fill(m_QuietSteps.begin(), m_QuietSteps.end(), 0);
+        return true;
+    }
+
     // Probe management
     ProbeManager& CircuitBuilder::GetProbeManager() {
         return m_ProbeManager;
@@ -1,30 +1,363 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <utility>
 #include <vector>
+#include "Arena.hpp"
+#include "Checkpoint.hpp"
 #include "Component.hpp"
+#include "ComponentArrays.hpp"
 #include "Node.hpp"
 #include "ProbeManager.hpp"
+#include "LinearSolver.hpp"
+#include "PartitionedSolver.hpp"
 
 namespace ecim {
     class VoltageSource;
+    class DCVoltageSource;
+    class ACVoltageSource;
     class Resistor;
     class Capacitor;
     class Inductor;
+    class NonlinearComponent;
+    class ReducedNetwork;
+
+    // Step size control for CircuitBuilder::SimulateAdaptive()
+    struct AdaptiveSettings {
+        double relTol = 1e-3;           // Local truncation error relative to the state magnitude
+        double absTol = 1e-6;           // Absolute error floor (V for capacitors, A for inductors)
+        double initialStep = 0.0;       // 0 = duration / 1000
+        double minStep = 0.0;           // Steps this short are accepted regardless, 0 = duration * 1e-12
+        double maxStep = 0.0;           // 0 = duration / 10
+        double maxGrowth = 2.0;         // Largest step increase after an accepted step
+        double safety = 0.9;            // Margin applied to the predicted step
+    };
+
+    struct AdaptiveStats {
+        size_t acceptedSteps = 0;
+        size_t rejectedSteps = 0;
+        double smallestStep = 0.0;      // Of the accepted steps
+        double largestStep = 0.0;
+        double lastStep = 0.0;          // Proposed for the next call, used to continue a run
+    };
+
+    // Newton-Raphson control for circuits with nonlinear devices
+    struct NewtonSettings {
+        int maxIterations = 50;
+        double relTol = 1e-3;           // Node voltage change relative to its magnitude
+        double vnTol = 1e-6;            // Absolute node voltage change (V)
+        double bypassTolerance = 1e-6;  // Devices whose terminals moved less keep their linearization (V), 0 = off
+        bool reuseJacobian = true;      // Keep the factored Jacobian while iterations still contract
+    };
+
+    struct NewtonStats {
+        size_t steps = 0;               // Nonlinear solves (time steps and operating points)
+        size_t iterations = 0;
+        int maxIterations = 0;          // Most iterations any solve needed
+        size_t failedSteps = 0;         // Solves that hit the iteration limit
+        size_t factorizations = 0;      // Jacobian factorizations (the rest reused old factors)
+        size_t evaluations = 0;         // Device model evaluations
+        size_t bypasses = 0;            // Device updates skipped by bypass
+
+        double IterationsPerStep() const { return steps ? double(iterations) / steps : 0.0; }
+        double BypassRate() const { return (evaluations + bypasses) ? double(bypasses) / (evaluations + bypasses) : 0.0; }
+    };
+
+    // Multirate (latency) control for Step() and Simulate()
+    struct LatencySettings {
+        bool enabled = false;
+        int partitions = 0;             // Node partitions, 0 = one per partitionSize nodes
+        int partitionSize = 16;
+        double tolerance = 1e-6;        // Node voltage or source change per step below which a partition is quiet (V)
+        int quietSteps = 3;             // Consecutive quiet steps before a partition is frozen
+    };
+
+    struct LatencyStats {
+        size_t steps = 0;
+        size_t partitionSteps = 0;      // Partitions times steps
+        size_t latentPartitionSteps = 0;// Of those, partitions that stayed frozen
+        size_t freezes = 0;             // Partitions that went latent
+        size_t wakeups = 0;             // Latent partitions woken by a source or their boundary
+        size_t resolves = 0;            // Steps solved again after a boundary wake-up
+
+        double LatentFraction() const { return partitionSteps ? double(latentPartitionSteps) / partitionSteps : 0.0; }
+    };
 
     class CircuitBuilder {
+        // Nodes and components from the factory methods live in the arena and go with
+        // it; the ones added by pointer are deleted one by one
+        Arena m_Arena;
+        std::vector<Component*> m_OwnedComponents;
+        std::vector<Node*> m_OwnedNodes;
+
         std::vector<Component*> m_Components;
         std::vector<Node*> m_Nodes;
+        std::unordered_set<const Node*> m_NodeSet;  // Membership of m_Nodes
+        Node* m_Ground = nullptr;                 // Explicit ground, else the node with ID 0
+        int m_NextNodeId = 1;                     // Numbering of CreateNode()
         double m_CurrentTime = 0.0;
         ProbeManager m_ProbeManager;
+        SolverType m_SolverType = SolverType::DenseQR;
+        std::unique_ptr<LinearSolver> m_Solver;
+        IterativeSettings m_IterativeSettings;
+        PartitionSettings m_PartitionSettings;
+        IntegrationMethod m_IntegrationMethod = IntegrationMethod::BackwardEuler;
+        ColumnOrdering m_ColumnOrdering;          // Handed to the backend when it is created
+
+        // Compiled plan, rebuilt by Compile() whenever the topology changes
+        bool m_Compiled = false;
+        int m_NodeCount = 0;                      // Non-ground nodes (rows 0..m_NodeCount-1)
+        int m_MatrixSize = 0;                     // Node rows + one row per voltage source
+        std::vector<Resistor*> m_Resistors;
+        std::vector<Capacitor*> m_Capacitors;
+        std::vector<Inductor*> m_Inductors;
+        std::vector<VoltageSource*> m_VoltageSources;  // Source k owns row m_NodeCount + k
+        std::vector<NonlinearComponent*> m_Nonlinear;  // Any entries switch Solve() to Newton-Raphson
+        std::vector<ReducedNetwork*> m_ReducedNetworks;
+
+        // Packed rows and per-step values of the linear components (same order as the
+        // lists above); Assemble() and Accept() loop over these
+        TwoTerminalArrays m_ResistorArrays;
+        TwoTerminalArrays m_CapacitorArrays;
+        TwoTerminalArrays m_InductorArrays;
+        TwoTerminalArrays m_SourceArrays;       // Only the rows are used
+
+        // Persistent workspaces reused by every step
+        Eigen::MatrixXd m_G;
+        Eigen::VectorXd m_I;
+        Eigen::VectorXd m_V;
+        std::vector<Eigen::Triplet<double>> m_Triplets;
+        SparseMatrix m_SparseG;
+
+        // Factorization cache: G only depends on topology, resistances and the companion
+        // conductances (dt, method and C/L values), so while those are unchanged a step
+        // only rebuilds I and back-substitutes
+        bool m_FactorValid = false;
+        double m_FactorDt = 0.0;
+        std::vector<double> m_FactorValues;       // Conductances the factors were built with
+        size_t m_FactorizationCount = 0;
+
+        AdaptiveStats m_AdaptiveStats;
+
+        // Source voltages of the upcoming fixed steps, evaluated in blocks by Simulate()
+        // and only valid during it (source parameters may be edited between runs)
+        int m_SourceBlockSize = 64;
+        std::vector<double> m_SourceBlock;        // Source-major, m_SourceBlockCount samples each
+        double m_SourceBlockStart = 0.0;
+        double m_SourceBlockStep = 0.0;
+        int m_SourceBlockCount = 0;
+
+        void FillSourceBlock(double start, double step);
+        int GetSourceBlockSample(double time) const;   // -1 if time isn't buffered
+        double GetSourceVoltage(size_t source, double time) const;
+
+        NewtonSettings m_NewtonSettings;
+        NewtonStats m_NewtonStats;
+        bool m_JacobianCurrent = false;           // The factors match the present device linearization
+
+        // Latency: rows of frozen partitions keep their last solution and only the
+        // active rows are solved, with a separate sparse LU of the reduced system
+        LatencySettings m_LatencySettings;
+        LatencyStats m_LatencyStats;
+        int m_PartitionCount = 0;
+        std::vector<int> m_RowPartition;          // Partition of every matrix row, empty until partitioned
+        std::vector<int> m_QuietSteps;            // Per partition
+        std::vector<char> m_Latent;               // Per partition: frozen at its last solution
+        std::vector<char> m_ReducedLatent;        // Latent set the reduced system was built for
+        SparseMatrix m_LatencyMatrix;             // Full G for the present factorization key
+        Eigen::SparseMatrix<double, Eigen::RowMajor> m_LatencyRows;
+        bool m_LatencyMatrixValid = false;        // Cleared by every full solve
+        std::vector<int> m_ActiveRows;
+        std::vector<int> m_ReducedIndex;          // Per row: index in the reduced system, -1 if frozen
+        std::vector<int> m_BoundaryRows;          // Frozen rows coupled to active ones
+        std::vector<Eigen::Triplet<double>> m_ReducedCoupling;  // G(active, frozen) as (reduced row, row, value)
+        SparseMatrix m_ReducedMatrix;
+        std::unique_ptr<LinearSolver> m_ReducedSolver;
+
+        void PartitionLatency();
+        void StepLatent(double deltaTime);
+        // Solve the active rows with the latent partitions frozen. Latent partitions
+        // whose boundary rows no longer balance are added to woken.
+        void SolveReduced(double deltaTime, std::vector<int>& woken);
+        bool IsFrozen(const Component* component) const;
+
+        bool UpdateFactorizationKey(double deltaTime);  // Returns true if the key changed
+        void BuildMatrix();                       // Compress m_Triplets into m_SparseG (sparse backends)
+        bool Factorize();                         // False if the backend couldn't factor G (nothing is cached)
+        void SolveNewton(double deltaTime);
+        // Linearize (or bypass) every device. Returns true if any linearization changed,
+        // limited is set if any device limited its voltages.
+        bool UpdateDevices(bool& limited);
+
+        // Step() in two halves: Solve() advances the clock and solves for the new
+        // node voltages, Accept() commits them to the reactive state and the probes.
+        // The adaptive mode rejects a step by re-solving before Accept().
+        void Solve(double deltaTime);
+        void Accept();
+        void SolveSystem(double deltaTime);       // Solve() after the clock was advanced
+        void ExtractSolution();                   // Node voltages and source currents from m_V
+        double EstimateError(double relTol, double absTol) const;  // Largest component error ratio
+
+        // Stamp every component into m_I, and into G or triplets when given, at m_CurrentTime
+        void Assemble(double deltaTime, Eigen::MatrixXd* G, std::vector<Eigen::Triplet<double>>* triplets);
+
+        void TrackNode(Node* node);
+        // Components with dynamic state in compiled order, which doesn't depend on
+        // the order they were added in
+        std::vector<Component*> GetStateComponents() const;
 
     public:
         ~CircuitBuilder();
         void AddComponent(Component *component, Node *node1, Node *node2);
+        // Multi-port components: ports[k] becomes the component's port k. Returns
+        // false (and takes no ownership) if the count doesn't match GetPortCount().
+        bool AddComponent(Component *component, const std::vector<Node*>& ports);
+
+        // Factory methods: the node or component is placed in this circuit's arena,
+        // next to the ones created before it, and released in bulk with the circuit.
+        // Don't delete them or hand them to another circuit. CreateNode() numbers the
+        // nodes per circuit (from 1) without the process-wide Node::nextId, so
+        // circuits built this way can be built and simulated on separate threads.
+        Node* CreateNode();
+        // The circuit's ground: the node given to SetGround(), else one created on
+        // first use (ID 0). Without either, a node with ID 0 is ground.
+        Node* GetGround();
+        void SetGround(Node* node);
+        Resistor* AddResistor(Node* node1, Node* node2, double resistance);
+        Capacitor* AddCapacitor(Node* node1, Node* node2, double capacitance);
+        Inductor* AddInductor(Node* node1, Node* node2, double inductance);
+        DCVoltageSource* AddDCVoltageSource(Node* node1, Node* node2, double voltage);
+        ACVoltageSource* AddACVoltageSource(Node* node1, Node* node2, double amplitude, double frequency, double phase = 0.0);
+
+        // Any other two-terminal component type, constructed from args
+        template <class T, class... Args>
+        T* Add(Node* node1, Node* node2, Args&&... args) {
+            T* component = m_Arena.Create<T>(std::forward<Args>(args)...);
+            AddComponent(component, node1, node2);
+            return component;
+        }
+
+        // Capacity for the given numbers of components and nodes, e.g. before a bulk load
+        void Reserve(size_t components, size_t nodes);
+
+        const Arena& GetArena() const;
         const std::vector<Node*>& GetNodes() const;
+        const std::vector<Component*>& GetComponents() const;
         double GetCurrentTime() const;
+
+        // Build the node index map, voltage source rows, per-type component lists
+        // and workspaces. Step() calls this automatically after the topology changes.
+        void Compile();
+        bool IsCompiled() const;
+
+        // Compiled plan, valid after Compile()
+        int GetMatrixSize() const;
+        int GetNodeRowCount() const;   // Rows owned by non-ground nodes; source k owns row GetNodeRowCount() + k
+        const std::vector<Resistor*>& GetResistors() const;
+        const std::vector<Capacitor*>& GetCapacitors() const;
+        const std::vector<Inductor*>& GetInductors() const;
+        const std::vector<VoltageSource*>& GetVoltageSources() const;
+        const std::vector<NonlinearComponent*>& GetNonlinearComponents() const;
+        const std::vector<ReducedNetwork*>& GetReducedNetworks() const;
+
         void Step(double deltaTime);
-        void Simulate(double duration, double deltaTime);
+        // Fixed steps of deltaTime, shortened where needed to land on source breakpoints.
+        // afterStep (optional) is called after every step, e.g. to record samples.
+        void Simulate(double duration, double deltaTime, const std::function<void()>& afterStep = nullptr);
+        // Earliest breakpoint of any voltage source after time, INFINITY if none (needs Compile())
+        double GetNextBreakpoint(double time) const;
+        // Simulate() evaluates the sources for this many upcoming steps at once
+        // (VoltageSource::EvaluateBlock); 0 evaluates them one step at a time
+        void SetSourceBlockSize(int steps);
+        int GetSourceBlockSize() const;
+
+        // Multirate mode for Step() and Simulate() on linear circuits. The nodes are
+        // split into partitions; a partition whose voltages and sources moved less
+        // than the tolerance for a few steps is frozen: its rows keep their last
+        // solution, its capacitors and inductors hold their state, and only the
+        // active rows are solved. A frozen partition wakes when one of its sources
+        // moves or when its rows next to the active ones stop balancing (the step is
+        // then solved again). Continuous probes see frozen nodes at their held value.
+        // Circuits with nonlinear devices always step in full.
+        void SetLatencySettings(const LatencySettings& settings);
+        const LatencySettings& GetLatencySettings() const;
+        const LatencyStats& GetLatencyStats() const;
+        void ResetLatencyStats();
+
+        // Integration method of the capacitor and inductor companion models
+        // (backward Euler by default). Takes effect at the next step.
+        void SetIntegrationMethod(IntegrationMethod method);
+        IntegrationMethod GetIntegrationMethod() const;
+
+        // DC operating point at the current time: capacitors open, inductors shorted,
+        // sources at their current value. Sets node voltages and source currents and
+        // seeds the capacitor voltages and inductor currents, so a following transient
+        // starts in steady state. gmin (S) ties every node to ground so nodes only
+        // reached through capacitors stay solvable. Nonlinear devices are iterated with
+        // Newton-Raphson. Returns false if the solve failed or didn't converge.
+        bool SolveOperatingPoint(double gmin = 1e-12);
+
+        // Simulate with a variable timestep: steps grow while the local truncation
+        // error of the capacitor and inductor states stays within tolerance and are
+        // rejected and retried shorter at transitions; steps end on source breakpoints.
+        // Continuous probes only see accepted steps, stamped with their actual time.
+        // The run ends exactly at GetCurrentTime() + duration.
+        void SimulateAdaptive(double duration, const AdaptiveSettings& settings = AdaptiveSettings());
+        const AdaptiveStats& GetAdaptiveStats() const;
         void ResetTime();
+
+        // Linear solver backend selection; the backend reports timing and residual
+        void SetSolverType(SolverType type);
+        SolverType GetSolverType() const;
+        LinearSolver& GetLinearSolver();
+
+        // Newton-Raphson iteration used when the circuit contains nonlinear devices.
+        // Devices are bypassed while their terminal voltages stay put, and the factored
+        // Jacobian is reused (as a chord iteration) across iterations and steps until
+        // the iteration stops contracting.
+        void SetNewtonSettings(const NewtonSettings& settings);
+        const NewtonSettings& GetNewtonSettings() const;
+        const NewtonStats& GetNewtonStats() const;
+        void ResetNewtonStats();
+
+        // Fill-reducing column ordering for the sparse LU backend. Circuits with the same
+        // topology (e.g. clones in a parameter sweep) can share one ordering instead of
+        // each running its own analysis. AnalyzeOrdering() computes it for this circuit
+        // without advancing the simulation.
+        void SetColumnOrdering(ColumnOrdering ordering);
+        // The ordering given above, else the one the backend computed, if any
+        ColumnOrdering GetColumnOrdering() const;
+        ColumnOrdering AnalyzeOrdering(double deltaTime);
+
+        // Deep copy with the same node IDs, component values and state, solver settings
+        // and clock. Probes are not copied. Returns nullptr if a component can't be cloned.
+        std::unique_ptr<CircuitBuilder> Clone() const;
+
+        // Dynamic state (clock, node voltages, component state) for continuing the
+        // simulation later, possibly several times or in another process. Restoring
+        // needs a circuit with the same layout: this one, a Clone() or one loaded
+        // from a CircuitSnapshot of it; it returns false otherwise. Component values,
+        // settings and probe records are not part of a checkpoint. Linear circuits
+        // continue exactly as without the interruption; with nonlinear devices the
+        // Jacobian is refactored, and latent partitions wake up.
+        Checkpoint SaveCheckpoint();
+        bool RestoreCheckpoint(const Checkpoint& checkpoint);
+
+        // Tolerance, iteration limit, preconditioner and warm start for SolverType::Iterative
+        void SetIterativeSettings(const IterativeSettings& settings);
+        const IterativeSettings& GetIterativeSettings() const;
+
+        // Domain count, worker threads and minimum domain size for SolverType::Partitioned.
+        // Partition quality and per-domain timing are reported by the backend
+        // (PartitionedSolver::GetPartitionStats()).
+        void SetPartitionSettings(const PartitionSettings& settings);
+        const PartitionSettings& GetPartitionSettings() const;
+
+        // Number of matrix factorizations performed so far (steps that reused
+        // the cached factorization don't count)
+        size_t GetFactorizationCount() const;
         
         // Probe management
         ProbeManager& GetProbeManager();
@@ -0,0 +1,412 @@
+#include "CircuitSnapshot.hpp"
+#include "ACVoltageSource.hpp"
+#include "Capacitor.hpp"
+#include "DCVoltageSource.hpp"
+#include "Diode.hpp"
+#include "Inductor.hpp"
+#include "MappedFile.hpp"
+#include "Mosfet.hpp"
+#include "PulseVoltageSource.hpp"
+#include "PWLVoltageSource.hpp"
+#include "ReducedNetwork.hpp"
+#include "Resistor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <typeinfo>
+
+namespace ecim {
+    namespace {
+        enum Section { Nodes, Resistors, Capacitors, Inductors, Sources, Devices, Networks, Values, Ports, Ordering, SectionCount };
+        enum SourceKind : uint32_t { DCSource, ACSource, PulseSource, PWLSource };
+        enum DeviceKind : uint32_t { DiodeDevice, MosfetDevice };
+
+        struct SectionEntry {
+            uint64_t offset;        // From the start of the file, multiple of 8
+            uint64_t count;         // Records
+        };
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;     // ByteOrderMark as the writer stored it
+            uint64_t fileSize;
+            int32_t solverType;
+            int32_t integrationMethod;
+            int32_t nodeRows;       // Layout of the compiled circuit, checked after loading
+            int32_t matrixSize;
+            SectionEntry sections[SectionCount];
+        };
+
+        // Node references are positions in the node table
+        struct NodeRecord {
+            int32_t id;
+            int32_t row;            // -1 for ground
+        };
+
+        struct ElementRecord {
+            int32_t node1, node2;
+            double value;
+        };
+
+        struct SourceRecord {
+            uint32_t kind;
+            int32_t node1, node2;
+            uint32_t valueCount;
+            uint64_t valueOffset;
+        };
+
+        struct DeviceRecord {
+            uint32_t kind;
+            int32_t node1, node2, gate;
+            double parameters[3];
+        };
+
+        struct NetworkRecord {
+            int32_t ports;
+            int32_t size;           // Ports plus states
+            uint64_t portOffset;
+            uint64_t valueOffset;
+        };
+
+        const char Magic[8] = {'E', 'C', 'I', 'M', 'S', 'N', 'A', 'P'};
+        const uint32_t ByteOrderMark = 0x01020304;
+
+        static_assert(sizeof(Header) % 8 == 0 && sizeof(NodeRecord) == 8 && sizeof(ElementRecord) == 16 &&
+                      sizeof(SourceRecord) == 24 && sizeof(DeviceRecord) == 40 && sizeof(NetworkRecord) == 24,
+                      "Snapshot records must have a fixed, padding-free layout");
+
+        uint64_t Align(uint64_t size) {
+            return (size + 7) & ~uint64_t(7);
+        }
+
+        // Records of a section of a validated file. Mappings are page aligned, so every
+        // section is aligned for its records.
+        template <class T>
+        const T* SectionData(const char* data, const Header& header, Section section) {
+            return reinterpret_cast<const T*>(data + header.sections[section].offset);
+        }
+
+        template <class T>
+        void WriteSection(std::ofstream& out, const std::vector<T>& records) {
+            const size_t bytes = records.size() * sizeof(T);
+            if (bytes > 0) out.write(reinterpret_cast<const char*>(records.data()), bytes);
+            const char padding[8] = {};
+            out.write(padding, Align(bytes) - bytes);
+        }
+    }
+
+    bool CircuitSnapshot::Fail(const std::string& message) {
+        m_Error = message;
+        return false;
+    }
+
+    bool CircuitSnapshot::Save(const CircuitBuilder& circuit, const std::string& path, bool includeOrdering) {
+        m_Error.clear();
+        if (!circuit.IsCompiled()) return Fail("Circuit is not compiled");
+
+        // Node table in row order, ground first
+        std::vector<Node*> nodes(circuit.GetNodes());
+        std::stable_sort(nodes.begin(), nodes.end(), [](Node* a, Node* b) { return a->Index < b->Index; });
+        std::unordered_map<const Node*, int32_t> position;
+        position.reserve(nodes.size());
+        std::vector<NodeRecord> nodeRecords;
+        nodeRecords.reserve(nodes.size());
+        for (Node* node : nodes) {
+            position[node] = static_cast<int32_t>(nodeRecords.size());
+            nodeRecords.push_back({node->Id, node->Index < 0 ? -1 : node->Index});
+        }
+        auto ref = [&](const Node* node) {
+            auto it = position.find(node);
+            return it == position.end() ? -1 : it->second;
+        };
+
+        auto elements = [&](const auto& components, auto value) {
+            std::vector<ElementRecord> records;
+            records.reserve(components.size());
+            for (auto component : components) {
+                records.push_back({ref(component->GetNode1()), ref(component->GetNode2()), value(component)});
+            }
+            return records;
+        };
+        std::vector<ElementRecord> resistors = elements(circuit.GetResistors(), [](const Resistor* r) { return r->GetResistance(); });
+        std::vector<ElementRecord> capacitors = elements(circuit.GetCapacitors(), [](const Capacitor* c) { return c->GetCapacitance(); });
+        std::vector<ElementRecord> inductors = elements(circuit.GetInductors(), [](const Inductor* l) { return l->GetInductance(); });
+
+        std::vector<double> values;
+        std::vector<int32_t> ports;
+        std::vector<SourceRecord> sources;
+        for (const VoltageSource* source : circuit.GetVoltageSources()) {
+            SourceRecord record = {0, ref(source->GetNode1()), ref(source->GetNode2()), 0, values.size()};
+            const std::type_info& type = typeid(*source);
+            if (type == typeid(DCVoltageSource)) {
+                record.kind = DCSource;
+                values.push_back(source->GetVoltage(0.0));
+            } else if (type == typeid(ACVoltageSource)) {
+                auto ac = static_cast<const ACVoltageSource*>(source);
+                record.kind = ACSource;
+                values.insert(values.end(), {ac->GetAmplitude(), ac->GetFrequency(), ac->GetPhase()});
+            } else if (type == typeid(PulseVoltageSource)) {
+                auto pulse = static_cast<const PulseVoltageSource*>(source);
+                record.kind = PulseSource;
+                values.insert(values.end(), {pulse->GetV1(), pulse->GetV2(), pulse->GetDelay(), pulse->GetRise(),
+                                             pulse->GetFall(), pulse->GetWidth(), pulse->GetPeriod()});
+            } else if (type == typeid(PWLVoltageSource)) {
+                auto pwl = static_cast<const PWLVoltageSource*>(source);
+                record.kind = PWLSource;
+                for (size_t k = 0; k < pwl->GetPointCount(); k++) {
+                    values.push_back(pwl->GetPointTime(k));
+                    values.push_back(pwl->GetPointVoltage(k));
+                }
+            } else {
+                return Fail("Source " + std::to_string(sources.size()) + " has no binary form");
+            }
+            record.valueCount = static_cast<uint32_t>(values.size() - record.valueOffset);
+            sources.push_back(record);
+        }
+
+        std::vector<DeviceRecord> devices;
+        for (const NonlinearComponent* device : circuit.GetNonlinearComponents()) {
+            DeviceRecord record = {0, ref(device->GetNode1()), ref(device->GetNode2()), -1, {0.0, 0.0, 0.0}};
+            const std::type_info& type = typeid(*device);
+            if (type == typeid(Diode)) {
+                auto diode = static_cast<const Diode*>(device);
+                record.kind = DiodeDevice;
+                record.parameters[0] = diode->GetSaturationCurrent();
+                record.parameters[1] = diode->GetEmissionCoefficient();
+            } else if (type == typeid(Mosfet)) {
+                auto mosfet = static_cast<const Mosfet*>(device);
+                record.kind = MosfetDevice;
+                record.gate = ref(mosfet->GetGate());
+                record.parameters[0] = mosfet->GetK();
+                record.parameters[1] = mosfet->GetThreshold();
+                record.parameters[2] = mosfet->GetLambda();
+            } else {
+                return Fail("Device " + std::to_string(devices.size()) + " has no binary form");
+            }
+            devices.push_back(record);
+        }
+
+        std::vector<NetworkRecord> networks;
+        for (const ReducedNetwork* network : circuit.GetReducedNetworks()) {
+            const Eigen::MatrixXd& G = network->GetConductanceMatrix();
+            const Eigen::MatrixXd& C = network->GetCapacitanceMatrix();
+            networks.push_back({static_cast<int32_t>(network->GetPortCount()), static_cast<int32_t>(G.rows()),
+                                ports.size(), values.size()});
+            for (size_t k = 0; k < network->GetPortCount(); k++) ports.push_back(ref(network->GetPort(k)));
+            values.insert(values.end(), G.data(), G.data() + G.size());
+            values.insert(values.end(), C.data(), C.data() + C.size());
+        }
+
+        std::vector<int32_t> ordering;
+        ColumnOrdering columns = includeOrdering ? circuit.GetColumnOrdering() : nullptr;
+        if (columns && columns->size() == circuit.GetMatrixSize()) ordering.assign(columns->data(), columns->data() + columns->size());
+
+        Header header = {};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.byteOrder = ByteOrderMark;
+        header.solverType = static_cast<int32_t>(circuit.GetSolverType());
+        header.integrationMethod = static_cast<int32_t>(circuit.GetIntegrationMethod());
+        header.nodeRows = circuit.GetNodeRowCount();
+        header.matrixSize = circuit.GetMatrixSize();
+        uint64_t offset = sizeof(Header);
+        auto place = [&](Section section, size_t count, size_t recordSize) {
+            header.sections[section] = {offset, count};
+            offset += Align(count * recordSize);
+        };
+        place(Nodes, nodeRecords.size(), sizeof(NodeRecord));
+        place(Resistors, resistors.size(), sizeof(ElementRecord));
+        place(Capacitors, capacitors.size(), sizeof(ElementRecord));
+        place(Inductors, inductors.size(), sizeof(ElementRecord));
+        place(Sources, sources.size(), sizeof(SourceRecord));
+        place(Devices, devices.size(), sizeof(DeviceRecord));
+        place(Networks, networks.size(), sizeof(NetworkRecord));
+        place(Values, values.size(), sizeof(double));
+        place(Ports, ports.size(), sizeof(int32_t));
+        place(Ordering, ordering.size(), sizeof(int32_t));
+        header.fileSize = offset;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return Fail("Cannot write " + path);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteSection(out, nodeRecords);
+        WriteSection(out, resistors);
+        WriteSection(out, capacitors);
+        WriteSection(out, inductors);
+        WriteSection(out, sources);
+        WriteSection(out, devices);
+        WriteSection(out, networks);
+        WriteSection(out, values);
+        WriteSection(out, ports);
+        WriteSection(out, ordering);
+        if (!out) return Fail("Cannot write " + path);
+        return true;
+    }
+
+    bool CircuitSnapshot::Load(const std::string& path, CircuitBuilder& circuit) {
+        const auto start = std::chrono::steady_clock::now();
+        m_Error.clear();
+        m_NodesById.clear();
+        if (!circuit.GetNodes().empty() || !circuit.GetComponents().empty()) return Fail("Target circuit is not empty");
+
+        MappedFile file;
+        if (!file.Open(path)) return Fail("Cannot read " + path);
+        const char* data = file.GetData();
+        Header header;
+        if (file.GetSize() < sizeof(Header)) return Fail("Not a circuit snapshot");
+        std::memcpy(&header, data, sizeof(Header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return Fail("Not a circuit snapshot");
+        if (header.byteOrder != ByteOrderMark) return Fail("Snapshot was written with the other byte order");
+        if (header.version != Version) return Fail("Unsupported snapshot version " + std::to_string(header.version));
+        if (header.fileSize != file.GetSize()) return Fail("Snapshot is truncated");
+
+        const size_t recordSizes[SectionCount] = {sizeof(NodeRecord), sizeof(ElementRecord), sizeof(ElementRecord),
+                                                  sizeof(ElementRecord), sizeof(SourceRecord), sizeof(DeviceRecord),
+                                                  sizeof(NetworkRecord), sizeof(double), sizeof(int32_t), sizeof(int32_t)};
+        for (int k = 0; k < SectionCount; k++) {
+            const SectionEntry& entry = header.sections[k];
+            if (entry.offset % 8 != 0 || entry.offset > header.fileSize ||
+                entry.count > (header.fileSize - entry.offset) / recordSizes[k]) {
+                return Fail("Snapshot section " + std::to_string(k) + " is out of bounds");
+            }
+        }
+        auto count = [&](Section s) { return static_cast<size_t>(header.sections[s].count); };
+        const NodeRecord* nodeRecords = SectionData<NodeRecord>(data, header, Nodes);
+        const double* values = SectionData<double>(data, header, Values);
+        const int32_t* portIndices = SectionData<int32_t>(data, header, Ports);
+
+        size_t components = 0;
+        for (Section s : {Resistors, Capacitors, Inductors, Sources, Devices, Networks}) components += count(s);
+        circuit.Reserve(components, count(Nodes));
+
+        // Nodes in row order, so CreateNode() hands out IDs that keep the saved rows
+        std::vector<Node*> nodes(count(Nodes));
+        int expectedRow = 0;
+        for (size_t k = 0; k < nodes.size(); k++) {
+            const NodeRecord& record = nodeRecords[k];
+            if (record.row < 0) {
+                nodes[k] = circuit.GetGround();
+            } else {
+                if (record.row != expectedRow++) return Fail("Snapshot node table is not in row order");
+                nodes[k] = circuit.CreateNode();
+            }
+            m_NodesById[record.id] = nodes[k];
+        }
+        auto valid = [&](int32_t index) { return index >= 0 && static_cast<size_t>(index) < nodes.size(); };
+        auto node = [&](int32_t index) { return nodes[index]; };
+        auto inValues = [&](uint64_t offset, uint64_t length) {
+            return offset <= count(Values) && length <= count(Values) - offset;
+        };
+
+        const ElementRecord* resistors = SectionData<ElementRecord>(data, header, Resistors);
+        for (size_t k = 0; k < count(Resistors); k++) {
+            if (!valid(resistors[k].node1) || !valid(resistors[k].node2)) return Fail("Snapshot element refers to a missing node");
+            circuit.AddResistor(node(resistors[k].node1), node(resistors[k].node2), resistors[k].value);
+        }
+        const ElementRecord* capacitors = SectionData<ElementRecord>(data, header, Capacitors);
+        for (size_t k = 0; k < count(Capacitors); k++) {
+            if (!valid(capacitors[k].node1) || !valid(capacitors[k].node2)) return Fail("Snapshot element refers to a missing node");
+            circuit.AddCapacitor(node(capacitors[k].node1), node(capacitors[k].node2), capacitors[k].value);
+        }
+        const ElementRecord* inductors = SectionData<ElementRecord>(data, header, Inductors);
+        for (size_t k = 0; k < count(Inductors); k++) {
+            if (!valid(inductors[k].node1) || !valid(inductors[k].node2)) return Fail("Snapshot element refers to a missing node");
+            circuit.AddInductor(node(inductors[k].node1), node(inductors[k].node2), inductors[k].value);
+        }
+
+        const SourceRecord* sources = SectionData<SourceRecord>(data, header, Sources);
+        for (size_t k = 0; k < count(Sources); k++) {
+            const SourceRecord& record = sources[k];
+            const uint32_t expected[] = {1, 3, 7};
+            bool ok = valid(record.node1) && valid(record.node2) && inValues(record.valueOffset, record.valueCount) &&
+                         (record.kind == PWLSource ? record.valueCount % 2 == 0 :
+                          record.kind < PWLSource && record.valueCount == expected[record.kind]);
+            if (!ok) return Fail("Snapshot source " + std::to_string(k) + " is invalid");
+
+            const double* v = values + record.valueOffset;
+            Node* node1 = node(record.node1);
+            Node* node2 = node(record.node2);
+            switch (record.kind) {
+                case DCSource:
+                    circuit.AddDCVoltageSource(node1, node2, v[0]);
+                    break;
+                case ACSource:
+                    circuit.AddACVoltageSource(node1, node2, v[0], v[1], v[2]);
+                    break;
+                case PulseSource:
+                    circuit.Add<PulseVoltageSource>(node1, node2, v[0], v[1], v[2], v[3], v[4], v[5], v[6]);
+                    break;
+                default: {
+                    std::vector<std::pair<double, double>> points(record.valueCount / 2);
+                    for (size_t p = 0; p < points.size(); p++) points[p] = {v[2 * p], v[2 * p + 1]};
+                    circuit.Add<PWLVoltageSource>(node1, node2, points);
+                    break;
+                }
+            }
+        }
+
+        const DeviceRecord* devices = SectionData<DeviceRecord>(data, header, Devices);
+        for (size_t k = 0; k < count(Devices); k++) {
+            const DeviceRecord& record = devices[k];
+            if (!valid(record.node1) || !valid(record.node2) || (record.kind == MosfetDevice && !valid(record.gate))) {
+                return Fail("Snapshot device " + std::to_string(k) + " is invalid");
+            }
+            if (record.kind == DiodeDevice) {
+                circuit.Add<Diode>(node(record.node1), node(record.node2), record.parameters[0], record.parameters[1]);
+            } else if (record.kind == MosfetDevice) {
+                // The gate node already exists, so connecting it after AddComponent() is enough
+                Mosfet* mosfet = circuit.Add<Mosfet>(node(record.node1), node(record.node2), record.parameters[0],
+                                                     record.parameters[1], record.parameters[2]);
+                mosfet->SetGate(node(record.gate));
+            } else {
+                return Fail("Snapshot device " + std::to_string(k) + " is invalid");
+            }
+        }
+
+        const NetworkRecord* networks = SectionData<NetworkRecord>(data, header, Networks);
+        for (size_t k = 0; k < count(Networks); k++) {
+            const NetworkRecord& record = networks[k];
+            const uint64_t entries = uint64_t(record.size) * record.size;
+            if (record.ports < 0 || record.size < record.ports || record.portOffset > count(Ports) ||
+                uint64_t(record.ports) > count(Ports) - record.portOffset || !inValues(record.valueOffset, 2 * entries)) {
+                return Fail("Snapshot network " + std::to_string(k) + " is invalid");
+            }
+            std::vector<Node*> terminals(record.ports);
+            for (int p = 0; p < record.ports; p++) {
+                const int32_t index = portIndices[record.portOffset + p];
+                if (!valid(index)) return Fail("Snapshot network " + std::to_string(k) + " is invalid");
+                terminals[p] = node(index);
+            }
+            Eigen::Map<const Eigen::MatrixXd> G(values + record.valueOffset, record.size, record.size);
+            Eigen::Map<const Eigen::MatrixXd> C(values + record.valueOffset + entries, record.size, record.size);
+            circuit.AddComponent(new ReducedNetwork(record.ports, G, C), terminals);
+        }
+
+        if (header.solverType < 0 || header.solverType > static_cast<int32_t>(SolverType::Partitioned) ||
+            header.integrationMethod < 0 || header.integrationMethod > static_cast<int32_t>(IntegrationMethod::BDF2)) {
+            return Fail("Snapshot settings are invalid");
+        }
+        circuit.SetSolverType(static_cast<SolverType>(header.solverType));
+        circuit.SetIntegrationMethod(static_cast<IntegrationMethod>(header.integrationMethod));
+        if (count(Ordering) > 0) {
+            const int32_t* columns = SectionData<int32_t>(data, header, Ordering);
+            circuit.SetColumnOrdering(std::make_shared<const Eigen::VectorXi>(
+                Eigen::Map<const Eigen::VectorXi>(columns, count(Ordering))));
+        }
+
+        circuit.Compile();
+        if (circuit.GetNodeRowCount() != header.nodeRows || circuit.GetMatrixSize() != header.matrixSize) {
+            return Fail("Loaded circuit doesn't match the saved layout");
+        }
+        m_LoadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    Node* CircuitSnapshot::GetNode(int savedId) const {
+        auto it = m_NodesById.find(savedId);
+        return it == m_NodesById.end() ? nullptr : it->second;
+    }
+}
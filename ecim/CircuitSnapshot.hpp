@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "CircuitBuilder.hpp"
+
+namespace ecim {
+    // Binary image of a compiled circuit, for workers that start from the same
+    // circuit many times. The file holds a versioned header and a table of
+    // 8-byte aligned sections of fixed-size records:
+    //
+    //     nodes        ID and matrix row, in row order (ground first)
+    //     resistors, capacitors, inductors     node1, node2, value
+    //     sources      kind, nodes and a range of the value pool (in row order)
+    //     devices      diodes and MOSFETs with their model parameters
+    //     networks     reduced networks: a range of the port pool and of the
+    //                  value pool (G then C, column-major)
+    //     values, ports, ordering              pools, ordering is the sparse LU
+    //                  column permutation (optional)
+    //
+    // Components refer to nodes by their position in the node table. Load() maps
+    // the file and reads the records in place; the only fix-up is turning node
+    // positions into the nodes it creates. Since nodes and sources are created in
+    // row order, the loaded circuit has the same matrix layout as the saved one
+    // and the stored ordering applies to it unchanged. The snapshot holds values
+    // and settings, not simulation state (capacitor voltages, time, ...).
+    //
+    // Files are written in the machine's byte order and are rejected by a machine
+    // with the other one, and by a reader of another format version.
+    class CircuitSnapshot {
+        std::string m_Error;
+        std::unordered_map<int, Node*> m_NodesById;   // Saved ID -> node of the last Load()
+        double m_LoadSeconds = 0.0;
+
+        bool Fail(const std::string& message);
+
+    public:
+        static const unsigned Version = 1;
+
+        // Write a compiled circuit. Fails for components without a binary form
+        // (custom sources, user-defined types). With includeOrdering the circuit's
+        // column ordering (GetColumnOrdering()) is stored when there is one.
+        bool Save(const CircuitBuilder& circuit, const std::string& path, bool includeOrdering = true);
+
+        // Rebuild a saved circuit into an empty one with its factory methods, restore
+        // solver type, integration method and ordering, and compile it. Returns false
+        // with GetError() set for a damaged or foreign file; components read before
+        // the damage stay in the circuit.
+        bool Load(const std::string& path, CircuitBuilder& circuit);
+
+        // Node of the last Load() by the ID it had in the saved circuit (nodes are
+        // renumbered by CreateNode()), nullptr if there was none
+        Node* GetNode(int savedId) const;
+
+        const std::string& GetError() const { return m_Error; }
+        double GetLoadSeconds() const { return m_LoadSeconds; }
+    };
+}
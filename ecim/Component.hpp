@@ -1,15 +1,27 @@
 #pragma once
 
+#include <vector>
 #include "Eigen/Dense"
+#include "Eigen/Sparse"
+#include "Arena.hpp"
 #include "Node.hpp"
+#include "Integration.hpp"
 
 namespace ecim {
     struct SimulationState {
-        Eigen::MatrixXd &G;      // Conductance matrix
+        Eigen::MatrixXd *G;                             // Conductance matrix (dense engine)
+        std::vector<Eigen::Triplet<double>> *triplets;  // Conductance entries (sparse engine)
         Eigen::VectorXd &I;      // Current vector
         double dt;               // Time step
         int vsIndex;             // Voltage source index
         double time;             // Current simulation time
+        IntegrationMethod method = IntegrationMethod::BackwardEuler;  // Companion models of reactive components
+
+        // Add a value to the conductance matrix, whichever engine is assembling it
+        void StampG(int row, int col, double value) {
+            if (G) (*G)(row, col) += value;
+            else if (triplets) triplets->emplace_back(row, col, value);
+        }
     };
 
     class Component {
@@ -24,6 +36,33 @@ namespace ecim {
             m_Node2 = node2;
         }
 
+        Node* GetNode1() const { return m_Node1; }
+        Node* GetNode2() const { return m_Node2; }
+
+        // Third terminal of devices that have one (e.g. a transistor gate). It is
+        // connected by the device itself; CircuitBuilder tracks it like node1/node2.
+        virtual Node* GetControlNode() const { return nullptr; }
+        virtual void SetControlNode(Node* node) {}
+
+        // Terminals of multi-port components (e.g. a reduced interconnect model),
+        // which leave node1/node2 unused and are connected through
+        // CircuitBuilder::AddComponent(component, ports)
+        virtual size_t GetPortCount() const { return 0; }
+        virtual Node* GetPort(size_t index) const { return nullptr; }
+        virtual void SetPort(size_t index, Node* node) {}
+
         virtual void Stamp(SimulationState &state) = 0;
+
+        // Dynamic state (integration history, last current, device linearization)
+        // as GetStateSize() plain values, for checkpoints. Values and connections
+        // are not part of it.
+        virtual size_t GetStateSize() const { return 0; }
+        virtual void SaveState(double* values) const {}
+        virtual void RestoreState(const double* values) {}
+
+        // Copy of the component (values and state) for cloning circuits. The copy
+        // still points at the original nodes until it is connected again.
+        // Returns nullptr for components that can't be copied.
+        virtual Component* Clone() const { return nullptr; }
     };
 }
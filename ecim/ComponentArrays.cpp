@@ -0,0 +1,42 @@
+#include "ComponentArrays.hpp"
+
+namespace ecim {
+    void TwoTerminalArrays::StampConductances(SimulationState& state) const {
+        const size_t count = Size();
+        if (state.triplets) {
+            // Entries in the same order as the per-component stamps, so the compressed
+            // pattern (and any shared ordering) doesn't change
+            auto& triplets = *state.triplets;
+            for (size_t k = 0; k < count; k++) {
+                const int i = row1[k], j = row2[k];
+                const double g = conductance[k];
+                if (i >= 0) triplets.emplace_back(i, i, g);
+                if (j >= 0) triplets.emplace_back(j, j, g);
+                if (i >= 0 && j >= 0) {
+                    triplets.emplace_back(i, j, -g);
+                    triplets.emplace_back(j, i, -g);
+                }
+            }
+        } else if (state.G) {
+            Eigen::MatrixXd& G = *state.G;
+            for (size_t k = 0; k < count; k++) {
+                const int i = row1[k], j = row2[k];
+                const double g = conductance[k];
+                if (i >= 0) G(i, i) += g;
+                if (j >= 0) G(j, j) += g;
+                if (i >= 0 && j >= 0) {
+                    G(i, j) -= g;
+                    G(j, i) -= g;
+                }
+            }
+        }
+    }
+
+    void TwoTerminalArrays::StampCurrents(Eigen::VectorXd& I) const {
+        const size_t count = Size();
+        for (size_t k = 0; k < count; k++) {
+            if (row1[k] >= 0) I(row1[k]) += current[k];
+            if (row2[k] >= 0) I(row2[k]) -= current[k];
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include "Component.hpp"
+
+namespace ecim {
+    // Structure-of-arrays copy of one kind of two-terminal component in a compiled
+    // circuit: the matrix rows of the terminals (-1 = ground) side by side with the
+    // values of the step being assembled, so stamping is a loop over plain arrays
+    // instead of a virtual call and two node dereferences per component.
+    struct TwoTerminalArrays {
+        std::vector<int> row1, row2;
+        std::vector<double> conductance;   // Stamped between row1 and row2
+        std::vector<double> current;       // Injected into row1, drawn from row2
+
+        // Rows in plan order; values are left for the caller to fill each step
+        template <class T>
+        void Assign(const std::vector<T*>& components) {
+            row1.clear();
+            row2.clear();
+            for (auto component : components) {
+                row1.push_back(component->GetNode1() ? component->GetNode1()->Index : -1);
+                row2.push_back(component->GetNode2() ? component->GetNode2()->Index : -1);
+            }
+            conductance.assign(row1.size(), 0.0);
+            current.assign(row1.size(), 0.0);
+        }
+
+        size_t Size() const { return row1.size(); }
+
+        // Voltage across entry k in a solution vector
+        double Voltage(const Eigen::VectorXd& x, size_t k) const {
+            return (row1[k] >= 0 ? x(row1[k]) : 0.0) - (row2[k] >= 0 ? x(row2[k]) : 0.0);
+        }
+
+        void StampConductances(SimulationState& state) const;
+        void StampCurrents(Eigen::VectorXd& I) const;
+    };
+}
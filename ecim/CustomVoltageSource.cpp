@@ -7,4 +7,8 @@ namespace ecim {
     double CustomVoltageSource::GetVoltage(double time) const {
         return m_VoltageFunction(time);
     }
+
+    void CustomVoltageSource::EvaluateBlock(double start, double step, int count, double* values) const {
+        for (int k = 0; k < count; k++) values[k] = m_VoltageFunction(start + k * step);
+    }
 }
@@ -14,5 +14,7 @@ namespace ecim {
         // Constructor takes a function that maps time -> voltage
         CustomVoltageSource(std::function<double(double)> voltageFunction);
         double GetVoltage(double time) const override;
+        void EvaluateBlock(double start, double step, int count, double* values) const override;
+        Component* Clone() const override { return new CustomVoltageSource(*this); }
     };
 }
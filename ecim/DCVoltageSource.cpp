@@ -1,4 +1,5 @@
 #include "DCVoltageSource.hpp"
+#include <algorithm>
 
 namespace ecim {
     DCVoltageSource::DCVoltageSource(double voltage) 
@@ -7,4 +8,8 @@ namespace ecim {
     double DCVoltageSource::GetVoltage(double /* time */) const {
         return m_Voltage;
     }
+
+    void DCVoltageSource::EvaluateBlock(double /* start */, double /* step */, int count, double* values) const {
+        std::fill(values, values + count, m_Voltage);
+    }
 }
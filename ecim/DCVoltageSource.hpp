@@ -11,5 +11,11 @@ namespace ecim {
     public:
         DCVoltageSource(double voltage);
         double GetVoltage(double time) const override;
+        void EvaluateBlock(double start, double step, int count, double* values) const override;
+        Component* Clone() const override { return new DCVoltageSource(*this); }
+
+        void SetVoltage(double voltage) { m_Voltage = voltage; }
     };
+
+    template <> struct ArenaSkipsDestructor<DCVoltageSource> : std::true_type {};
 }
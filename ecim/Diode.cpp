@@ -0,0 +1,75 @@
+#include "Diode.hpp"
+#include <cmath>
+
+namespace ecim {
+    namespace {
+        const double ThermalVoltage = 0.025852;     // kT/q at 300K
+        const double MinConductance = 1e-12;        // Keeps reverse-biased diodes from floating a node
+    }
+
+    Diode::Diode(double saturationCurrent, double emissionCoefficient)
+        : m_SaturationCurrent(saturationCurrent), m_EmissionCoefficient(emissionCoefficient) {}
+
+    bool Diode::Linearize() {
+        const double nVt = m_EmissionCoefficient * ThermalVoltage;
+        double vd = (m_Node1 ? m_Node1->Voltage : 0.0) - (m_Node2 ? m_Node2->Voltage : 0.0);
+
+        // Junction voltage limiting (as SPICE pnjlim): large forward steps would
+        // overflow the exponential, so they are taken logarithmically
+        const double vcrit = nVt * std::log(nVt / (std::sqrt(2.0) * m_SaturationCurrent));
+        const bool limited = vd > vcrit && std::abs(vd - m_Vd) > 2.0 * nVt;
+        if (limited) {
+            if (m_Vd > 0.0) {
+                double arg = 1.0 + (vd - m_Vd) / nVt;
+                vd = (arg > 0.0) ? m_Vd + nVt * std::log(arg) : vcrit;
+            } else {
+                vd = nVt * std::log(vd / nVt);
+            }
+        }
+        m_Vd = vd;
+
+        double e = std::exp(vd / nVt);
+        double id = m_SaturationCurrent * (e - 1.0);
+        m_Gd = m_SaturationCurrent * e / nVt + MinConductance;
+        m_Ieq = id - m_Gd * vd;
+        return limited;
+    }
+
+    // Linearized as a conductance Gd in parallel with a current source Ieq
+    void Diode::Stamp(SimulationState &state) {
+        int i = m_Node1 ? m_Node1->Index : -1;
+        int j = m_Node2 ? m_Node2->Index : -1;
+
+        if (i >= 0) state.StampG(i, i, m_Gd);
+        if (j >= 0) state.StampG(j, j, m_Gd);
+        if (i >= 0 && j >= 0) {
+            state.StampG(i, j, -m_Gd);
+            state.StampG(j, i, -m_Gd);
+        }
+
+        // Ieq flows from anode to cathode
+        if (i >= 0) state.I(i) -= m_Ieq;
+        if (j >= 0) state.I(j) += m_Ieq;
+    }
+
+    double Diode::GetCurrent() const {
+        double v = (m_Node1 ? m_Node1->Voltage : 0.0) - (m_Node2 ? m_Node2->Voltage : 0.0);
+        return m_Gd * v + m_Ieq;
+    }
+
+    void Diode::SaveState(double* values) const {
+        NonlinearComponent::SaveState(values);
+        const size_t base = NonlinearComponent::GetStateSize();
+        values[base] = m_Vd;
+        values[base + 1] = m_Gd;
+        values[base + 2] = m_Ieq;
+    }
+
+    void Diode::RestoreState(const double* values) {
+        NonlinearComponent::RestoreState(values);
+        const size_t base = NonlinearComponent::GetStateSize();
+        m_Vd = values[base];
+        m_Gd = values[base + 1];
+        m_Ieq = values[base + 2];
+    }
+}
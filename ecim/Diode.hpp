@@ -0,0 +1,34 @@
+#pragma once
+
+#include "NonlinearComponent.hpp"
+
+namespace ecim {
+    // Junction diode, anode at node1 and cathode at node2:
+    // I = Is * (exp(V / (n * Vt)) - 1)
+    class Diode : public NonlinearComponent {
+        double m_SaturationCurrent;     // Is (A)
+        double m_EmissionCoefficient;   // n
+
+        // Linearization: I = m_Gd * V + m_Ieq around junction voltage m_Vd
+        double m_Vd = 0.0;
+        double m_Gd = 0.0;
+        double m_Ieq = 0.0;
+
+    protected:
+        bool Linearize() override;
+
+    public:
+        Diode(double saturationCurrent = 1e-14, double emissionCoefficient = 1.0);
+        void Stamp(SimulationState &state) override;
+        Component* Clone() const override { return new Diode(*this); }
+        size_t GetStateSize() const override { return NonlinearComponent::GetStateSize() + 3; }
+        void SaveState(double* values) const override;
+        void RestoreState(const double* values) override;
+        double GetCurrent() const override;
+
+        double GetSaturationCurrent() const { return m_SaturationCurrent; }
+        double GetEmissionCoefficient() const { return m_EmissionCoefficient; }
+    };
+
+    template <> struct ArenaSkipsDestructor<Diode> : std::true_type {};
+}
@@ -0,0 +1,398 @@
+#include "EnsembleSimulator.hpp"
+#include "Resistor.hpp"
+#include "Capacitor.hpp"
+#include "Inductor.hpp"
+#include "VoltageSource.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace ecim {
+    namespace {
+        int RowOf(const Node* node) {
+            return node ? node->Index : -1;
+        }
+
+        void AddRows(std::vector<int>& rows, const Component* component) {
+            rows.push_back(RowOf(component->GetNode1()));
+            rows.push_back(RowOf(component->GetNode2()));
+        }
+    }
+
+    EnsembleSimulator::EnsembleSimulator(CircuitBuilder& circuit, int instances)
+        : m_Circuit(circuit), m_Instances(instances > 0 ? instances : 1) {
+        if (!m_Circuit.IsCompiled()) m_Circuit.Compile();
+        if (!m_Circuit.GetNonlinearComponents().empty()) {
+            m_Error = "Ensemble simulation doesn't support nonlinear devices";
+        } else if (!m_Circuit.GetReducedNetworks().empty()) {
+            m_Error = "Ensemble simulation doesn't support reduced networks";
+        }
+
+        m_Size = m_Circuit.GetMatrixSize();
+        m_NodeRows = m_Circuit.GetNodeRowCount();
+        const int K = m_Instances;
+
+        // Copy topology and nominal values; every instance starts at the nominal design
+        int index = 0;
+        for (auto resistor : m_Circuit.GetResistors()) {
+            AddRows(m_ResistorRows, resistor);
+            m_Resistance.insert(m_Resistance.end(), K, resistor->GetResistance());
+            m_ComponentIndex[resistor] = index++;
+        }
+        index = 0;
+        for (auto capacitor : m_Circuit.GetCapacitors()) {
+            AddRows(m_CapacitorRows, capacitor);
+            m_Capacitance.insert(m_Capacitance.end(), K, capacitor->GetCapacitance());
+            m_ComponentIndex[capacitor] = index++;
+        }
+        index = 0;
+        for (auto inductor : m_Circuit.GetInductors()) {
+            AddRows(m_InductorRows, inductor);
+            m_Inductance.insert(m_Inductance.end(), K, inductor->GetInductance());
+            m_ComponentIndex[inductor] = index++;
+        }
+        index = 0;
+        for (auto source : m_Circuit.GetVoltageSources()) {
+            AddRows(m_SourceRows, source);
+            m_Sources.push_back(source);
+            m_SourceGain.insert(m_SourceGain.end(), K, 1.0);
+            m_ComponentIndex[source] = index++;
+        }
+
+        m_CapacitorVoltage.assign(m_Capacitance.size(), 0.0);
+        m_InductorCurrent.assign(m_Inductance.size(), 0.0);
+        m_RHS.assign(static_cast<size_t>(m_Size) * K, 0.0);
+        m_X.assign(static_cast<size_t>(m_Size) * K, 0.0);
+    }
+
+    double* EnsembleSimulator::Values(std::vector<double>& values, const Component* component) {
+        auto it = m_ComponentIndex.find(component);
+        if (it == m_ComponentIndex.end()) return nullptr;
+        return values.data() + static_cast<size_t>(it->second) * m_Instances;
+    }
+
+    double* EnsembleSimulator::ResistanceValues(const Resistor* resistor) {
+        return Values(m_Resistance, resistor);
+    }
+
+    double* EnsembleSimulator::CapacitanceValues(const Capacitor* capacitor) {
+        return Values(m_Capacitance, capacitor);
+    }
+
+    double* EnsembleSimulator::InductanceValues(const Inductor* inductor) {
+        return Values(m_Inductance, inductor);
+    }
+
+    double* EnsembleSimulator::SourceGains(const VoltageSource* source) {
+        return Values(m_SourceGain, source);
+    }
+
+    int EnsembleSimulator::AddProbe(const Node* node) {
+        m_ProbeRows.push_back(RowOf(node));
+        return static_cast<int>(m_ProbeRows.size()) - 1;
+    }
+
+    void EnsembleSimulator::Reset() {
+        m_Time = 0.0;
+        std::fill(m_CapacitorVoltage.begin(), m_CapacitorVoltage.end(), 0.0);
+        std::fill(m_InductorCurrent.begin(), m_InductorCurrent.end(), 0.0);
+        std::fill(m_X.begin(), m_X.end(), 0.0);
+        m_Samples.clear();
+        m_Times.clear();
+    }
+
+    double EnsembleSimulator::GetSample(size_t sample, int probe, int instance) const {
+        size_t probes = m_ProbeRows.size();
+        return m_Samples[(sample * probes + probe) * m_Instances + instance];
+    }
+
+    int EnsembleSimulator::FindEntry(int row, int col) const {
+        if (row < 0 || col < 0) return -1;
+        const int r = m_RowPosition[row];
+        const int c = m_ColumnPosition[col];
+        auto first = m_Columns.begin() + m_RowStart[r];
+        auto last = m_Columns.begin() + m_RowStart[r + 1];
+        return static_cast<int>(std::lower_bound(first, last, c) - m_Columns.begin());
+    }
+
+    // Pivot order from a sparse LU of the instance-averaged matrix, then the fill of
+    // that order and the entries every stamp adds to
+    void EnsembleSimulator::Analyze(double deltaTime) {
+        const int n = m_Size;
+        const int K = m_Instances;
+
+        std::vector<Eigen::Triplet<double>> triplets;
+        auto mean = [K](const double* values, auto conductance) {
+            double sum = 0.0;
+            for (int k = 0; k < K; k++) sum += conductance(values[k]);
+            return sum / K;
+        };
+        auto stamp = [&](int i, int j, double g) {
+            if (i >= 0) triplets.emplace_back(i, i, g);
+            if (j >= 0) triplets.emplace_back(j, j, g);
+            if (i >= 0 && j >= 0) {
+                triplets.emplace_back(i, j, -g);
+                triplets.emplace_back(j, i, -g);
+            }
+        };
+        for (size_t c = 0; c < m_ResistorRows.size() / 2; c++) {
+            stamp(m_ResistorRows[2 * c], m_ResistorRows[2 * c + 1],
+                  mean(&m_Resistance[c * K], [](double R) { return 1.0 / R; }));
+        }
+        for (size_t c = 0; c < m_CapacitorRows.size() / 2; c++) {
+            stamp(m_CapacitorRows[2 * c], m_CapacitorRows[2 * c + 1],
+                  mean(&m_Capacitance[c * K], [deltaTime](double C) { return C / deltaTime; }));
+        }
+        for (size_t c = 0; c < m_InductorRows.size() / 2; c++) {
+            stamp(m_InductorRows[2 * c], m_InductorRows[2 * c + 1],
+                  mean(&m_Inductance[c * K], [deltaTime](double L) { return deltaTime / L; }));
+        }
+        for (size_t s = 0; s < m_Sources.size(); s++) {
+            int i = m_SourceRows[2 * s], j = m_SourceRows[2 * s + 1];
+            int row = m_NodeRows + static_cast<int>(s);
+            if (i >= 0) { triplets.emplace_back(i, row, 1.0); triplets.emplace_back(row, i, 1.0); }
+            if (j >= 0) { triplets.emplace_back(j, row, -1.0); triplets.emplace_back(row, j, -1.0); }
+        }
+        for (int r = 0; r < n; r++) triplets.emplace_back(r, r, 0.0);  // Keep the diagonal in the pattern
+
+        SparseMatrix A(n, n);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+
+        // P_r A P_c^-1 = L U: original row r becomes row P_r(r), column c becomes P_c(c)
+        Eigen::SparseLU<SparseMatrix, Eigen::COLAMDOrdering<int>> lu;
+        lu.analyzePattern(A);
+        lu.factorize(A);
+        const Eigen::VectorXi& columns = lu.colsPermutation().indices();
+        m_ColumnPosition.assign(columns.data(), columns.data() + n);
+        if (lu.info() == Eigen::Success) {
+            const Eigen::VectorXi& rows = lu.rowsPermutation().indices();
+            m_RowPosition.assign(rows.data(), rows.data() + n);
+        } else {
+            // Singular on average; keep the rows and let the numeric factorization show it
+            m_RowPosition.resize(n);
+            for (int r = 0; r < n; r++) m_RowPosition[r] = r;
+        }
+
+        std::vector<std::vector<int>> permuted(n);
+        for (int c = 0; c < n; c++) {
+            for (SparseMatrix::InnerIterator it(A, c); it; ++it) {
+                permuted[m_RowPosition[it.row()]].push_back(m_ColumnPosition[c]);
+            }
+        }
+
+        // Row i of L + U is row i of the permuted matrix plus the upper part of every
+        // row k it eliminates with, taken in increasing k since each adds more fill
+        m_RowStart.assign(1, 0);
+        m_Columns.clear();
+        m_Diagonal.assign(n, 0);
+        std::vector<int> marker(n, -1);
+        std::vector<int> row;
+        std::priority_queue<int, std::vector<int>, std::greater<int>> pending;
+        for (int i = 0; i < n; i++) {
+            row.clear();
+            auto add = [&](int col) {
+                if (marker[col] == i) return;
+                marker[col] = i;
+                row.push_back(col);
+                if (col < i) pending.push(col);
+            };
+            for (int col : permuted[i]) add(col);
+            while (!pending.empty()) {
+                const int k = pending.top();
+                pending.pop();
+                for (int e = m_Diagonal[k] + 1; e < m_RowStart[k + 1]; e++) add(m_Columns[e]);
+            }
+            std::sort(row.begin(), row.end());
+            m_Diagonal[i] = m_RowStart[i] + static_cast<int>(std::lower_bound(row.begin(), row.end(), i) - row.begin());
+            m_Columns.insert(m_Columns.end(), row.begin(), row.end());
+            m_RowStart.push_back(static_cast<int>(m_Columns.size()));
+        }
+        m_Scatter.assign(n, 0);
+
+        auto twoTerminal = [&](std::vector<int>& entries, const std::vector<int>& rows) {
+            entries.clear();
+            for (size_t c = 0; c < rows.size() / 2; c++) {
+                int i = rows[2 * c], j = rows[2 * c + 1];
+                entries.insert(entries.end(), {FindEntry(i, i), FindEntry(j, j), FindEntry(i, j), FindEntry(j, i)});
+            }
+        };
+        twoTerminal(m_ResistorEntries, m_ResistorRows);
+        twoTerminal(m_CapacitorEntries, m_CapacitorRows);
+        twoTerminal(m_InductorEntries, m_InductorRows);
+        m_SourceEntries.clear();
+        for (size_t s = 0; s < m_Sources.size(); s++) {
+            int i = m_SourceRows[2 * s], j = m_SourceRows[2 * s + 1];
+            int row = m_NodeRows + static_cast<int>(s);
+            m_SourceEntries.insert(m_SourceEntries.end(), {FindEntry(i, row), FindEntry(row, i), FindEntry(j, row), FindEntry(row, j)});
+        }
+
+        m_LU.assign(m_Columns.size() * K, 0.0);
+        m_InversePivot.assign(static_cast<size_t>(n) * K, 0.0);
+        m_Y.assign(static_cast<size_t>(n) * K, 0.0);
+        m_Analyzed = true;
+    }
+
+    // Assemble the batched backward Euler matrix into the L + U pattern and factor
+    // every instance at once
+    void EnsembleSimulator::Factorize(double deltaTime) {
+        if (!m_Analyzed) Analyze(deltaTime);
+
+        const int n = m_Size;
+        const int K = m_Instances;
+        auto lu = [&](int entry) { return &m_LU[static_cast<size_t>(entry) * K]; };
+        std::fill(m_LU.begin(), m_LU.end(), 0.0);
+
+        // Two-terminal conductance stamp with per-instance values
+        std::vector<double> g(K);
+        auto stamp = [&](const int* entries) {
+            for (int e = 0; e < 4; e++) {
+                if (entries[e] < 0) continue;
+                double* a = lu(entries[e]);
+                if (e < 2) { for (int k = 0; k < K; k++) a[k] += g[k]; }
+                else { for (int k = 0; k < K; k++) a[k] -= g[k]; }
+            }
+        };
+
+        for (size_t c = 0; c < m_ResistorRows.size() / 2; c++) {
+            const double* R = &m_Resistance[c * K];
+            for (int k = 0; k < K; k++) g[k] = 1.0 / R[k];
+            stamp(&m_ResistorEntries[4 * c]);
+        }
+        for (size_t c = 0; c < m_CapacitorRows.size() / 2; c++) {
+            const double* C = &m_Capacitance[c * K];
+            for (int k = 0; k < K; k++) g[k] = C[k] / deltaTime;
+            stamp(&m_CapacitorEntries[4 * c]);
+        }
+        for (size_t c = 0; c < m_InductorRows.size() / 2; c++) {
+            const double* L = &m_Inductance[c * K];
+            for (int k = 0; k < K; k++) g[k] = deltaTime / L[k];
+            stamp(&m_InductorEntries[4 * c]);
+        }
+        for (size_t s = 0; s < m_Sources.size(); s++) {
+            const double signs[4] = {1.0, 1.0, -1.0, -1.0};
+            for (int e = 0; e < 4; e++) {
+                const int entry = m_SourceEntries[4 * s + e];
+                if (entry < 0) continue;
+                double* a = lu(entry);
+                for (int k = 0; k < K; k++) a[k] += signs[e];
+            }
+        }
+
+        // Numeric LU row by row without pivoting, instances innermost
+        for (int i = 0; i < n; i++) {
+            for (int e = m_RowStart[i]; e < m_RowStart[i + 1]; e++) m_Scatter[m_Columns[e]] = e;
+            for (int e = m_RowStart[i]; e < m_Diagonal[i]; e++) {
+                const int p = m_Columns[e];
+                double* l = lu(e);
+                const double* inverse = &m_InversePivot[static_cast<size_t>(p) * K];
+                for (int k = 0; k < K; k++) l[k] *= inverse[k];
+                for (int q = m_Diagonal[p] + 1; q < m_RowStart[p + 1]; q++) {
+                    double* a = lu(m_Scatter[m_Columns[q]]);
+                    const double* u = lu(q);
+                    for (int k = 0; k < K; k++) a[k] -= l[k] * u[k];
+                }
+            }
+            const double* pivot = lu(m_Diagonal[i]);
+            double* inverse = &m_InversePivot[static_cast<size_t>(i) * K];
+            for (int k = 0; k < K; k++) inverse[k] = 1.0 / pivot[k];
+        }
+
+        m_FactorDt = deltaTime;
+        m_FactorValid = true;
+    }
+
+    void EnsembleSimulator::Step(double deltaTime) {
+        if (!m_FactorValid || deltaTime != m_FactorDt) Factorize(deltaTime);
+
+        m_Time += deltaTime;
+        const int n = m_Size;
+        const int K = m_Instances;
+        auto rhs = [&](int row) { return &m_RHS[static_cast<size_t>(row) * K]; };
+        auto x = [&](int row) { return &m_X[static_cast<size_t>(row) * K]; };
+        auto lu = [&](int entry) { return &m_LU[static_cast<size_t>(entry) * K]; };
+
+        // Right-hand side: companion history sources and scaled source waveforms
+        std::fill(m_RHS.begin(), m_RHS.end(), 0.0);
+        for (size_t c = 0; c < m_CapacitorRows.size() / 2; c++) {
+            int i = m_CapacitorRows[2 * c], j = m_CapacitorRows[2 * c + 1];
+            const double* C = &m_Capacitance[c * K];
+            const double* v = &m_CapacitorVoltage[c * K];
+            if (i >= 0) { double* b = rhs(i); for (int k = 0; k < K; k++) b[k] += C[k] / deltaTime * v[k]; }
+            if (j >= 0) { double* b = rhs(j); for (int k = 0; k < K; k++) b[k] -= C[k] / deltaTime * v[k]; }
+        }
+        for (size_t c = 0; c < m_InductorRows.size() / 2; c++) {
+            int i = m_InductorRows[2 * c], j = m_InductorRows[2 * c + 1];
+            const double* current = &m_InductorCurrent[c * K];
+            if (i >= 0) { double* b = rhs(i); for (int k = 0; k < K; k++) b[k] -= current[k]; }
+            if (j >= 0) { double* b = rhs(j); for (int k = 0; k < K; k++) b[k] += current[k]; }
+        }
+        for (size_t s = 0; s < m_Sources.size(); s++) {
+            double voltage = m_Sources[s]->GetVoltage(m_Time);
+            const double* gain = &m_SourceGain[s * K];
+            double* b = rhs(m_NodeRows + static_cast<int>(s));
+            for (int k = 0; k < K; k++) b[k] += gain[k] * voltage;
+        }
+
+        // Permute rows, substitute row by row, then undo the column permutation
+        auto y = [&](int row) { return &m_Y[static_cast<size_t>(row) * K]; };
+        for (int r = 0; r < n; r++) std::copy(rhs(r), rhs(r) + K, y(m_RowPosition[r]));
+        for (int i = 0; i < n; i++) {
+            double* yi = y(i);
+            for (int e = m_RowStart[i]; e < m_Diagonal[i]; e++) {
+                const double* l = lu(e);
+                const double* yc = y(m_Columns[e]);
+                for (int k = 0; k < K; k++) yi[k] -= l[k] * yc[k];
+            }
+        }
+        for (int i = n - 1; i >= 0; i--) {
+            double* yi = y(i);
+            for (int e = m_Diagonal[i] + 1; e < m_RowStart[i + 1]; e++) {
+                const double* u = lu(e);
+                const double* yc = y(m_Columns[e]);
+                for (int k = 0; k < K; k++) yi[k] -= u[k] * yc[k];
+            }
+            const double* inverse = &m_InversePivot[static_cast<size_t>(i) * K];
+            for (int k = 0; k < K; k++) yi[k] *= inverse[k];
+        }
+        for (int c = 0; c < n; c++) std::copy(y(m_ColumnPosition[c]), y(m_ColumnPosition[c]) + K, x(c));
+
+        // Reactive state for the next step
+        auto branchVoltage = [&](int i, int j, int k) {
+            return (i >= 0 ? x(i)[k] : 0.0) - (j >= 0 ? x(j)[k] : 0.0);
+        };
+        for (size_t c = 0; c < m_CapacitorRows.size() / 2; c++) {
+            int i = m_CapacitorRows[2 * c], j = m_CapacitorRows[2 * c + 1];
+            double* v = &m_CapacitorVoltage[c * K];
+            for (int k = 0; k < K; k++) v[k] = branchVoltage(i, j, k);
+        }
+        for (size_t c = 0; c < m_InductorRows.size() / 2; c++) {
+            int i = m_InductorRows[2 * c], j = m_InductorRows[2 * c + 1];
+            const double* L = &m_Inductance[c * K];
+            double* current = &m_InductorCurrent[c * K];
+            for (int k = 0; k < K; k++) current[k] += deltaTime / L[k] * branchVoltage(i, j, k);
+        }
+
+        // Record probes
+        m_Times.push_back(m_Time);
+        for (int row : m_ProbeRows) {
+            if (row >= 0) m_Samples.insert(m_Samples.end(), x(row), x(row) + K);
+            else m_Samples.insert(m_Samples.end(), K, 0.0);
+        }
+    }
+
+    bool EnsembleSimulator::Simulate(double duration, double deltaTime) {
+        if (!m_Error.empty()) return false;
+        m_FactorValid = false;  // Values may have been edited since the last run, so
+        m_Analyzed = false;     // the pivot order is chosen again
+
+        double endTime = m_Time + duration;
+        const double epsilon = deltaTime * 0.01; // Small tolerance for floating point comparison
+        size_t steps = static_cast<size_t>(duration / deltaTime + 1.0);
+        m_Times.reserve(m_Times.size() + steps);
+        m_Samples.reserve(m_Samples.size() + steps * m_ProbeRows.size() * m_Instances);
+        while (m_Time < endTime - epsilon) {
+            Step(deltaTime);
+        }
+        return true;
+    }
+}
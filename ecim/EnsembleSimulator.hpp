@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CircuitBuilder.hpp"
+
+namespace ecim {
+    // Ensemble (Monte Carlo) transient simulation of many instances of one topology.
+    //
+    // Every per-instance quantity is stored structure-of-arrays with the instance
+    // index innermost: the values of component c live in [c * instances, (c + 1) * instances).
+    // Matrix entries, right-hand sides and solutions follow the same layout, so
+    // assembly, LU factorization and substitution run as contiguous loops over
+    // instances that the compiler can vectorize.
+    //
+    // The LU factors are sparse: the row and column order come from a sparse LU
+    // (COLAMD, partial pivoting) of the instance-averaged matrix, done once per
+    // Simulate(). The fill of that order is computed symbolically and L and U are
+    // stored only at their structural nonzeros, so memory is nnz(L + U) * instances.
+    // Sharing the pivot order is safe as long as the instances are tolerance
+    // variations of one design. Reactive components use backward Euler, sources
+    // are scaled per instance.
+    //
+    // Only resistors, capacitors, inductors and voltage sources are supported.
+    // There is no Newton loop, so a circuit with diodes or MOSFETs is refused, and
+    // so is one with reduced networks (InterconnectNetwork::Reduce()), whose
+    // state-space models have no per-instance form. Refused circuits set
+    // GetError() and Simulate() does nothing; Expand() a network instead.
+    class EnsembleSimulator {
+        CircuitBuilder& m_Circuit;
+        int m_Instances;
+        std::string m_Error;        // Why the circuit can't be simulated
+        int m_Size = 0;             // MNA system size
+        int m_NodeRows = 0;         // First voltage source row
+
+        // Topology: two matrix rows (or -1 for ground) per component
+        std::vector<int> m_ResistorRows, m_CapacitorRows, m_InductorRows, m_SourceRows;
+        std::vector<VoltageSource*> m_Sources;
+        std::unordered_map<const Component*, int> m_ComponentIndex;
+
+        // Per-instance values and state, [component][instance]
+        std::vector<double> m_Resistance, m_Capacitance, m_Inductance, m_SourceGain;
+        std::vector<double> m_CapacitorVoltage, m_InductorCurrent;
+
+        // Symbolic factorization of the permuted matrix, L and U of a row side by side (CSR)
+        std::vector<int> m_RowPosition;         // Original row -> permuted row
+        std::vector<int> m_ColumnPosition;      // Original column -> permuted column
+        std::vector<int> m_RowStart;            // Entries of permuted row r: [m_RowStart[r], m_RowStart[r + 1])
+        std::vector<int> m_Columns;             // Sorted permuted columns of every entry
+        std::vector<int> m_Diagonal;            // Entry of U(r, r)
+        std::vector<int> m_Scatter;             // Work: column -> entry of the row being eliminated
+        bool m_Analyzed = false;
+
+        // Entries every stamp adds to (-1 for ground): 4 per component, ii jj ij ji
+        std::vector<int> m_ResistorEntries, m_CapacitorEntries, m_InductorEntries;
+        std::vector<int> m_SourceEntries;       // 4 per source: (i, row) (row, i) (j, row) (row, j)
+
+        // Batched values, [entry][instance] and [row][instance]
+        std::vector<double> m_LU;
+        std::vector<double> m_InversePivot;
+        double m_FactorDt = 0.0;
+        bool m_FactorValid = false;
+
+        // Work vectors, [row][instance]
+        std::vector<double> m_RHS, m_Y, m_X;
+
+        // Probes and recorded samples, [sample][probe][instance]
+        std::vector<int> m_ProbeRows;
+        std::vector<double> m_Samples;
+        std::vector<double> m_Times;
+        double m_Time = 0.0;
+
+        double* Values(std::vector<double>& values, const Component* component);
+        int FindEntry(int row, int col) const;
+        void Analyze(double deltaTime);
+        void Factorize(double deltaTime);
+        void Step(double deltaTime);
+
+    public:
+        // Compiles the circuit if needed and copies its nominal values into every instance.
+        // Check GetError() afterwards for circuits with unsupported components.
+        EnsembleSimulator(CircuitBuilder& circuit, int instances);
+
+        const std::string& GetError() const { return m_Error; }
+
+        int GetInstanceCount() const { return m_Instances; }
+
+        // Per-instance value arrays (GetInstanceCount() entries each), or nullptr if the
+        // component isn't part of the circuit. Edits take effect at the next Simulate().
+        double* ResistanceValues(const Resistor* resistor);
+        double* CapacitanceValues(const Capacitor* capacitor);
+        double* InductanceValues(const Inductor* inductor);
+        double* SourceGains(const VoltageSource* source);   // Multiplies the source waveform
+
+        // Record a node voltage every step, returns the probe index
+        int AddProbe(const Node* node);
+
+        // Advance all instances together with a fixed timestep. Returns false without
+        // stepping when the circuit was refused.
+        bool Simulate(double duration, double deltaTime);
+
+        // Zero the reactive state, clock and recorded samples
+        void Reset();
+
+        double GetCurrentTime() const { return m_Time; }
+        size_t GetSampleCount() const { return m_Times.size(); }
+        const std::vector<double>& GetTimes() const { return m_Times; }
+
+        // All recorded samples in one buffer, laid out [sample][probe][instance]
+        const std::vector<double>& GetSamples() const { return m_Samples; }
+        double GetSample(size_t sample, int probe, int instance) const;
+    };
+}
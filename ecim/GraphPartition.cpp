@@ -0,0 +1,43 @@
+#include "GraphPartition.hpp"
+
+namespace ecim {
+    std::vector<int> PartitionGraph(const std::vector<std::vector<int>>& adjacency, int count) {
+        const int n = static_cast<int>(adjacency.size());
+        if (count < 1) count = 1;
+
+        std::vector<int> order;
+        order.reserve(n);
+        std::vector<char> visited(n, 0);
+        auto search = [&](int start) {
+            size_t begin = order.size();
+            order.push_back(start);
+            visited[start] = 1;
+            for (size_t k = begin; k < order.size(); k++) {
+                for (int neighbor : adjacency[order[k]]) {
+                    if (!visited[neighbor]) {
+                        visited[neighbor] = 1;
+                        order.push_back(neighbor);
+                    }
+                }
+            }
+            return begin;
+        };
+
+        // The last vertex reached from any seed is far from it; searching again
+        // from there gives a deeper level structure with thinner levels
+        for (int seed = 0; seed < n; seed++) {
+            if (visited[seed]) continue;
+            size_t begin = search(seed);
+            int far = order.back();
+            for (size_t k = begin; k < order.size(); k++) visited[order[k]] = 0;
+            order.resize(begin);
+            search(far);
+        }
+
+        std::vector<int> part(n);
+        for (int k = 0; k < n; k++) {
+            part[order[k]] = static_cast<int>(static_cast<long long>(k) * count / n);
+        }
+        return part;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace ecim {
+    // Split an undirected graph (adjacency lists without self loops) into `count`
+    // parts of equal size. The parts are slices of a breadth-first level ordering
+    // started from a pseudo-peripheral vertex of every connected piece, so each
+    // part is a compact region and neighboring parts meet along thin level sets.
+    // Returns the part of every vertex, in [0, count).
+    std::vector<int> PartitionGraph(const std::vector<std::vector<int>>& adjacency, int count);
+}
@@ -2,46 +2,93 @@
 
 namespace ecim {
     Inductor::Inductor(double inductance) 
-        : m_Inductance(inductance), m_Current(0.0) {}
-
-    // For transient analysis using backward Euler method
-    // The inductor is modeled as: V = L * dI/dt
-    // Using backward Euler: V(t) = L * (I(t) - I(t-dt)) / dt
-    // Rearranging: I(t) = I(t-dt) + V(t) * dt / L
-    // This is equivalent to: V(t) = (L/dt) * I(t) - (L/dt) * I(t-dt)
-    // The inductor acts like a resistor (L/dt) with a voltage source -(L/dt)*I(t-dt)
+        : m_Inductance(inductance) {}
+
+    // For transient analysis the inductor is modeled as: V = L * dI/dt
+    // The integration method approximates dI/dt = alpha * I(t) - beta, e.g.
+    // backward Euler: dI/dt = (I(t) - I(t-dt)) / dt
+    // Solving for the current: I(t) = V(t) / (alpha*L) + beta/alpha
+    // The inductor acts like a conductance 1/(alpha*L) with a current source beta/alpha
     void Inductor::Stamp(SimulationState &state) {
         if (state.dt <= 0.0) return;
 
-        double Req = m_Inductance / state.dt;  // Equivalent resistance
-        double Veq = Req * m_Current;          // Equivalent voltage source
+        double Geq, Ieq;    // Equivalent conductance and current source
+        BeginStep(state.dt, state.method, Geq, Ieq);
 
-        int i = (m_Node1 && m_Node1->Id > 0) ? m_Node1->Id - 1 : -1;
-        int j = (m_Node2 && m_Node2->Id > 0) ? m_Node2->Id - 1 : -1;
+        int i = m_Node1 ? m_Node1->Index : -1;
+        int j = m_Node2 ? m_Node2->Index : -1;
 
-        // Add equivalent resistance (like resistor)
-        double G_val = 1.0 / Req;
-        if (i >= 0) state.G(i, i) += G_val;
-        if (j >= 0) state.G(j, j) += G_val;
+        // Add equivalent conductance (like resistor)
+        if (i >= 0) state.StampG(i, i, Geq);
+        if (j >= 0) state.StampG(j, j, Geq);
         if (i >= 0 && j >= 0) {
-            state.G(i, j) -= G_val;
-            state.G(j, i) -= G_val;
+            state.StampG(i, j, -Geq);
+            state.StampG(j, i, -Geq);
         }
 
-        // Add equivalent voltage source (like current source)
-        double Ieq = Veq / Req;  // Convert to current
-        if (i >= 0) state.I(i) -= Ieq;
-        if (j >= 0) state.I(j) += Ieq;
+        // History current flows from node1 to node2 (Ieq is its negative)
+        if (i >= 0) state.I(i) += Ieq;
+        if (j >= 0) state.I(j) -= Ieq;
     }
 
-    void Inductor::UpdateState() {
-        // Update current through inductor for next timestep
-        if (m_Node1 && m_Node2) {
-            m_Current = (m_Node1->Voltage - m_Node2->Voltage) / (m_Inductance / 1e-6);  // Approximate
+    void Inductor::BeginStep(double dt, IntegrationMethod method, double& conductance, double& current) {
+        m_Method = method;
+        m_StepDt = dt;
+        if (dt <= 0.0) {
+            conductance = current = 0.0;
+            return;
         }
+        double alpha, beta;
+        m_History.Companion(dt, method, alpha, beta);
+        m_Geq = 1.0 / (alpha * m_Inductance);   // Equivalent conductance
+        m_Ihist = beta / alpha;                 // History current
+        conductance = m_Geq;
+        current = -m_Ihist;
+    }
+
+    void Inductor::UpdateState() {
+        AcceptVoltage((m_Node1 ? m_Node1->Voltage : 0.0) - (m_Node2 ? m_Node2->Voltage : 0.0));
+    }
+
+    void Inductor::AcceptVoltage(double voltage) {
+        // Update current history for next timestep, exactly from the companion model
+        if (m_StepDt <= 0.0) return;
+
+        m_History.Accept(m_Geq * voltage + m_Ihist, m_StepDt, voltage / m_Inductance);
+    }
+
+    void Inductor::StampOperatingPoint(SimulationState &state) {
+        int i = m_Node1 ? m_Node1->Index : -1;
+        int j = m_Node2 ? m_Node2->Index : -1;
+
+        // Branch current leaves node1 and enters node2, V1 - V2 = 0
+        if (i >= 0) state.StampG(i, state.vsIndex, 1.0);
+        if (j >= 0) state.StampG(j, state.vsIndex, -1.0);
+        if (i >= 0) state.StampG(state.vsIndex, i, 1.0);
+        if (j >= 0) state.StampG(state.vsIndex, j, -1.0);
+    }
+
+    void Inductor::SetInitialCurrent(double current) {
+        m_History.Reset(current);
+    }
+
+    double Inductor::GetSolvedCurrent() const {
+        double voltage = (m_Node1 ? m_Node1->Voltage : 0.0) - (m_Node2 ? m_Node2->Voltage : 0.0);
+        return m_Geq * voltage + m_Ihist;
+    }
+
+    double Inductor::GetCompanionConductance(double dt, IntegrationMethod method) const {
+        double alpha, beta;
+        m_History.Companion(dt, method, alpha, beta);
+        return 1.0 / (alpha * m_Inductance);
+    }
+
+    double Inductor::EstimateError(double relTol, double absTol) const {
+        if (m_StepDt <= 0.0) return 0.0;
+        return m_History.EstimateError(GetSolvedCurrent(), m_StepDt, m_Method, relTol, absTol);
     }
 
     double Inductor::GetCurrent() const {
-        return m_Current;
+        return m_History.GetValue();
     }
 }
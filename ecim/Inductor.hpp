@@ -5,12 +5,49 @@
 namespace ecim {
     class Inductor : public Component {
         double m_Inductance = 0.0;
-        double m_Current = 0.0;  // Current through inductor at previous timestep
+        IntegrationHistory m_History;  // Current through inductor at previous timesteps
+
+        // Companion model of the step being solved: I = m_Geq * V + m_Ihist
+        IntegrationMethod m_Method = IntegrationMethod::BackwardEuler;
+        double m_StepDt = 0.0;
+        double m_Geq = 0.0, m_Ihist = 0.0;
+
+        double GetSolvedCurrent() const;
 
     public:
         Inductor(double inductance);
         void Stamp(SimulationState &state) override;
+        Component* Clone() const override { return new Inductor(*this); }
+        size_t GetStateSize() const override { return IntegrationHistory::StateSize; }
+        void SaveState(double* values) const override { m_History.Save(values); }
+        void RestoreState(const double* values) override { m_History.Restore(values); }
         void UpdateState();
+
+        // Companion model for a step of length dt: the conductance and the current it
+        // injects into node1 (minus the history current). Stamp() and CircuitBuilder's
+        // packed loops both use it.
+        void BeginStep(double dt, IntegrationMethod method, double& conductance, double& current);
+        // UpdateState() with the solved voltage across the inductor already known
+        void AcceptVoltage(double voltage);
         double GetCurrent() const;
+
+        // DC operating point: the inductor is a short, stamped as a 0V source
+        // whose branch current occupies row state.vsIndex
+        void StampOperatingPoint(SimulationState &state);
+
+        // Start the next transient from a steady-state current (zero voltage)
+        void SetInitialCurrent(double current);
+
+        double GetInductance() const { return m_Inductance; }
+        void SetInductance(double inductance) { m_Inductance = inductance; }
+
+        // Equivalent conductance of the companion model for a step of length dt
+        double GetCompanionConductance(double dt, IntegrationMethod method) const;
+
+        // Local truncation error of the step just solved (before UpdateState()),
+        // relative to relTol * |I| + absTol. Values above 1 mean the step is too long.
+        double EstimateError(double relTol, double absTol) const;
     };
+
+    template <> struct ArenaSkipsDestructor<Inductor> : std::true_type {};
 }
@@ -0,0 +1,98 @@
+#include "Integration.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ecim {
+    int IntegrationOrder(IntegrationMethod method) {
+        return method == IntegrationMethod::BackwardEuler ? 1 : 2;
+    }
+
+    void IntegrationHistory::Companion(double h, IntegrationMethod method, double& alpha, double& beta) const {
+        // Without history (BDF2 needs x_n-2, the trapezoidal rule a consistent x'_n-1)
+        // the first step is taken with backward Euler, as SPICE does at a restart
+        if (m_Steps == 0) method = IntegrationMethod::BackwardEuler;
+
+        switch (method) {
+            case IntegrationMethod::BackwardEuler:
+                // x'_n = (x_n - x_n-1) / h
+                alpha = 1.0 / h;
+                beta = m_Value / h;
+                break;
+
+            case IntegrationMethod::Trapezoidal:
+                // (x'_n + x'_n-1) / 2 = (x_n - x_n-1) / h
+                alpha = 2.0 / h;
+                beta = 2.0 * m_Value / h + m_Derivative;
+                break;
+
+            case IntegrationMethod::BDF2: {
+                // Variable-step BDF2 with r = h_n / h_n-1:
+                // h x'_n = (1+2r)/(1+r) x_n - (1+r) x_n-1 + r^2/(1+r) x_n-2
+                double r = h / m_Dt;
+                alpha = (1.0 + 2.0 * r) / ((1.0 + r) * h);
+                beta = ((1.0 + r) * m_Value - r * r / (1.0 + r) * m_PreviousValue) / h;
+                break;
+            }
+        }
+    }
+
+    void IntegrationHistory::Accept(double value, double h, double derivative) {
+        m_PreviousSlope = m_Slope;
+        m_Slope = (value - m_Value) / h;
+        m_PreviousValue = m_Value;
+        m_Value = value;
+        m_Derivative = derivative;
+        m_PreviousDt = m_Dt;
+        m_Dt = h;
+        m_Steps++;
+    }
+
+    void IntegrationHistory::Reset(double value, double derivative) {
+        *this = IntegrationHistory();
+        m_Value = value;
+        m_Derivative = derivative;
+    }
+
+    void IntegrationHistory::Save(double* values) const {
+        values[0] = m_Value;
+        values[1] = m_PreviousValue;
+        values[2] = m_Derivative;
+        values[3] = m_Slope;
+        values[4] = m_PreviousSlope;
+        values[5] = m_Dt;
+        values[6] = m_PreviousDt;
+        values[7] = m_Steps;
+    }
+
+    void IntegrationHistory::Restore(const double* values) {
+        m_Value = values[0];
+        m_PreviousValue = values[1];
+        m_Derivative = values[2];
+        m_Slope = values[3];
+        m_PreviousSlope = values[4];
+        m_Dt = values[5];
+        m_PreviousDt = values[6];
+        m_Steps = static_cast<int>(values[7]);
+    }
+
+    // The error terms are h^2/2 x'' (backward Euler), h^3/12 x''' (trapezoidal)
+    // and 2/9 h^3 x''' (BDF2). The derivatives are estimated from divided
+    // differences of the secant slopes over the new step and the accepted history.
+    double IntegrationHistory::EstimateError(double value, double h, IntegrationMethod method, double relTol, double absTol) const {
+        if (m_Steps < IntegrationOrder(method)) return 0.0;
+
+        double slope = (value - m_Value) / h;
+        double second = (slope - m_Slope) / (0.5 * (h + m_Dt));   // x'' between the last two step midpoints
+
+        double error;
+        if (method == IntegrationMethod::BackwardEuler) {
+            error = 0.5 * h * h * std::abs(second);
+        } else {
+            double previousSecond = (m_Slope - m_PreviousSlope) / (0.5 * (m_Dt + m_PreviousDt));
+            double third = (second - previousSecond) / (0.25 * (h + 2.0 * m_Dt + m_PreviousDt));
+            double constant = (method == IntegrationMethod::Trapezoidal) ? 1.0 / 12.0 : 2.0 / 9.0;
+            error = constant * h * h * h * std::abs(third);
+        }
+        return error / (relTol * std::max(std::abs(value), std::abs(m_Value)) + absTol);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace ecim {
+    // Integration formula used for the companion models of reactive components
+    enum class IntegrationMethod {
+        BackwardEuler,  // First order, L-stable, strongly damps fast transients
+        Trapezoidal,    // Second order, A-stable, can ring on discontinuities
+        BDF2            // Second order Gear, L-stable, variable-step
+    };
+    // Both second-order methods take their first step (no history yet) with backward Euler.
+
+    // Order of accuracy of a method (the local error scales as h^(order+1))
+    int IntegrationOrder(IntegrationMethod method);
+
+    // History of one integrated state variable x (a capacitor voltage or an
+    // inductor current) over the last accepted steps. The integration formula
+    // is written as x'(t+h) = alpha * x(t+h) - beta, from which each component
+    // derives its companion conductance and history source.
+    class IntegrationHistory {
+        double m_Value = 0.0;           // x at the last accepted step
+        double m_PreviousValue = 0.0;   // x one step earlier
+        double m_Derivative = 0.0;      // x' at the last accepted step
+        double m_Slope = 0.0;           // (x_n - x_n-1) / h over the last step
+        double m_PreviousSlope = 0.0;   // Same over the step before
+        double m_Dt = 0.0;              // Length of the last accepted step
+        double m_PreviousDt = 0.0;      // Length of the step before
+        int m_Steps = 0;                // Accepted steps since the last Reset()
+
+    public:
+        // Coefficients of x'(t+h) = alpha * x(t+h) - beta for a step of length h
+        void Companion(double h, IntegrationMethod method, double& alpha, double& beta) const;
+
+        // Record the solution of an accepted step of length h
+        void Accept(double value, double h, double derivative);
+
+        // Start over from a known state (e.g. an operating point), x' = derivative
+        void Reset(double value, double derivative = 0.0);
+
+        // Local truncation error of a step of length h that ended at `value`,
+        // relative to relTol * |x| + absTol. Returns 0 until enough history exists.
+        double EstimateError(double value, double h, IntegrationMethod method, double relTol, double absTol) const;
+
+        // The whole history as StateSize plain values, for checkpoints
+        static const int StateSize = 8;
+        void Save(double* values) const;
+        void Restore(const double* values);
+
+        double GetValue() const { return m_Value; }
+        double GetDerivative() const { return m_Derivative; }
+        int GetSteps() const { return m_Steps; }
+    };
+}
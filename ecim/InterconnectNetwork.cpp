@@ -0,0 +1,201 @@
+#include "InterconnectNetwork.hpp"
+#include "ACAnalysis.hpp"
+#include "CircuitBuilder.hpp"
+#include "Capacitor.hpp"
+#include "Inductor.hpp"
+#include "Parallel.hpp"
+#include "Resistor.hpp"
+#include <algorithm>
+#include <complex>
+
+namespace ecim {
+    namespace {
+        typedef std::complex<double> Complex;
+        typedef Eigen::SparseMatrix<Complex> ComplexMatrix;
+
+        // Y = K_pp - K_pi K_ii^-1 K_ip of a dense K with the port rows first
+        Eigen::MatrixXcd PortAdmittance(const Eigen::MatrixXcd& K, int ports) {
+            const int states = static_cast<int>(K.rows()) - ports;
+            Eigen::MatrixXcd Y = K.topLeftCorner(ports, ports);
+            if (states > 0) {
+                Eigen::PartialPivLU<Eigen::MatrixXcd> lu(K.bottomRightCorner(states, states));
+                Y -= K.topRightCorner(ports, states) * lu.solve(K.bottomLeftCorner(states, ports));
+            }
+            return Y;
+        }
+
+        double RelativeError(const Eigen::MatrixXcd& reduced, const Eigen::MatrixXcd& full) {
+            double scale = full.norm();
+            double error = (reduced - full).norm();
+            return scale > 0.0 ? error / scale : error;
+        }
+    }
+
+    InterconnectNetwork::InterconnectNetwork(int ports) : m_PortCount(ports) {}
+
+    int InterconnectNetwork::AddNode() {
+        return m_PortCount + m_InternalCount++;
+    }
+
+    void InterconnectNetwork::AddResistor(int node1, int node2, double resistance) {
+        m_Resistors.push_back({node1, node2, resistance});
+    }
+
+    void InterconnectNetwork::AddCapacitor(int node1, int node2, double capacitance) {
+        m_Capacitors.push_back({node1, node2, capacitance});
+    }
+
+    void InterconnectNetwork::AddInductor(int node1, int node2, double inductance) {
+        m_Inductors.push_back({node1, node2, inductance});
+    }
+
+    void InterconnectNetwork::BuildMatrices(SparseMatrix& G, SparseMatrix& C) const {
+        const int nodes = m_PortCount + m_InternalCount;
+        const int size = nodes + static_cast<int>(m_Inductors.size());
+        std::vector<Eigen::Triplet<double>> g, c;
+
+        auto stamp = [](std::vector<Eigen::Triplet<double>>& triplets, int i, int j, double value) {
+            if (i >= 0) triplets.emplace_back(i, i, value);
+            if (j >= 0) triplets.emplace_back(j, j, value);
+            if (i >= 0 && j >= 0) {
+                triplets.emplace_back(i, j, -value);
+                triplets.emplace_back(j, i, -value);
+            }
+        };
+        for (const auto& r : m_Resistors) stamp(g, r.node1, r.node2, 1.0 / r.value);
+        for (const auto& cap : m_Capacitors) stamp(c, cap.node1, cap.node2, cap.value);
+
+        // Inductor current rows: node rows get +-i, the branch row -v1 + v2 + L di/dt = 0,
+        // which keeps G + G^T positive semidefinite
+        for (size_t k = 0; k < m_Inductors.size(); k++) {
+            const Element& l = m_Inductors[k];
+            int row = nodes + static_cast<int>(k);
+            if (l.node1 >= 0) { g.emplace_back(l.node1, row, 1.0); g.emplace_back(row, l.node1, -1.0); }
+            if (l.node2 >= 0) { g.emplace_back(l.node2, row, -1.0); g.emplace_back(row, l.node2, 1.0); }
+            c.emplace_back(row, row, l.value);
+        }
+
+        G.resize(size, size);
+        G.setFromTriplets(g.begin(), g.end());
+        C.resize(size, size);
+        C.setFromTriplets(c.begin(), c.end());
+    }
+
+    ReducedNetwork* InterconnectNetwork::Reduce(const ReductionSettings& settings, ReductionReport* report) const {
+        SparseMatrix G, C;
+        BuildMatrices(G, C);
+        const int p = m_PortCount;
+        const int n = static_cast<int>(G.rows()) - p;
+
+        const SparseMatrix Gii = G.bottomRightCorner(n, n), Cii = C.bottomRightCorner(n, n);
+        const SparseMatrix Gip = G.bottomLeftCorner(n, p), Cip = C.bottomLeftCorner(n, p);
+        Eigen::SparseLU<SparseMatrix, Eigen::COLAMDOrdering<int>> lu;
+        if (n > 0) {
+            lu.compute(Gii);
+            if (lu.info() != Eigen::Success) return nullptr;
+        }
+
+        // Block Arnoldi: orthonormalize every new block against the basis (twice, for
+        // stability) and drop the directions it already spans
+        const int limit = settings.maxOrder > 0 ? std::min(settings.maxOrder, n) : n;
+        std::vector<Eigen::VectorXd> basis;
+        auto append = [&](Eigen::VectorXd w) {
+            const double norm = w.norm();
+            if (norm == 0.0) return false;
+            for (int pass = 0; pass < 2; pass++) {
+                for (const auto& v : basis) w -= v.dot(w) * v;
+            }
+            const double remaining = w.norm();
+            if (remaining <= settings.deflationTolerance * norm) return false;
+            basis.push_back(w / remaining);
+            return true;
+        };
+
+        Eigen::MatrixXd block;
+        if (n > 0) {
+            Eigen::MatrixXd start(n, 2 * p);
+            start << Eigen::MatrixXd(Gip), Eigen::MatrixXd(Cip);
+            block = lu.solve(start);
+        }
+        for (int moment = 0; moment < settings.moments && n > 0; moment++) {
+            size_t first = basis.size();
+            for (int col = 0; col < block.cols() && static_cast<int>(basis.size()) < limit; col++) {
+                append(block.col(col));
+            }
+            const int added = static_cast<int>(basis.size() - first);
+            if (added == 0 || static_cast<int>(basis.size()) >= limit) break;
+
+            Eigen::MatrixXd accepted(n, added);
+            for (int k = 0; k < added; k++) accepted.col(k) = basis[first + k];
+            block = lu.solve(Cii * accepted);
+        }
+
+        const int q = static_cast<int>(basis.size());
+        Eigen::MatrixXd V(n, q);
+        for (int k = 0; k < q; k++) V.col(k) = basis[k];
+
+        // W^T M W with W = diag(I, V)
+        auto project = [&](const SparseMatrix& M) {
+            Eigen::MatrixXd reduced(p + q, p + q);
+            reduced.topLeftCorner(p, p) = Eigen::MatrixXd(M.topLeftCorner(p, p));
+            if (q > 0) {
+                const SparseMatrix Mpi = M.topRightCorner(p, n), Mip = M.bottomLeftCorner(n, p);
+                const SparseMatrix Mii = M.bottomRightCorner(n, n);
+                reduced.topRightCorner(p, q) = Mpi * V;
+                reduced.bottomLeftCorner(q, p) = V.transpose() * Mip;
+                reduced.bottomRightCorner(q, q) = V.transpose() * (Mii * V);
+            }
+            return reduced;
+        };
+        const Eigen::MatrixXd Gr = project(G), Cr = project(C);
+
+        if (report) {
+            report->ports = p;
+            report->fullOrder = n;
+            report->reducedOrder = q;
+            report->frequencies = ACAnalysis::LogSpace(settings.checkStart, settings.checkStop, settings.checkPoints);
+            report->errors.assign(report->frequencies.size(), 0.0);
+
+            // Full admittance through a sparse solve of the internal block at each frequency
+            const Eigen::MatrixXd Gpp = Eigen::MatrixXd(G.topLeftCorner(p, p)), Cpp = Eigen::MatrixXd(C.topLeftCorner(p, p));
+            const SparseMatrix Gpi = G.topRightCorner(p, n), Cpi = C.topRightCorner(p, n);
+            auto fullAdmittance = [&](double omega) {
+                const Complex s(0.0, omega);
+                Eigen::MatrixXcd Y = Gpp.cast<Complex>() + s * Cpp.cast<Complex>();
+                if (n == 0) return Y;
+                ComplexMatrix Kii = Gii.cast<Complex>() + s * Cii.cast<Complex>();
+                ComplexMatrix Kpi = Gpi.cast<Complex>() + s * Cpi.cast<Complex>();
+                Eigen::MatrixXcd Kip = Eigen::MatrixXd(Gip).cast<Complex>() + s * Eigen::MatrixXd(Cip).cast<Complex>();
+                Eigen::SparseLU<ComplexMatrix, Eigen::COLAMDOrdering<int>> complexLU(Kii);
+                Eigen::MatrixXcd solved = complexLU.solve(Kip);
+                Y -= Kpi * solved;
+                return Y;
+            };
+            auto reducedAdmittance = [&](double omega) {
+                Eigen::MatrixXcd K = Gr.cast<Complex>() + Complex(0.0, omega) * Cr.cast<Complex>();
+                return PortAdmittance(K, p);
+            };
+
+            ParallelFor(report->frequencies.size(), 0, [&](size_t point, int) {
+                const double omega = 2.0 * 3.14159265358979323846 * report->frequencies[point];
+                report->errors[point] = RelativeError(reducedAdmittance(omega), fullAdmittance(omega));
+            });
+            report->maxError = 0.0;
+            for (double error : report->errors) report->maxError = std::max(report->maxError, error);
+            report->dcError = RelativeError(reducedAdmittance(0.0), fullAdmittance(0.0));
+        }
+
+        return new ReducedNetwork(p, Gr, Cr);
+    }
+
+    void InterconnectNetwork::Expand(CircuitBuilder& circuit, const std::vector<Node*>& ports, Node* ground) const {
+        // Internal nodes are numbered by the circuit and live in its arena
+        std::vector<Node*> nodes(ports);
+        for (int k = 0; k < m_InternalCount; k++) nodes.push_back(circuit.CreateNode());
+        auto terminal = [&](int index) { return index < 0 ? ground : nodes[index]; };
+
+        for (const auto& r : m_Resistors) circuit.AddResistor(terminal(r.node1), terminal(r.node2), r.value);
+        for (const auto& c : m_Capacitors) circuit.AddCapacitor(terminal(c.node1), terminal(c.node2), c.value);
+        for (const auto& l : m_Inductors) circuit.AddInductor(terminal(l.node1), terminal(l.node2), l.value);
+    }
+}
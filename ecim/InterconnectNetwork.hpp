@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "LinearSolver.hpp"
+#include "ReducedNetwork.hpp"
+
+namespace ecim {
+    class CircuitBuilder;
+
+    struct ReductionSettings {
+        int moments = 4;                    // Block moments of the port admittance matched at s = 0
+        int maxOrder = 0;                   // Cap on the reduced state count, 0 = no cap
+        double deflationTolerance = 1e-10;  // Krylov vectors that shrink below this (relative) are dropped
+        double checkStart = 1e3;            // Frequencies (Hz) at which the reduced model is compared
+        double checkStop = 1e9;             // with the full one, log-spaced
+        int checkPoints = 13;
+    };
+
+    // Reduced order and accuracy of a reduction
+    struct ReductionReport {
+        int ports = 0;
+        int fullOrder = 0;                  // Internal nodes plus inductor currents
+        int reducedOrder = 0;               // States of the reduced model
+        std::vector<double> frequencies;    // Hz
+        std::vector<double> errors;         // ||Y_reduced - Y_full|| / ||Y_full|| of the port admittance
+        double maxError = 0.0;              // Largest of errors
+        double dcError = 0.0;               // Same at DC
+    };
+
+    // Linear RLC network between a few ports, e.g. imported interconnect parasitics.
+    // Terminals are numbered -1 for ground, 0..ports-1 for the ports and upwards
+    // from there for internal nodes created with AddNode().
+    //
+    // Reduce() builds a PRIMA-style model: the internal unknowns are projected
+    // onto an orthonormal block Krylov basis V of G_ii^-1 C_ii started from
+    // G_ii^-1 [G_ip C_ip], while the ports are kept as they are. The reduced
+    // matrices are the congruence W^T G W and W^T C W with W = diag(I, V), so a
+    // passive network yields a passive model that matches the first moments of
+    // the port admittance.
+    class InterconnectNetwork {
+        struct Element {
+            int node1, node2;
+            double value;
+        };
+
+        int m_PortCount;
+        int m_InternalCount = 0;
+        std::vector<Element> m_Resistors, m_Capacitors, m_Inductors;
+
+        // G and C of the full network, ports first, then internal nodes, then inductor currents
+        void BuildMatrices(SparseMatrix& G, SparseMatrix& C) const;
+
+    public:
+        InterconnectNetwork(int ports);
+
+        // Create an internal node, returns its terminal number
+        int AddNode();
+        void AddResistor(int node1, int node2, double resistance);
+        void AddCapacitor(int node1, int node2, double capacitance);
+        void AddInductor(int node1, int node2, double inductance);
+
+        int GetPortCount() const { return m_PortCount; }
+        int GetInternalNodeCount() const { return m_InternalCount; }
+        int GetFullOrder() const { return m_InternalCount + static_cast<int>(m_Inductors.size()); }
+
+        // Reduced model, or nullptr if an internal node has no DC path to a port or
+        // ground (G_ii singular). The report, if given, receives order and accuracy.
+        ReducedNetwork* Reduce(const ReductionSettings& settings = ReductionSettings(),
+                               ReductionReport* report = nullptr) const;
+
+        // Add the network to a circuit element by element (the unreduced reference)
+        void Expand(CircuitBuilder& circuit, const std::vector<Node*>& ports, Node* ground) const;
+    };
+}
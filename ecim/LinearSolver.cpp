@@ -0,0 +1,274 @@
+#include "LinearSolver.hpp"
+#include "PartitionedSolver.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace ecim {
+    namespace {
+        typedef std::chrono::steady_clock Clock;
+
+        double SecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+    }
+
+    // LinearSolver
+
+    bool LinearSolver::DoFactorize(const Eigen::MatrixXd& A) {
+        m_SparseCopy = A.sparseView();
+        return DoFactorize(m_SparseCopy);
+    }
+
+    bool LinearSolver::DoFactorize(const SparseMatrix& A) {
+        m_DenseCopy = Eigen::MatrixXd(A);
+        return DoFactorize(m_DenseCopy);
+    }
+
+    bool LinearSolver::Factorize(const Eigen::MatrixXd& A) {
+        m_DenseMatrix = &A;
+        m_SparseMatrix = nullptr;
+        m_Stats.fallback = false;
+
+        auto start = Clock::now();
+        bool ok = DoFactorize(A);
+        m_Stats.factorSeconds = SecondsSince(start);
+        m_Stats.totalFactorSeconds += m_Stats.factorSeconds;
+        m_Stats.factorizations++;
+        if (!ok) m_Stats.failedFactorizations++;
+        return ok;
+    }
+
+    bool LinearSolver::Factorize(const SparseMatrix& A) {
+        m_DenseMatrix = nullptr;
+        m_SparseMatrix = &A;
+        m_Stats.fallback = false;
+
+        auto start = Clock::now();
+        bool ok = DoFactorize(A);
+        m_Stats.factorSeconds = SecondsSince(start);
+        m_Stats.totalFactorSeconds += m_Stats.factorSeconds;
+        m_Stats.factorizations++;
+        if (!ok) m_Stats.failedFactorizations++;
+        return ok;
+    }
+
+    void LinearSolver::Solve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        auto start = Clock::now();
+        DoSolve(b, x);
+        m_Stats.solveSeconds = SecondsSince(start);
+        m_Stats.totalSolveSeconds += m_Stats.solveSeconds;
+        m_Stats.solves++;
+
+        if (m_ComputeResidual) {
+            double error = 0.0;
+            if (m_DenseMatrix) error = (*m_DenseMatrix * x - b).norm();
+            else if (m_SparseMatrix) error = (*m_SparseMatrix * x - b).norm();
+            double scale = b.norm();
+            m_Stats.residual = scale > 0.0 ? error / scale : error;
+        }
+    }
+
+    // SparsityPattern
+
+    bool SparsityPattern::Update(const SparseMatrix& A) {
+        const int cols = static_cast<int>(A.cols());
+        const int nnz = static_cast<int>(A.nonZeros());
+        const int* outer = A.outerIndexPtr();
+        const int* inner = A.innerIndexPtr();
+
+        bool same = A.isCompressed() &&
+                    m_Outer.size() == static_cast<size_t>(cols + 1) &&
+                    m_Inner.size() == static_cast<size_t>(nnz) &&
+                    std::equal(m_Outer.begin(), m_Outer.end(), outer) &&
+                    std::equal(m_Inner.begin(), m_Inner.end(), inner);
+        if (same) return false;
+
+        if (A.isCompressed()) {
+            m_Outer.assign(outer, outer + cols + 1);
+            m_Inner.assign(inner, inner + nnz);
+        } else {
+            m_Outer.clear();  // Never matches, uncompressed input is always re-analyzed
+            m_Inner.clear();
+        }
+        return true;
+    }
+
+    void SparsityPattern::Clear() {
+        m_Outer.clear();
+        m_Inner.clear();
+    }
+
+    // DenseQRSolver
+
+    bool DenseQRSolver::DoFactorize(const Eigen::MatrixXd& A) {
+        m_QR.compute(A);
+        return true;  // Rank-revealing: singular systems get a least-squares solution
+    }
+
+    void DenseQRSolver::DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        x = m_QR.solve(b);
+    }
+
+    // DenseLUSolver
+
+    bool DenseLUSolver::DoFactorize(const Eigen::MatrixXd& A) {
+        m_LU.compute(A);
+        // rcond() is only an estimate and can miss an exactly zero pivot
+        if (A.rows() > 0 && m_LU.matrixLU().diagonal().cwiseAbs().minCoeff() == 0.0) return false;
+        return m_LU.rcond() > 0.0;
+    }
+
+    void DenseLUSolver::DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        x = m_LU.solve(b);
+    }
+
+    // SparseLUSolver
+
+    void SparseLUSolver::SetColumnOrdering(ColumnOrdering ordering) {
+        m_Ordering = ordering;
+        m_Pattern.Clear();
+    }
+
+    ColumnOrdering SparseLUSolver::ComputeColumnOrdering(const SparseMatrix& A) {
+        Eigen::SparseLU<SparseMatrix, Eigen::COLAMDOrdering<int>> lu;
+        lu.analyzePattern(A);
+        return std::make_shared<const Eigen::VectorXi>(lu.colsPermutation().indices());
+    }
+
+    bool SparseLUSolver::DoFactorize(const SparseMatrix& A) {
+        m_UseOrdered = m_Ordering && m_Ordering->size() == A.cols();
+        if (m_UseOrdered) {
+            m_Permutation.indices() = *m_Ordering;
+            m_Permuted = A * m_Permutation.inverse();
+            if (m_Pattern.Update(m_Permuted)) m_OrderedLU.analyzePattern(m_Permuted);
+            m_OrderedLU.factorize(m_Permuted);
+            m_UseQR = (m_OrderedLU.info() != Eigen::Success);
+        } else {
+            // The fill-reducing ordering only depends on the sparsity pattern. It is kept
+            // apart from an adopted one so a new pattern gets a new analysis.
+            if (m_Pattern.Update(A)) {
+                m_LU.analyzePattern(A);
+                m_ComputedOrdering = std::make_shared<const Eigen::VectorXi>(m_LU.colsPermutation().indices());
+            }
+            m_LU.factorize(A);
+            m_UseQR = (m_LU.info() != Eigen::Success);
+        }
+
+        if (m_UseQR) {
+            // Singular system (e.g. floating nodes): fall back to a rank-revealing sparse QR
+            m_Pattern.Clear();
+            m_QR.compute(A);
+            m_Stats.fallback = true;
+            return m_QR.info() == Eigen::Success;
+        }
+        return true;
+    }
+
+    void SparseLUSolver::DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        if (m_UseQR) {
+            x = m_QR.solve(b);
+        } else if (m_UseOrdered) {
+            // (A P^-1)(P x) = b
+            Eigen::VectorXd y = m_OrderedLU.solve(b);
+            x = m_Permutation.inverse() * y;
+        } else {
+            x = m_LU.solve(b);
+        }
+    }
+
+    // SparseCholeskySolver
+
+    bool SparseCholeskySolver::DoFactorize(const SparseMatrix& A) {
+        SparseMatrix asymmetry = A - SparseMatrix(A.transpose());
+        if (asymmetry.norm() <= 1e-12 * A.norm()) {
+            if (m_Pattern.Update(A)) m_LDLT.analyzePattern(A);
+            m_LDLT.factorize(A);
+            m_UseFallback = (m_LDLT.info() != Eigen::Success);
+        } else {
+            m_UseFallback = true;
+        }
+        m_Stats.fallback = m_UseFallback;
+        if (!m_UseFallback) return true;
+
+        m_Pattern.Clear();
+        return m_Fallback.Factorize(A);
+    }
+
+    void SparseCholeskySolver::DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        if (m_UseFallback) {
+            m_Fallback.Solve(b, x);
+        } else {
+            x = m_LDLT.solve(b);
+        }
+    }
+
+    // IterativeSolver
+
+    IterativeSolver::IterativeSolver(const IterativeSettings& settings) : m_Settings(settings) {}
+
+    namespace {
+        // Only the ILUT preconditioner has tuning knobs
+        void ConfigurePreconditioner(Eigen::IncompleteLUT<double>& ilu, const IterativeSettings& settings) {
+            ilu.setDroptol(settings.dropTolerance);
+            ilu.setFillfactor(settings.fillFactor);
+        }
+
+        void ConfigurePreconditioner(Eigen::DiagonalPreconditioner<double>&, const IterativeSettings&) {}
+    }
+
+    template <typename Solver>
+    bool IterativeSolver::Prepare(Solver& solver, const SparseMatrix& A) {
+        const int maxIterations = m_Settings.maxIterations > 0 ? m_Settings.maxIterations
+                                                               : 2 * static_cast<int>(A.cols());
+        solver.setTolerance(m_Settings.tolerance);
+        solver.setMaxIterations(maxIterations);
+        ConfigurePreconditioner(solver.preconditioner(), m_Settings);
+        solver.compute(A);
+        return solver.info() == Eigen::Success;
+    }
+
+    bool IterativeSolver::DoFactorize(const SparseMatrix& A) {
+        const bool jacobi = (m_Settings.preconditioner == Preconditioner::Jacobi);
+        if (m_Settings.method == KrylovMethod::GMRES) {
+            m_GMRESILU.set_restart(m_Settings.restart);
+            m_GMRESJacobi.set_restart(m_Settings.restart);
+            return jacobi ? Prepare(m_GMRESJacobi, A) : Prepare(m_GMRESILU, A);
+        }
+        return jacobi ? Prepare(m_BiCGSTABJacobi, A) : Prepare(m_BiCGSTABILU, A);
+    }
+
+    template <typename Solver>
+    void IterativeSolver::Iterate(Solver& solver, const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        if (m_Settings.warmStart && x.size() == b.size() && x.allFinite()) {
+            x = solver.solveWithGuess(b, x);
+        } else {
+            x = solver.solve(b);
+        }
+        m_Stats.iterations = static_cast<int>(solver.iterations());
+        m_Stats.totalIterations += m_Stats.iterations;
+        m_Stats.converged = (solver.info() == Eigen::Success);
+    }
+
+    void IterativeSolver::DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        const bool jacobi = (m_Settings.preconditioner == Preconditioner::Jacobi);
+        if (m_Settings.method == KrylovMethod::GMRES) {
+            if (jacobi) Iterate(m_GMRESJacobi, b, x);
+            else Iterate(m_GMRESILU, b, x);
+        } else {
+            if (jacobi) Iterate(m_BiCGSTABJacobi, b, x);
+            else Iterate(m_BiCGSTABILU, b, x);
+        }
+    }
+
+    std::unique_ptr<LinearSolver> CreateLinearSolver(SolverType type) {
+        switch (type) {
+            case SolverType::DenseQR:        return std::unique_ptr<LinearSolver>(new DenseQRSolver());
+            case SolverType::DenseLU:        return std::unique_ptr<LinearSolver>(new DenseLUSolver());
+            case SolverType::SparseLU:       return std::unique_ptr<LinearSolver>(new SparseLUSolver());
+            case SolverType::SparseCholesky: return std::unique_ptr<LinearSolver>(new SparseCholeskySolver());
+            case SolverType::Iterative:      return std::unique_ptr<LinearSolver>(new IterativeSolver());
+            case SolverType::Partitioned:    return std::unique_ptr<LinearSolver>(new PartitionedSolver());
+        }
+        return nullptr;
+    }
+}
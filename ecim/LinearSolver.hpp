@@ -0,0 +1,232 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Eigen/Dense"
+#include "Eigen/Sparse"
+#include "unsupported/Eigen/IterativeSolvers"
+
+namespace ecim {
+    typedef Eigen::SparseMatrix<double> SparseMatrix;
+    typedef std::shared_ptr<const Eigen::VectorXi> ColumnOrdering;   // Column permutation indices
+
+    // Backends available for solving the MNA system G * V = I
+    enum class SolverType {
+        DenseQR,        // Dense column-pivoting QR (robust, handles singular systems)
+        DenseLU,        // Dense partial-pivoting LU (faster than QR, needs a regular matrix)
+        SparseLU,       // Sparse LU with COLAMD ordering, sparse QR fallback when singular
+        SparseCholesky, // Sparse LDL^T with AMD ordering for symmetric systems, sparse LU otherwise
+        Iterative,      // Preconditioned Krylov solver, warm-started from the previous solution
+        Partitioned     // Schur-complement domain decomposition, subdomains factored in parallel
+    };
+
+    // Krylov methods for the iterative backend (the MNA system is unsymmetric)
+    enum class KrylovMethod {
+        BiCGSTAB,       // Short recurrences, low memory
+        GMRES           // Restarted GMRES, doesn't break down on the zero-diagonal source rows
+    };
+
+    // Preconditioners for the iterative backend
+    enum class Preconditioner {
+        IncompleteLU,   // Threshold incomplete LU (ILUT), robust for MNA systems
+        Jacobi          // Diagonal scaling, cheapest to build and apply (use with GMRES)
+    };
+
+    struct IterativeSettings {
+        KrylovMethod method = KrylovMethod::BiCGSTAB;
+        double tolerance = 1e-10;       // Relative residual at which iteration stops
+        int maxIterations = 0;          // 0 = twice the system size
+        int restart = 30;               // GMRES: Krylov subspace size before restarting
+        Preconditioner preconditioner = Preconditioner::IncompleteLU;
+        bool warmStart = true;          // Start from the previous solution instead of zero
+        double dropTolerance = 1e-4;    // ILUT: entries below this (relative) are dropped
+        int fillFactor = 10;            // ILUT: allowed fill per row relative to the input
+    };
+
+    // Timing and accuracy figures reported by a solver backend
+    struct SolverStats {
+        double factorSeconds = 0.0;         // Duration of the last factorization
+        double solveSeconds = 0.0;          // Duration of the last solve
+        double totalFactorSeconds = 0.0;
+        double totalSolveSeconds = 0.0;
+        size_t factorizations = 0;
+        size_t failedFactorizations = 0;    // Factorizations that reported a singular or unusable matrix
+        size_t solves = 0;
+        double residual = 0.0;              // ||G*V - I|| / ||I|| of the last solve (if enabled)
+        int iterations = 0;                 // Iterative backends: iterations of the last solve
+        size_t totalIterations = 0;
+        bool converged = true;              // Iterative backends: last solve reached the tolerance
+        bool fallback = false;              // The preferred method failed and a fallback was used
+    };
+
+    // Abstract linear solver. A backend factors the matrix once and then solves
+    // any number of right-hand sides against it.
+    class LinearSolver {
+    protected:
+        SolverStats m_Stats;
+        bool m_ComputeResidual = false;
+        const Eigen::MatrixXd* m_DenseMatrix = nullptr;   // Matrix of the last factorization
+        const SparseMatrix* m_SparseMatrix = nullptr;
+        Eigen::MatrixXd m_DenseCopy;    // Format conversions handed to backends
+        SparseMatrix m_SparseCopy;
+
+        // Backends override the storage format they work on, the defaults convert
+        virtual bool DoFactorize(const Eigen::MatrixXd& A);
+        virtual bool DoFactorize(const SparseMatrix& A);
+        virtual void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) = 0;
+
+    public:
+        virtual ~LinearSolver() {}
+
+        virtual SolverType GetType() const = 0;
+        virtual const char* GetName() const = 0;
+
+        // Whether the backend wants the system assembled as a sparse matrix
+        virtual bool IsSparse() const = 0;
+
+        // Factor the system matrix. The matrix must stay alive until the next
+        // Factorize() call. Returns false if the backend could not factor it.
+        bool Factorize(const Eigen::MatrixXd& A);
+        bool Factorize(const SparseMatrix& A);
+
+        // Solve against the last factorization. x is used as the initial guess
+        // by iterative backends.
+        void Solve(const Eigen::VectorXd& b, Eigen::VectorXd& x);
+
+        // Fill-reducing column ordering. Backends that support it can adopt an ordering
+        // computed elsewhere (e.g. shared by every circuit of a parameter sweep) instead
+        // of running their own analysis; the others ignore it.
+        virtual void SetColumnOrdering(ColumnOrdering ordering) {}
+        virtual ColumnOrdering GetColumnOrdering() const { return nullptr; }
+
+        // Residual tracking costs one matrix-vector product per solve
+        void SetComputeResidual(bool enabled) { m_ComputeResidual = enabled; }
+        bool GetComputeResidual() const { return m_ComputeResidual; }
+
+        const SolverStats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = SolverStats(); }
+    };
+
+    // Remembers a CSC sparsity pattern so symbolic analysis is only redone when it changes
+    class SparsityPattern {
+        std::vector<int> m_Outer;
+        std::vector<int> m_Inner;
+
+    public:
+        // Returns true (and records the new pattern) if A's pattern differs from the stored one
+        bool Update(const SparseMatrix& A);
+        void Clear();
+    };
+
+    class DenseQRSolver : public LinearSolver {
+        Eigen::ColPivHouseholderQR<Eigen::MatrixXd> m_QR;
+
+    protected:
+        bool DoFactorize(const Eigen::MatrixXd& A) override;
+        void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) override;
+
+    public:
+        SolverType GetType() const override { return SolverType::DenseQR; }
+        const char* GetName() const override { return "DenseQR"; }
+        bool IsSparse() const override { return false; }
+    };
+
+    class DenseLUSolver : public LinearSolver {
+        Eigen::PartialPivLU<Eigen::MatrixXd> m_LU;
+
+    protected:
+        bool DoFactorize(const Eigen::MatrixXd& A) override;
+        void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) override;
+
+    public:
+        SolverType GetType() const override { return SolverType::DenseLU; }
+        const char* GetName() const override { return "DenseLU"; }
+        bool IsSparse() const override { return false; }
+    };
+
+    class SparseLUSolver : public LinearSolver {
+        typedef Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> Permutation;
+
+        Eigen::SparseLU<SparseMatrix, Eigen::COLAMDOrdering<int>> m_LU;
+        Eigen::SparseQR<SparseMatrix, Eigen::COLAMDOrdering<int>> m_QR;
+        SparsityPattern m_Pattern;
+        bool m_UseQR = false;   // LU failed (singular system), m_QR holds the factors
+        ColumnOrdering m_Ordering;          // Adopted with SetColumnOrdering()
+        ColumnOrdering m_ComputedOrdering;  // m_LU's own, follows the current pattern
+
+        // With an adopted ordering the columns are permuted here and factored in natural order
+        Eigen::SparseLU<SparseMatrix, Eigen::NaturalOrdering<int>> m_OrderedLU;
+        Permutation m_Permutation;
+        SparseMatrix m_Permuted;
+        bool m_UseOrdered = false;
+
+    protected:
+        bool DoFactorize(const SparseMatrix& A) override;
+        void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) override;
+
+    public:
+        SolverType GetType() const override { return SolverType::SparseLU; }
+        const char* GetName() const override { return "SparseLU"; }
+        bool IsSparse() const override { return true; }
+
+        void SetColumnOrdering(ColumnOrdering ordering) override;
+        // The adopted ordering, otherwise the one of the last analysis
+        ColumnOrdering GetColumnOrdering() const override { return m_Ordering ? m_Ordering : m_ComputedOrdering; }
+
+        // COLAMD ordering (postordered like SparseLU's own analysis) for A's pattern
+        static ColumnOrdering ComputeColumnOrdering(const SparseMatrix& A);
+    };
+
+    // LDL^T only applies to symmetric matrices with a usable pivot order. MNA
+    // matrices with voltage sources are indefinite, so when the factorization
+    // breaks down (or the matrix isn't symmetric) the solver switches to sparse LU.
+    class SparseCholeskySolver : public LinearSolver {
+        Eigen::SimplicialLDLT<SparseMatrix, Eigen::Lower, Eigen::AMDOrdering<int>> m_LDLT;
+        SparseLUSolver m_Fallback;
+        SparsityPattern m_Pattern;
+        bool m_UseFallback = false;   // LDL^T failed, m_Fallback holds the factors
+
+    protected:
+        bool DoFactorize(const SparseMatrix& A) override;
+        void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) override;
+
+    public:
+        SolverType GetType() const override { return SolverType::SparseCholesky; }
+        const char* GetName() const override { return "SparseCholesky"; }
+        bool IsSparse() const override { return true; }
+    };
+
+    // Krylov solver for the unsymmetric MNA system. Factorize() builds the
+    // preconditioner, Solve() iterates from the previous solution when warm
+    // starting, since node voltages change little between transient steps.
+    class IterativeSolver : public LinearSolver {
+        IterativeSettings m_Settings;
+        Eigen::BiCGSTAB<SparseMatrix, Eigen::IncompleteLUT<double>> m_BiCGSTABILU;
+        Eigen::BiCGSTAB<SparseMatrix, Eigen::DiagonalPreconditioner<double>> m_BiCGSTABJacobi;
+        Eigen::GMRES<SparseMatrix, Eigen::IncompleteLUT<double>> m_GMRESILU;
+        Eigen::GMRES<SparseMatrix, Eigen::DiagonalPreconditioner<double>> m_GMRESJacobi;
+
+        template <typename Solver>
+        bool Prepare(Solver& solver, const SparseMatrix& A);
+        template <typename Solver>
+        void Iterate(Solver& solver, const Eigen::VectorXd& b, Eigen::VectorXd& x);
+
+    protected:
+        bool DoFactorize(const SparseMatrix& A) override;
+        void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) override;
+
+    public:
+        IterativeSolver(const IterativeSettings& settings = IterativeSettings());
+
+        // Takes effect at the next Factorize()
+        void SetSettings(const IterativeSettings& settings) { m_Settings = settings; }
+        const IterativeSettings& GetSettings() const { return m_Settings; }
+
+        SolverType GetType() const override { return SolverType::Iterative; }
+        const char* GetName() const override { return "Iterative"; }
+        bool IsSparse() const override { return true; }
+    };
+
+    // Create a backend of the given type
+    std::unique_ptr<LinearSolver> CreateLinearSolver(SolverType type);
+}
@@ -0,0 +1,63 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ecim {
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+#ifdef _WIN32
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        in.seekg(0, std::ios::end);
+        m_Buffer.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0, std::ios::beg);
+        in.read(&m_Buffer[0], m_Buffer.size());
+        m_Data = m_Buffer.data();
+        m_Size = m_Buffer.size();
+        return static_cast<bool>(in) || m_Buffer.empty();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            return false;
+        }
+        m_Size = static_cast<size_t>(info.st_size);
+        if (m_Size > 0) {
+            m_Map = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m_Map == MAP_FAILED) {
+                m_Map = nullptr;
+                close(fd);
+                return false;
+            }
+            madvise(m_Map, m_Size, MADV_SEQUENTIAL);
+            m_Data = static_cast<const char*>(m_Map);
+        }
+        close(fd);  // The mapping stays valid
+        return true;
+#endif
+    }
+
+    void MappedFile::Close() {
+#ifdef _WIN32
+        m_Buffer.clear();
+#else
+        if (m_Map) munmap(m_Map, m_Size);
+        m_Map = nullptr;
+#endif
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ecim {
+    // Read-only view of a whole file: memory-mapped on POSIX, read into a buffer
+    // elsewhere. The view stays valid while the object lives.
+    class MappedFile {
+        const char* m_Data = nullptr;
+        size_t m_Size = 0;
+#ifdef _WIN32
+        std::string m_Buffer;
+#else
+        void* m_Map = nullptr;
+#endif
+
+    public:
+        MappedFile() {}
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        // Returns false if the file can't be opened or mapped. Opening again maps the
+        // file's present contents, e.g. of a file that is still being written.
+        bool Open(const std::string& path);
+        void Close();
+
+        const char* GetData() const { return m_Data; }
+        size_t GetSize() const { return m_Size; }
+        std::string_view GetText() const { return std::string_view(m_Data, m_Size); }
+    };
+}
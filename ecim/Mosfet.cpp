@@ -0,0 +1,93 @@
+#include "Mosfet.hpp"
+#include <utility>
+
+namespace ecim {
+    namespace {
+        const double MinConductance = 1e-12;    // Drain-source leakage, keeps a cut-off channel from floating a node
+    }
+
+    Mosfet::Mosfet(double k, double threshold, double lambda)
+        : m_K(k), m_Threshold(threshold), m_Lambda(lambda) {}
+
+    bool Mosfet::Linearize() {
+        double vd = m_Node1 ? m_Node1->Voltage : 0.0;
+        double vs = m_Node2 ? m_Node2->Voltage : 0.0;
+        double vg = m_Gate ? m_Gate->Voltage : 0.0;
+        m_Reversed = vd < vs;
+        if (m_Reversed) std::swap(vd, vs);
+
+        double vgs = vg - vs;
+        double vds = vd - vs;
+        double vov = vgs - m_Threshold;     // Overdrive
+        double id = 0.0, gm = 0.0, gds = 0.0;
+        if (vov > 0.0) {
+            double clm = 1.0 + m_Lambda * vds;
+            if (vds < vov) {
+                double base = vov * vds - 0.5 * vds * vds;
+                id = m_K * base * clm;
+                gm = m_K * vds * clm;
+                gds = m_K * (vov - vds) * clm + m_K * base * m_Lambda;
+            } else {
+                double base = 0.5 * vov * vov;
+                id = m_K * base * clm;
+                gm = m_K * vov * clm;
+                gds = m_K * base * m_Lambda;
+            }
+        }
+
+        m_Gm = gm;
+        m_Gds = gds + MinConductance;
+        m_Ieq = id - gm * vgs - gds * vds;
+        return false;   // The square law doesn't need limiting
+    }
+
+    // Linearized as a conductance Gds from drain to source in parallel with a
+    // voltage-controlled current source Gm * Vgs and a current source Ieq
+    void Mosfet::Stamp(SimulationState &state) {
+        int d = m_Node1 ? m_Node1->Index : -1;
+        int s = m_Node2 ? m_Node2->Index : -1;
+        int g = m_Gate ? m_Gate->Index : -1;
+        if (m_Reversed) std::swap(d, s);
+
+        if (d >= 0) {
+            state.StampG(d, d, m_Gds);
+            if (s >= 0) state.StampG(d, s, -m_Gds - m_Gm);
+            if (g >= 0) state.StampG(d, g, m_Gm);
+            state.I(d) -= m_Ieq;
+        }
+        if (s >= 0) {
+            state.StampG(s, s, m_Gds + m_Gm);
+            if (d >= 0) state.StampG(s, d, -m_Gds);
+            if (g >= 0) state.StampG(s, g, -m_Gm);
+            state.I(s) += m_Ieq;
+        }
+    }
+
+    double Mosfet::GetCurrent() const {
+        double vd = m_Node1 ? m_Node1->Voltage : 0.0;
+        double vs = m_Node2 ? m_Node2->Voltage : 0.0;
+        double vg = m_Gate ? m_Gate->Voltage : 0.0;
+        if (m_Reversed) std::swap(vd, vs);
+
+        double id = m_Gm * (vg - vs) + m_Gds * (vd - vs) + m_Ieq;
+        return m_Reversed ? -id : id;
+    }
+
+    void Mosfet::SaveState(double* values) const {
+        NonlinearComponent::SaveState(values);
+        const size_t base = NonlinearComponent::GetStateSize();
+        values[base] = m_Reversed;
+        values[base + 1] = m_Gm;
+        values[base + 2] = m_Gds;
+        values[base + 3] = m_Ieq;
+    }
+
+    void Mosfet::RestoreState(const double* values) {
+        NonlinearComponent::RestoreState(values);
+        const size_t base = NonlinearComponent::GetStateSize();
+        m_Reversed = values[base] != 0.0;
+        m_Gm = values[base + 1];
+        m_Gds = values[base + 2];
+        m_Ieq = values[base + 3];
+    }
+}
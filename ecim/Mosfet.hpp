@@ -0,0 +1,47 @@
+#pragma once
+
+#include "NonlinearComponent.hpp"
+
+namespace ecim {
+    // N-channel MOSFET, square-law (SPICE level 1) model. Drain at node1, source
+    // at node2, the gate is connected with SetGate() before AddComponent():
+    //   cutoff      Vgs <= Vth:        Id = 0
+    //   linear      Vds <  Vgs - Vth:  Id = K * ((Vgs - Vth) * Vds - Vds^2 / 2) * (1 + lambda * Vds)
+    //   saturation  Vds >= Vgs - Vth:  Id = K / 2 * (Vgs - Vth)^2 * (1 + lambda * Vds)
+    // The device is symmetric: with Vds < 0 drain and source swap roles.
+    class Mosfet : public NonlinearComponent {
+        Node* m_Gate = nullptr;
+        double m_K;                 // Transconductance parameter (A/V^2)
+        double m_Threshold;         // Vth (V)
+        double m_Lambda;            // Channel-length modulation (1/V)
+
+        // Linearization: Id = m_Gm * Vgs + m_Gds * Vds + m_Ieq (effective drain/source)
+        bool m_Reversed = false;    // node2 acts as the drain
+        double m_Gm = 0.0;
+        double m_Gds = 0.0;
+        double m_Ieq = 0.0;
+
+    protected:
+        bool Linearize() override;
+
+    public:
+        Mosfet(double k = 1e-3, double threshold = 1.0, double lambda = 0.0);
+        void Stamp(SimulationState &state) override;
+        Component* Clone() const override { return new Mosfet(*this); }
+        size_t GetStateSize() const override { return NonlinearComponent::GetStateSize() + 4; }
+        void SaveState(double* values) const override;
+        void RestoreState(const double* values) override;
+        double GetCurrent() const override;     // Drain current (node1 to node2)
+
+        void SetGate(Node* gate) { m_Gate = gate; }
+        Node* GetGate() const { return m_Gate; }
+        Node* GetControlNode() const override { return m_Gate; }
+        void SetControlNode(Node* node) override { m_Gate = node; }
+
+        double GetK() const { return m_K; }
+        double GetThreshold() const { return m_Threshold; }
+        double GetLambda() const { return m_Lambda; }
+    };
+
+    template <> struct ArenaSkipsDestructor<Mosfet> : std::true_type {};
+}
@@ -0,0 +1,363 @@
+#include "NetlistLoader.hpp"
+#include "ACVoltageSource.hpp"
+#include "CustomVoltageSource.hpp"
+#include "MappedFile.hpp"
+#include "PulseVoltageSource.hpp"
+#include "PWLVoltageSource.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace ecim {
+    namespace {
+        typedef std::chrono::steady_clock Clock;
+
+        double SecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        char Lower(char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        bool IsSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        bool EqualsKeyword(std::string_view token, std::string_view keyword) {
+            if (token.size() != keyword.size()) return false;
+            for (size_t k = 0; k < token.size(); k++) {
+                if (Lower(token[k]) != keyword[k]) return false;
+            }
+            return true;
+        }
+
+        // Splits a statement at whitespace and at the ( ) , = of source specifications
+        class Tokenizer {
+            std::string_view m_Rest;
+
+            static bool IsSeparator(char c) {
+                return IsSpace(c) || c == '(' || c == ')' || c == ',' || c == '=';
+            }
+
+        public:
+            explicit Tokenizer(std::string_view text) : m_Rest(text) {}
+
+            bool Next(std::string_view& token) {
+                size_t start = 0;
+                while (start < m_Rest.size() && IsSeparator(m_Rest[start])) start++;
+                size_t end = start;
+                while (end < m_Rest.size() && !IsSeparator(m_Rest[end])) end++;
+                token = m_Rest.substr(start, end - start);
+                m_Rest = m_Rest.substr(end);
+                return !token.empty();
+            }
+
+            std::string_view GetRest() const { return m_Rest; }
+        };
+    }
+
+    size_t NetlistLoader::NameHash::operator()(std::string_view name) const {
+        // FNV-1a over the lower-cased name
+        size_t hash = 14695981039346656037ull;
+        for (char c : name) {
+            hash ^= static_cast<unsigned char>(Lower(c));
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool NetlistLoader::NameEqual::operator()(std::string_view a, std::string_view b) const {
+        if (a.size() != b.size()) return false;
+        for (size_t k = 0; k < a.size(); k++) {
+            if (Lower(a[k]) != Lower(b[k])) return false;
+        }
+        return true;
+    }
+
+    bool NetlistLoader::ParseValue(std::string_view text, double& value) {
+        if (!text.empty() && text[0] == '+') text.remove_prefix(1);  // from_chars rejects a leading +
+        const char* end = text.data() + text.size();
+        auto result = std::from_chars(text.data(), end, value);
+        if (result.ec != std::errc()) return false;
+
+        // Scale suffix, anything after it is a unit
+        std::string_view suffix(result.ptr, end - result.ptr);
+        if (suffix.empty()) return true;
+        if (suffix.size() >= 3 && EqualsKeyword(suffix.substr(0, 3), "meg")) value *= 1e6;
+        else if (suffix.size() >= 3 && EqualsKeyword(suffix.substr(0, 3), "mil")) value *= 25.4e-6;
+        else {
+            switch (Lower(suffix[0])) {
+                case 'f': value *= 1e-15; break;
+                case 'p': value *= 1e-12; break;
+                case 'n': value *= 1e-9; break;
+                case 'u': value *= 1e-6; break;
+                case 'm': value *= 1e-3; break;
+                case 'k': value *= 1e3; break;
+                case 'g': value *= 1e9; break;
+                case 't': value *= 1e12; break;
+                default: break;
+            }
+        }
+        return true;
+    }
+
+    bool NetlistLoader::LoadFile(const std::string& path, CircuitBuilder& circuit) {
+        m_Info = NetlistInfo();
+        Clock::time_point start = Clock::now();
+        MappedFile file;
+        if (!file.Open(path)) {
+            m_Info.error = "Cannot read " + path;
+            return false;
+        }
+        m_Info.readSeconds = SecondsSince(start);
+
+        m_Circuit = &circuit;
+        return Parse(file.GetText());
+    }
+
+    bool NetlistLoader::LoadString(std::string_view text, CircuitBuilder& circuit) {
+        m_Info = NetlistInfo();
+        m_Circuit = &circuit;
+        return Parse(text);
+    }
+
+    Node* NetlistLoader::GetNode(std::string_view name) const {
+        auto it = m_Nodes.find(name);
+        return it == m_Nodes.end() ? nullptr : it->second;
+    }
+
+    bool NetlistLoader::Fail(const std::string& message) {
+        m_Info.error = message;
+        return false;
+    }
+
+    bool NetlistLoader::Parse(std::string_view text) {
+        Clock::time_point start = Clock::now();
+        m_Nodes.clear();
+        m_Names.clear();
+
+        // One element per line is the common case; sizing up front avoids rehashing
+        const size_t estimate = std::count(text.begin(), text.end(), '\n') + 1;
+        m_Nodes.reserve(estimate);
+        m_Circuit->Reserve(estimate, estimate);
+
+        std::string joined;     // Only used for statements with '+' continuation lines
+        size_t position = 0;
+        size_t line = 0;
+        bool ok = true;
+        bool ended = false;
+
+        auto nextLine = [&](std::string_view& out) {
+            if (position >= text.size()) return false;
+            size_t end = text.find('\n', position);
+            if (end == std::string_view::npos) end = text.size();
+            out = text.substr(position, end - position);
+            position = end + 1;
+            line++;
+            return true;
+        };
+        auto trim = [](std::string_view s) {
+            size_t comment = s.find(';');
+            if (comment != std::string_view::npos) s = s.substr(0, comment);
+            while (!s.empty() && IsSpace(s.front())) s.remove_prefix(1);
+            while (!s.empty() && IsSpace(s.back())) s.remove_suffix(1);
+            return s;
+        };
+
+        std::string_view current;
+        if (nextLine(current)) m_Info.title = std::string(trim(current));
+
+        std::string_view statement;
+        size_t statementLine = 0;
+        bool continued = false;
+        auto flush = [&]() {
+            if (statement.empty()) return true;
+            std::string_view full = continued ? std::string_view(joined) : statement;
+            statement = std::string_view();
+            continued = false;
+            if (!ParseStatement(full)) {
+                m_Info.errorLine = statementLine;
+                return false;
+            }
+            return true;
+        };
+
+        while (ok && !ended && nextLine(current)) {
+            std::string_view content = trim(current);
+            if (content.empty() || content[0] == '*') continue;
+
+            if (content[0] == '+') {
+                if (statement.empty()) {
+                    m_Info.errorLine = line;
+                    ok = Fail("Continuation line without a statement");
+                    break;
+                }
+                if (!continued) joined.assign(statement.data(), statement.size());
+                joined += ' ';
+                joined.append(content.data() + 1, content.size() - 1);
+                continued = true;
+                continue;
+            }
+
+            ok = flush();
+            if (EqualsKeyword(content.substr(0, std::min<size_t>(content.size(), 4)), ".end") &&
+                (content.size() == 4 || IsSpace(content[4]))) {
+                ended = true;
+                break;
+            }
+            statement = content;
+            statementLine = line;
+        }
+        if (ok && !ended) ok = flush();
+
+        m_Info.lines = line;
+        m_Info.nodes = m_Nodes.size();
+        m_Info.parseSeconds = SecondsSince(start);
+        return ok;
+    }
+
+    Node* NetlistLoader::GetOrCreateNode(std::string_view name) {
+        auto it = m_Nodes.find(name);
+        if (it != m_Nodes.end()) return it->second;
+
+        Node* node = (name == "0" || EqualsKeyword(name, "gnd")) ? m_Circuit->GetGround() : m_Circuit->CreateNode();
+        m_Names.emplace_back(name);
+        m_Nodes.emplace(std::string_view(m_Names.back()), node);
+        return node;
+    }
+
+    bool NetlistLoader::ParseStatement(std::string_view statement) {
+        Tokenizer tokens(statement);
+        std::string_view name;
+        if (!tokens.Next(name)) return Fail("Empty statement");
+
+        if (name[0] == '.') {
+            if (EqualsKeyword(name, ".tran")) {
+                std::string_view step, stop;
+                if (!tokens.Next(step) || !tokens.Next(stop) ||
+                    !ParseValue(step, m_Info.tranStep) || !ParseValue(stop, m_Info.tranStop)) {
+                    return Fail(".tran needs tstep and tstop");
+                }
+                m_Info.hasTran = true;
+            } else if (EqualsKeyword(name, ".subckt")) {
+                return Fail("Subcircuits are not supported");
+            } else {
+                m_Info.ignoredCommands++;
+            }
+            return true;
+        }
+
+        const char type = Lower(name[0]);
+        if (type != 'r' && type != 'c' && type != 'l' && type != 'v') {
+            return Fail("Unsupported element " + std::string(name));
+        }
+
+        std::string_view terminal1, terminal2;
+        if (!tokens.Next(terminal1) || !tokens.Next(terminal2)) {
+            return Fail("Element " + std::string(name) + " needs two nodes");
+        }
+        Node* node1 = GetOrCreateNode(terminal1);
+        Node* node2 = GetOrCreateNode(terminal2);
+        if (type == 'v') return ParseSource(name, node1, node2, tokens.GetRest());
+
+        std::string_view token;
+        double value = 0.0;
+        if (!tokens.Next(token) || !ParseValue(token, value)) {
+            return Fail("Element " + std::string(name) + " needs a value");
+        }
+        // Anything after the value (e.g. IC=) is ignored
+        switch (type) {
+            case 'r':
+                if (value == 0.0) return Fail("Resistor " + std::string(name) + " has zero resistance");
+                m_Circuit->AddResistor(node1, node2, value);
+                break;
+            case 'c':
+                m_Circuit->AddCapacitor(node1, node2, value);
+                break;
+            default:
+                if (value == 0.0) return Fail("Inductor " + std::string(name) + " has zero inductance");
+                m_Circuit->AddInductor(node1, node2, value);
+                break;
+        }
+        m_Info.elements++;
+        return true;
+    }
+
+    bool NetlistLoader::ParseSource(std::string_view name, Node* node1, Node* node2, std::string_view spec) {
+        enum class Shape { DC, Sine, Pulse, PWL };
+        Shape shape = Shape::DC;
+        double dc = 0.0;
+        std::vector<double> parameters;
+
+        Tokenizer tokens(spec);
+        std::string_view token;
+        bool haveToken = tokens.Next(token);
+        while (haveToken) {
+            double value;
+            if (EqualsKeyword(token, "dc")) {
+                haveToken = tokens.Next(token);
+                if (!haveToken || !ParseValue(token, dc)) return Fail("Source " + std::string(name) + ": DC needs a value");
+                haveToken = tokens.Next(token);
+            } else if (EqualsKeyword(token, "ac")) {
+                // Small-signal magnitude and phase: only used by AC analysis, skipped here
+                for (int k = 0; k < 2 && (haveToken = tokens.Next(token)) && ParseValue(token, value); k++) {}
+                if (haveToken && ParseValue(token, value)) haveToken = tokens.Next(token);
+            } else if (EqualsKeyword(token, "sin") || EqualsKeyword(token, "pulse") || EqualsKeyword(token, "pwl")) {
+                shape = EqualsKeyword(token, "sin") ? Shape::Sine : EqualsKeyword(token, "pulse") ? Shape::Pulse : Shape::PWL;
+                parameters.clear();
+                while ((haveToken = tokens.Next(token)) && ParseValue(token, value)) parameters.push_back(value);
+            } else if (ParseValue(token, dc)) {
+                haveToken = tokens.Next(token);
+            } else {
+                return Fail("Source " + std::string(name) + ": unexpected " + std::string(token));
+            }
+        }
+
+        const double PI = 3.14159265358979323846;
+        switch (shape) {
+            case Shape::DC:
+                m_Circuit->AddDCVoltageSource(node1, node2, dc);
+                break;
+            case Shape::Sine: {
+                if (parameters.size() < 3) return Fail("Source " + std::string(name) + ": SIN needs vo va freq");
+                parameters.resize(6, 0.0);
+                const double offset = parameters[0], amplitude = parameters[1], frequency = parameters[2];
+                const double delay = parameters[3], damping = parameters[4], phase = parameters[5] * PI / 180.0;
+                if (offset == 0.0 && delay == 0.0 && damping == 0.0) {
+                    m_Circuit->AddACVoltageSource(node1, node2, amplitude, frequency, phase);
+                } else {
+                    m_Circuit->Add<CustomVoltageSource>(node1, node2, [=](double t) {
+                        if (t < delay) return offset + amplitude * std::sin(phase);
+                        return offset + amplitude * std::exp(-(t - delay) * damping) * std::sin(2.0 * PI * frequency * (t - delay) + phase);
+                    });
+                }
+                break;
+            }
+            case Shape::Pulse: {
+                if (parameters.size() < 2) return Fail("Source " + std::string(name) + ": PULSE needs v1 v2");
+                // Missing width holds v2, missing period means a single pulse
+                const size_t given = parameters.size();
+                parameters.resize(7, 0.0);
+                if (given < 6) parameters[5] = INFINITY;
+                m_Circuit->Add<PulseVoltageSource>(node1, node2, parameters[0], parameters[1], parameters[2],
+                                                   parameters[3], parameters[4], parameters[5], parameters[6]);
+                break;
+            }
+            case Shape::PWL: {
+                if (parameters.empty() || parameters.size() % 2 != 0) {
+                    return Fail("Source " + std::string(name) + ": PWL needs time-value pairs");
+                }
+                std::vector<std::pair<double, double>> points;
+                points.reserve(parameters.size() / 2);
+                for (size_t k = 0; k < parameters.size(); k += 2) points.emplace_back(parameters[k], parameters[k + 1]);
+                m_Circuit->Add<PWLVoltageSource>(node1, node2, points);
+                break;
+            }
+        }
+        m_Info.elements++;
+        return true;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "CircuitBuilder.hpp"
+
+namespace ecim {
+    // Outcome of a load, with timing kept apart from any later simulation
+    struct NetlistInfo {
+        std::string title;                  // First line, as in SPICE
+        size_t lines = 0;
+        size_t elements = 0;                // Components added
+        size_t nodes = 0;                   // Distinct node names, ground included
+        size_t ignoredCommands = 0;         // Dot commands other than .tran and .end
+        bool hasTran = false;
+        double tranStep = 0.0;              // .tran tstep tstop (s)
+        double tranStop = 0.0;
+        double readSeconds = 0.0;           // Mapping (or reading) the file
+        double parseSeconds = 0.0;          // Tokenizing and building the circuit
+        std::string error;                  // Empty on success
+        size_t errorLine = 0;               // 1-based line of the error
+    };
+
+    // Loader for a SPICE subset:
+    //
+    //     Rname n1 n2 value        Cname n1 n2 value        Lname n1 n2 value
+    //     Vname n+ n- [DC] value | SIN(vo va freq [td [theta [phase]]])
+    //                            | PULSE(v1 v2 [td [tr [tf [pw [per]]]]]) | PWL(t1 v1 t2 v2 ...)
+    //     .tran tstep tstop        .end
+    //
+    // Names and keywords are case-insensitive, values take the usual suffixes
+    // (f p n u m k meg g t mil) and trailing units, '*' starts a comment line, ';'
+    // an inline comment and '+' continues the previous line. Nodes "0" and "gnd"
+    // are the circuit's ground. Files are memory-mapped where the platform allows;
+    // lines are tokenized in place and node names are looked up by hash, so only
+    // new node names are copied. Elements are created with the circuit's arena
+    // factory methods.
+    class NetlistLoader {
+        // Case-insensitive hashing of views into the input or into m_Names
+        struct NameHash {
+            size_t operator()(std::string_view name) const;
+        };
+        struct NameEqual {
+            bool operator()(std::string_view a, std::string_view b) const;
+        };
+
+        CircuitBuilder* m_Circuit = nullptr;
+        std::unordered_map<std::string_view, Node*, NameHash, NameEqual> m_Nodes;
+        std::deque<std::string> m_Names;    // Stable storage for the keys of m_Nodes
+        NetlistInfo m_Info;
+
+        bool Parse(std::string_view text);
+        bool ParseStatement(std::string_view statement);
+        bool ParseSource(std::string_view name, Node* node1, Node* node2, std::string_view spec);
+        Node* GetOrCreateNode(std::string_view name);
+        bool Fail(const std::string& message);
+
+    public:
+        // Add the netlist's elements to circuit. Returns false on a syntax error or
+        // unreadable file, with GetInfo().error and errorLine set; elements before
+        // the error stay in the circuit.
+        bool LoadFile(const std::string& path, CircuitBuilder& circuit);
+        bool LoadString(std::string_view text, CircuitBuilder& circuit);
+
+        const NetlistInfo& GetInfo() const { return m_Info; }
+
+        // Node of the last load by name, nullptr if it wasn't used
+        Node* GetNode(std::string_view name) const;
+
+        // Value with SPICE scale suffix and optional unit, e.g. "4.7k", "10pF", "2meg".
+        // Returns false if text doesn't start with a number.
+        static bool ParseValue(std::string_view text, double& value);
+    };
+}
@@ -1,18 +1,25 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 namespace ecim {
     class Node {
     public:
-        static int nextId;
+        // Numbering of nodes created with new Node(), shared by the whole process;
+        // ID 0 is ground unless the circuit names one with SetGround(). Nodes from
+        // CircuitBuilder::CreateNode() are numbered per circuit and don't touch it.
+        static std::atomic<int> nextId;
 
         int Id;
+        int Index;      // Row in the MNA system, -1 for ground (reassigned by CircuitBuilder::Compile)
         double Voltage;
 
-        Node() : Id(nextId++), Voltage(0.0) {}
+        Node() : Id(nextId++), Index(Id - 1), Voltage(0.0) {}
+        explicit Node(int id) : Id(id), Index(id - 1), Voltage(0.0) {}
+        Node(const Node& other) : Id(other.Id), Index(other.Index), Voltage(other.Voltage) {}
     };
     
     // Initialize static member
-    inline int Node::nextId = 0; // 0 reserved for ground node
+    inline std::atomic<int> Node::nextId{0}; // 0 reserved for ground node
 }
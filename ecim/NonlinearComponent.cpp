@@ -0,0 +1,33 @@
+#include "NonlinearComponent.hpp"
+#include <cmath>
+
+namespace ecim {
+    bool NonlinearComponent::Update(double bypassTolerance) {
+        const Node* terminals[3] = {m_Node1, m_Node2, GetControlNode()};
+        double voltages[3];
+        // A limited linearization is never bypassed, a tolerance of 0 disables bypass
+        bool moved = !m_Linearized || m_Limited || bypassTolerance <= 0.0;
+        for (int k = 0; k < 3; k++) {
+            voltages[k] = terminals[k] ? terminals[k]->Voltage : 0.0;
+            if (std::abs(voltages[k] - m_LastVoltages[k]) > bypassTolerance) moved = true;
+        }
+        if (!moved) return false;
+
+        for (int k = 0; k < 3; k++) m_LastVoltages[k] = voltages[k];
+        m_Limited = Linearize();
+        m_Linearized = true;
+        return true;
+    }
+
+    void NonlinearComponent::SaveState(double* values) const {
+        for (int k = 0; k < 3; k++) values[k] = m_LastVoltages[k];
+        values[3] = m_Linearized;
+        values[4] = m_Limited;
+    }
+
+    void NonlinearComponent::RestoreState(const double* values) {
+        for (int k = 0; k < 3; k++) m_LastVoltages[k] = values[k];
+        m_Linearized = values[3] != 0.0;
+        m_Limited = values[4] != 0.0;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Component.hpp"
+
+namespace ecim {
+    // Base class for devices with a nonlinear I-V characteristic. CircuitBuilder
+    // solves circuits containing them with Newton-Raphson: every iteration the
+    // device is linearized around the present node voltages and Stamp() adds the
+    // linearization (Jacobian entries into G, equivalent current into I).
+    class NonlinearComponent : public Component {
+        double m_LastVoltages[3] = {0.0, 0.0, 0.0};    // Terminal voltages of the last linearization
+        bool m_Linearized = false;
+        bool m_Limited = false;
+
+    protected:
+        // Evaluate the model at the present node voltages and cache the linearization.
+        // Returns true if the device limited the step (linearized at voltages other
+        // than the present ones), which keeps the iteration from converging.
+        virtual bool Linearize() = 0;
+
+    public:
+        // Linearize unless no terminal voltage moved more than bypassTolerance since
+        // the last linearization (device bypass, off for a tolerance of 0). Returns false
+        // if the device was bypassed.
+        bool Update(double bypassTolerance);
+
+        // Force the next Update() to evaluate the device
+        void Invalidate() { m_Linearized = false; }
+
+        // The last linearization used limited voltages
+        bool IsLimited() const { return m_Limited; }
+
+        // Current from node1 to node2 at the present node voltages
+        virtual double GetCurrent() const = 0;
+
+        // The last linearization point; devices append their cached linearization
+        size_t GetStateSize() const override { return 5; }
+        void SaveState(double* values) const override;
+        void RestoreState(const double* values) override;
+    };
+}
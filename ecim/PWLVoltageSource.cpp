@@ -0,0 +1,56 @@
+#include "PWLVoltageSource.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ecim {
+    PWLVoltageSource::PWLVoltageSource(const std::vector<std::pair<double, double>>& points) {
+        std::vector<std::pair<double, double>> sorted(points);
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const std::pair<double, double>& a, const std::pair<double, double>& b) { return a.first < b.first; });
+        for (const auto& point : sorted) {
+            m_Times.push_back(point.first);
+            m_Voltages.push_back(point.second);
+        }
+    }
+
+    double PWLVoltageSource::GetVoltage(double time) const {
+        if (m_Times.empty()) return 0.0;
+
+        // First point after time; the segment to interpolate ends there
+        size_t next = std::upper_bound(m_Times.begin(), m_Times.end(), time) - m_Times.begin();
+        if (next == 0) return m_Voltages.front();
+        if (next == m_Times.size()) return m_Voltages.back();
+
+        const double t0 = m_Times[next - 1], t1 = m_Times[next];
+        return m_Voltages[next - 1] + (m_Voltages[next] - m_Voltages[next - 1]) * (time - t0) / (t1 - t0);
+    }
+
+    void PWLVoltageSource::EvaluateBlock(double start, double step, int count, double* values) const {
+        if (m_Times.empty()) {
+            std::fill(values, values + count, 0.0);
+            return;
+        }
+
+        size_t next = std::upper_bound(m_Times.begin(), m_Times.end(), start) - m_Times.begin();
+        int k = 0;
+        while (k < count) {
+            double time = start + k * step;
+            while (next < m_Times.size() && m_Times[next] <= time) next++;
+            if (next == 0 || next == m_Times.size()) {
+                values[k++] = next == 0 ? m_Voltages.front() : m_Voltages.back();
+                continue;
+            }
+
+            // Every sample before the segment ends, in one loop
+            const double t0 = m_Times[next - 1], t1 = m_Times[next];
+            const double v0 = m_Voltages[next - 1];
+            const double slope = (m_Voltages[next] - v0) / (t1 - t0);
+            for (; k < count && start + k * step < t1; k++) values[k] = v0 + slope * (start + k * step - t0);
+        }
+    }
+
+    double PWLVoltageSource::GetNextBreakpoint(double time) const {
+        auto next = std::upper_bound(m_Times.begin(), m_Times.end(), time);
+        return next == m_Times.end() ? INFINITY : *next;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "VoltageSource.hpp"
+#include <utility>
+#include <vector>
+
+namespace ecim {
+    // Piecewise-Linear Voltage Source - straight lines between (time, voltage) points
+    // Holds the first voltage before the first point and the last one after the last.
+    // Points sharing a time give an ideal step; the later one applies from that time on.
+    class PWLVoltageSource : public VoltageSource {
+    private:
+        std::vector<double> m_Times;      // Ascending
+        std::vector<double> m_Voltages;
+
+    public:
+        PWLVoltageSource(const std::vector<std::pair<double, double>>& points);
+        double GetVoltage(double time) const override;
+        double GetNextBreakpoint(double time) const override;
+        // One search for the first sample, then walks the segments forward
+        void EvaluateBlock(double start, double step, int count, double* values) const override;
+        Component* Clone() const override { return new PWLVoltageSource(*this); }
+
+        size_t GetPointCount() const { return m_Times.size(); }
+        double GetPointTime(size_t index) const { return m_Times[index]; }
+        double GetPointVoltage(size_t index) const { return m_Voltages[index]; }
+    };
+}
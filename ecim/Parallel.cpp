@@ -0,0 +1,89 @@
+#include "Parallel.hpp"
+
+namespace ecim {
+    int DefaultThreadCount() {
+        unsigned int count = std::thread::hardware_concurrency();
+        return count > 0 ? static_cast<int>(count) : 1;
+    }
+
+    void ParallelFor(size_t count, int threads, const std::function<void(size_t index, int worker)>& fn) {
+        if (threads <= 0) threads = DefaultThreadCount();
+        if (static_cast<size_t>(threads) > count) threads = static_cast<int>(count);
+
+        // Single worker: run inline, no thread start-up cost
+        if (threads <= 1) {
+            for (size_t i = 0; i < count; i++) fn(i, 0);
+            return;
+        }
+
+        std::atomic<size_t> next(0);
+        auto work = [&](int worker) {
+            for (size_t i = next++; i < count; i = next++) fn(i, worker);
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (int t = 1; t < threads; t++) pool.emplace_back(work, t);
+        work(0);  // The calling thread is worker 0
+        for (auto& thread : pool) thread.join();
+    }
+
+    ThreadPool::ThreadPool(int threads) {
+        if (threads <= 0) threads = DefaultThreadCount();
+        m_Workers.reserve(threads - 1);
+        for (int t = 1; t < threads; t++) m_Workers.emplace_back(&ThreadPool::Work, this, t);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Start.notify_all();
+        for (auto& thread : m_Workers) thread.join();
+    }
+
+    void ThreadPool::RunTasks(int worker) {
+        for (size_t i = m_Next++; i < m_Count; i = m_Next++) (*m_Task)(i, worker);
+    }
+
+    void ThreadPool::Work(int worker) {
+        size_t generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Start.wait(lock, [&] { return m_Stop || m_Generation != generation; });
+                if (m_Stop) return;
+                generation = m_Generation;
+            }
+            RunTasks(worker);
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (--m_Busy == 0) m_Done.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::Run(size_t count, const std::function<void(size_t index, int worker)>& fn) {
+        // Nothing to share: run inline without waking anyone
+        if (m_Workers.empty() || count <= 1) {
+            for (size_t i = 0; i < count; i++) fn(i, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Task = &fn;
+            m_Count = count;
+            m_Next = 0;
+            m_Busy = static_cast<int>(m_Workers.size());
+            m_Generation++;
+        }
+        m_Start.notify_all();
+        RunTasks(0);
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Done.wait(lock, [&] { return m_Busy == 0; });
+        m_Task = nullptr;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecim {
+    // Worker count used when a thread count of 0 is requested (hardware concurrency, at least 1)
+    int DefaultThreadCount();
+
+    // Run fn(index, worker) for every index in [0, count) on up to `threads` worker
+    // threads (0 = DefaultThreadCount()). Indices are handed out dynamically, so
+    // uneven work balances itself; worker is in [0, threads) and can select
+    // per-thread scratch space. Returns once every index has been processed.
+    void ParallelFor(size_t count, int threads, const std::function<void(size_t index, int worker)>& fn);
+
+    // Worker threads that stay alive between parallel loops, for callers that run
+    // many short ones (e.g. every solve of a transient run) where starting threads
+    // each time would cost more than the work. Run() has ParallelFor's semantics;
+    // it isn't reentrant and must be called from one thread at a time.
+    class ThreadPool {
+        std::vector<std::thread> m_Workers;     // Workers 1..n, the caller of Run() is worker 0
+        std::mutex m_Mutex;
+        std::condition_variable m_Start;
+        std::condition_variable m_Done;
+        const std::function<void(size_t, int)>* m_Task = nullptr;
+        size_t m_Count = 0;
+        std::atomic<size_t> m_Next{0};
+        size_t m_Generation = 0;                // Incremented for every Run() the workers join
+        int m_Busy = 0;                         // Workers still in the current Run()
+        bool m_Stop = false;
+
+        void Work(int worker);
+        void RunTasks(int worker);
+
+    public:
+        // threads counts the calling thread (0 = DefaultThreadCount())
+        explicit ThreadPool(int threads = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        int GetThreadCount() const { return static_cast<int>(m_Workers.size()) + 1; }
+
+        void Run(size_t count, const std::function<void(size_t index, int worker)>& fn);
+    };
+}
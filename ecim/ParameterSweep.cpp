@@ -0,0 +1,107 @@
+#include "ParameterSweep.hpp"
+#include "Parallel.hpp"
+#include "Probe.hpp"
+#include "Resistor.hpp"
+#include "Capacitor.hpp"
+#include "Inductor.hpp"
+#include "DCVoltageSource.hpp"
+#include "ACVoltageSource.hpp"
+#include <algorithm>
+
+namespace ecim {
+    namespace {
+        template <typename T>
+        int IndexOf(const std::vector<T*>& items, const T* item) {
+            auto it = std::find(items.begin(), items.end(), item);
+            return it == items.end() ? -1 : static_cast<int>(it - items.begin());
+        }
+    }
+
+    ParameterSweep::ParameterSweep(CircuitBuilder& circuit, Component* target, SweepParameter parameter)
+        : m_Circuit(circuit), m_Target(target), m_Parameter(parameter) {}
+
+    int ParameterSweep::AddProbe(const Node* node) {
+        int index = IndexOf(m_Circuit.GetNodes(), node);
+        if (index < 0) return -1;
+        m_Probes.push_back({index, -1});
+        return static_cast<int>(m_Probes.size()) - 1;
+    }
+
+    int ParameterSweep::AddProbe(const Component* component) {
+        int index = IndexOf(m_Circuit.GetComponents(), component);
+        if (index < 0) return -1;
+        m_Probes.push_back({-1, index});
+        return static_cast<int>(m_Probes.size()) - 1;
+    }
+
+    bool ParameterSweep::SetParameter(Component* component, SweepParameter parameter, double value) {
+        switch (parameter) {
+            case SweepParameter::Resistance:
+                if (auto resistor = dynamic_cast<Resistor*>(component)) { resistor->SetResistance(value); return true; }
+                break;
+            case SweepParameter::Capacitance:
+                if (auto capacitor = dynamic_cast<Capacitor*>(component)) { capacitor->SetCapacitance(value); return true; }
+                break;
+            case SweepParameter::Inductance:
+                if (auto inductor = dynamic_cast<Inductor*>(component)) { inductor->SetInductance(value); return true; }
+                break;
+            case SweepParameter::Voltage:
+                if (auto source = dynamic_cast<DCVoltageSource*>(component)) { source->SetVoltage(value); return true; }
+                break;
+            case SweepParameter::Amplitude:
+                if (auto source = dynamic_cast<ACVoltageSource*>(component)) { source->SetAmplitude(value); return true; }
+                break;
+            case SweepParameter::Frequency:
+                if (auto source = dynamic_cast<ACVoltageSource*>(component)) { source->SetFrequency(value); return true; }
+                break;
+        }
+        return false;
+    }
+
+    std::vector<SweepResult> ParameterSweep::Run(const std::vector<double>& values, double duration, double deltaTime) {
+        std::vector<SweepResult> results;
+        int target = IndexOf(m_Circuit.GetComponents(), static_cast<const Component*>(m_Target));
+        if (target < 0 || values.empty()) return results;
+
+        // Validate on a throwaway clone so the original keeps its values
+        auto check = m_Circuit.Clone();
+        if (!check || !SetParameter(check->GetComponents()[target], m_Parameter, values[0])) return results;
+
+        // Symbolic analysis once for all points (on the clone, it compiles and assembles);
+        // parameter values don't change the pattern
+        ColumnOrdering ordering;
+        if (m_Circuit.GetSolverType() == SolverType::SparseLU) ordering = check->AnalyzeOrdering(deltaTime);
+
+        results.resize(values.size());
+        const int probeCount = static_cast<int>(m_Probes.size());
+        const size_t steps = static_cast<size_t>(duration / deltaTime + 0.5);
+
+        // Each point only writes its own result slot, the original circuit is only read
+        ParallelFor(values.size(), m_ThreadCount, [&](size_t point, int) {
+            SweepResult& result = results[point];
+            result.value = values[point];
+            result.probeCount = probeCount;
+
+            auto circuit = m_Circuit.Clone();
+            SetParameter(circuit->GetComponents()[target], m_Parameter, values[point]);
+            if (ordering) circuit->SetColumnOrdering(ordering);
+
+            std::vector<Probe> probes;
+            for (auto& probe : m_Probes) {
+                if (probe.nodeIndex >= 0) probes.emplace_back(circuit->GetNodes()[probe.nodeIndex]);
+                else probes.emplace_back(circuit->GetComponents()[probe.componentIndex]);
+            }
+
+            result.times.reserve(steps);
+            result.samples.reserve(steps * probeCount);
+            circuit->Simulate(duration, deltaTime, [&]() {
+                result.times.push_back(circuit->GetCurrentTime());
+                for (int p = 0; p < probeCount; p++) {
+                    result.samples.push_back(m_Probes[p].nodeIndex >= 0 ? probes[p].Voltage() : probes[p].Current());
+                }
+            });
+        });
+
+        return results;
+    }
+}
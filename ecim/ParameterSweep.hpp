@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include "CircuitBuilder.hpp"
+
+namespace ecim {
+    // Component value varied by a sweep
+    enum class SweepParameter {
+        Resistance,     // Resistor
+        Capacitance,    // Capacitor
+        Inductance,     // Inductor
+        Voltage,        // DCVoltageSource
+        Amplitude,      // ACVoltageSource
+        Frequency       // ACVoltageSource
+    };
+
+    // Probe samples of one sweep point
+    struct SweepResult {
+        double value = 0.0;                 // Parameter value of this point
+        std::vector<double> times;
+        std::vector<double> samples;        // [sample][probe]
+        int probeCount = 0;
+
+        double GetSample(size_t sample, int probe) const { return samples[sample * probeCount + probe]; }
+    };
+
+    // Transient parameter sweep. Every point simulates its own clone of the circuit,
+    // so points are independent and are distributed over worker threads. The clones
+    // share the circuit's topology, and with the SparseLU backend they also share one
+    // fill-reducing ordering computed up front, leaving only numeric factorization
+    // to each point.
+    class ParameterSweep {
+        struct SweepProbe {
+            int nodeIndex;          // Index into GetNodes(), or -1
+            int componentIndex;     // Index into GetComponents(), or -1
+        };
+
+        CircuitBuilder& m_Circuit;
+        Component* m_Target;
+        SweepParameter m_Parameter;
+        std::vector<SweepProbe> m_Probes;
+        int m_ThreadCount = 0;
+
+    public:
+        ParameterSweep(CircuitBuilder& circuit, Component* target, SweepParameter parameter);
+
+        // Record a node voltage or component current (resistors and voltage sources)
+        // every step. Returns the probe index, or -1 if it isn't part of the circuit.
+        int AddProbe(const Node* node);
+        int AddProbe(const Component* component);
+
+        // Worker threads, 0 = hardware concurrency
+        void SetThreadCount(int threads) { m_ThreadCount = threads; }
+        int GetThreadCount() const { return m_ThreadCount; }
+
+        // Set the parameter of a component, returns false if it doesn't have it
+        static bool SetParameter(Component* component, SweepParameter parameter, double value);
+
+        // Simulate every value for `duration` from the circuit's current state, one
+        // result per value in the same order. Each point steps with Simulate(), so
+        // it lands on source breakpoints like a plain run; a sample is recorded
+        // after every step. The circuit's own state isn't advanced.
+        // Returns an empty vector if the circuit can't be cloned or the target
+        // doesn't have the parameter.
+        std::vector<SweepResult> Run(const std::vector<double>& values, double duration, double deltaTime);
+    };
+}
@@ -0,0 +1,268 @@
+#include "PartitionedSolver.hpp"
+#include "GraphPartition.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace ecim {
+    namespace {
+        typedef std::chrono::steady_clock Clock;
+
+        double SecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+    }
+
+    // PartitionStats
+
+    double PartitionStats::InterfaceFraction() const {
+        return systemSize > 0 ? static_cast<double>(interfaceSize) / systemSize : 0.0;
+    }
+
+    double PartitionStats::Imbalance() const {
+        if (domainSizes.empty()) return 1.0;
+        int largest = 0;
+        double total = 0.0;
+        for (int size : domainSizes) {
+            largest = std::max(largest, size);
+            total += size;
+        }
+        return total > 0.0 ? largest * domainSizes.size() / total : 1.0;
+    }
+
+    // PartitionedSolver
+
+    PartitionedSolver::PartitionedSolver(const PartitionSettings& settings) : m_Settings(settings) {}
+
+    void PartitionedSolver::SetSettings(const PartitionSettings& settings) {
+        m_Settings = settings;
+        m_Pattern.Clear();
+    }
+
+    void PartitionedSolver::Partition(const SparseMatrix& A) {
+        const int n = static_cast<int>(A.cols());
+        size_t partitions = m_PartitionStats.partitions + 1;
+        m_PartitionStats = PartitionStats();
+        m_PartitionStats.partitions = partitions;
+        m_PartitionStats.systemSize = n;
+        m_Domains.clear();
+        m_Interface.clear();
+        m_DomainOf.assign(n, -1);
+        m_LocalIndex.assign(n, 0);
+
+        int count = m_Settings.domains > 0 ? m_Settings.domains
+                  : (m_Settings.threads > 0 ? m_Settings.threads : DefaultThreadCount());
+        count = std::min(count, n / std::max(1, m_Settings.minDomainSize));
+        m_Split = (count >= 2);
+        if (!m_Split) return;
+
+        // No point in more workers than domains
+        int threads = m_Settings.threads > 0 ? m_Settings.threads : DefaultThreadCount();
+        threads = std::min(threads, count);
+        if (!m_Pool || m_Pool->GetThreadCount() != threads) m_Pool = std::make_unique<ThreadPool>(threads);
+
+        // Symmetrized graph of the pattern and the diagonal
+        std::vector<std::vector<int>> adjacency(n);
+        std::vector<double> diagonal(n, 0.0);
+        for (int col = 0; col < n; col++) {
+            for (SparseMatrix::InnerIterator it(A, col); it; ++it) {
+                int row = static_cast<int>(it.row());
+                if (row == col) {
+                    diagonal[col] = it.value();
+                } else {
+                    adjacency[row].push_back(col);
+                    adjacency[col].push_back(row);
+                }
+            }
+        }
+        for (auto& neighbors : adjacency) {
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        }
+
+        std::vector<int> part = PartitionGraph(adjacency, count);
+
+        // Vertex separator: the higher-numbered end of every cut edge joins the interface
+        std::vector<char> onInterface(n, 0);
+        std::vector<int> pending;
+        for (int v = 0; v < n; v++) {
+            for (int u : adjacency[v]) {
+                if (part[u] < part[v]) {
+                    onInterface[v] = 1;
+                    pending.push_back(v);
+                    break;
+                }
+            }
+        }
+
+        // A row without a diagonal (a voltage source branch) can only be eliminated
+        // together with its neighbors, so it follows them onto the interface
+        while (!pending.empty()) {
+            int v = pending.back();
+            pending.pop_back();
+            for (int u : adjacency[v]) {
+                if (!onInterface[u] && diagonal[u] == 0.0) {
+                    onInterface[u] = 1;
+                    pending.push_back(u);
+                }
+            }
+        }
+
+        // Number the interior rows of the non-empty domains and the interface
+        std::vector<int> domainIndex(count, -1);
+        for (int v = 0; v < n; v++) {
+            if (onInterface[v]) {
+                m_LocalIndex[v] = static_cast<int>(m_Interface.size());
+                m_Interface.push_back(v);
+                continue;
+            }
+            int& index = domainIndex[part[v]];
+            if (index < 0) {
+                index = static_cast<int>(m_Domains.size());
+                m_Domains.emplace_back(new Domain());
+            }
+            Domain& domain = *m_Domains[index];
+            m_DomainOf[v] = index;
+            m_LocalIndex[v] = static_cast<int>(domain.rows.size());
+            domain.rows.push_back(v);
+        }
+
+        m_Split = (m_Domains.size() >= 2);
+        if (!m_Split) {
+            m_Domains.clear();
+            m_Interface.clear();
+            return;
+        }
+
+        m_PartitionStats.interfaceSize = static_cast<int>(m_Interface.size());
+        for (auto& domain : m_Domains) m_PartitionStats.domainSizes.push_back(static_cast<int>(domain->rows.size()));
+        m_PartitionStats.domainFactorSeconds.assign(m_Domains.size(), 0.0);
+        m_PartitionStats.domainSolveSeconds.assign(m_Domains.size(), 0.0);
+    }
+
+    bool PartitionedSolver::FactorDomains(const SparseMatrix& A) {
+        const int interfaceSize = static_cast<int>(m_Interface.size());
+
+        // Distribute the entries over the blocks
+        for (auto& domain : m_Domains) {
+            domain->interiorTriplets.clear();
+            domain->couplingTriplets.clear();
+            domain->borderTriplets.clear();
+        }
+        std::vector<Eigen::Triplet<double>> interfaceTriplets;
+        for (int col = 0; col < A.outerSize(); col++) {
+            const int colDomain = m_DomainOf[col];
+            const int localCol = m_LocalIndex[col];
+            for (SparseMatrix::InnerIterator it(A, col); it; ++it) {
+                const int row = static_cast<int>(it.row());
+                const int rowDomain = m_DomainOf[row];
+                const int localRow = m_LocalIndex[row];
+                if (rowDomain >= 0 && colDomain >= 0) {
+                    if (rowDomain != colDomain) return false;  // Not separated, can't happen for a matching pattern
+                    m_Domains[rowDomain]->interiorTriplets.emplace_back(localRow, localCol, it.value());
+                } else if (rowDomain >= 0) {
+                    m_Domains[rowDomain]->couplingTriplets.emplace_back(localRow, localCol, it.value());
+                } else if (colDomain >= 0) {
+                    m_Domains[colDomain]->borderTriplets.emplace_back(localRow, localCol, it.value());
+                } else {
+                    interfaceTriplets.emplace_back(localRow, localCol, it.value());
+                }
+            }
+        }
+
+        // Factor every interior block and form its Schur complement contribution
+        m_Pool->Run(m_Domains.size(), [&](size_t index, int) {
+            auto start = Clock::now();
+            Domain& domain = *m_Domains[index];
+            const int size = static_cast<int>(domain.rows.size());
+            domain.interior.resize(size, size);
+            domain.interior.setFromTriplets(domain.interiorTriplets.begin(), domain.interiorTriplets.end());
+            domain.coupling.resize(size, interfaceSize);
+            domain.coupling.setFromTriplets(domain.couplingTriplets.begin(), domain.couplingTriplets.end());
+            domain.border.resize(interfaceSize, size);
+            domain.border.setFromTriplets(domain.borderTriplets.begin(), domain.borderTriplets.end());
+
+            // The interior pattern only changes with a new partition
+            if (!domain.analyzed) {
+                domain.lu.analyzePattern(domain.interior);
+                domain.analyzed = true;
+            }
+            domain.lu.factorize(domain.interior);
+            domain.factored = (domain.lu.info() == Eigen::Success);
+            if (domain.factored) {
+                domain.solvedCoupling = domain.lu.solve(Eigen::MatrixXd(domain.coupling));
+                domain.schurContribution = domain.border * domain.solvedCoupling;
+            }
+            m_PartitionStats.domainFactorSeconds[index] = SecondsSince(start);
+        });
+
+        for (auto& domain : m_Domains) {
+            if (!domain->factored) return false;
+        }
+
+        // S = A_SS - sum of A_Sd A_dd^-1 A_dS
+        auto start = Clock::now();
+        Eigen::MatrixXd schur = Eigen::MatrixXd::Zero(interfaceSize, interfaceSize);
+        for (const auto& triplet : interfaceTriplets) schur(triplet.row(), triplet.col()) += triplet.value();
+        for (auto& domain : m_Domains) schur -= domain->schurContribution;
+        bool ok = true;
+        if (interfaceSize > 0) {
+            m_SchurLU.compute(schur);
+            ok = m_SchurLU.rcond() > 0.0;
+        }
+        m_PartitionStats.schurFactorSeconds = SecondsSince(start);
+        return ok;
+    }
+
+    bool PartitionedSolver::DoFactorize(const SparseMatrix& A) {
+        if (m_Pattern.Update(A)) Partition(A);
+
+        m_UseDirect = !(m_Split && FactorDomains(A));
+        if (!m_UseDirect) return true;
+
+        // Too small to split, or a block is singular (e.g. a floating domain)
+        if (m_Split) m_Stats.fallback = true;
+        bool ok = m_Direct.Factorize(A);
+        if (m_Direct.GetStats().fallback) m_Stats.fallback = true;
+        return ok;
+    }
+
+    void PartitionedSolver::DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) {
+        if (m_UseDirect) {
+            m_Direct.Solve(b, x);
+            return;
+        }
+
+        // Interior solves y_d = A_dd^-1 b_d
+        m_Pool->Run(m_Domains.size(), [&](size_t index, int) {
+            auto start = Clock::now();
+            Domain& domain = *m_Domains[index];
+            Eigen::VectorXd local(domain.rows.size());
+            for (size_t k = 0; k < domain.rows.size(); k++) local(k) = b(domain.rows[k]);
+            domain.interiorSolution = domain.lu.solve(local);
+            m_PartitionStats.domainSolveSeconds[index] = SecondsSince(start);
+        });
+
+        // Interface: S x_S = b_S - sum of A_Sd y_d
+        auto start = Clock::now();
+        const int interfaceSize = static_cast<int>(m_Interface.size());
+        Eigen::VectorXd interfaceSolution(interfaceSize);
+        if (interfaceSize > 0) {
+            Eigen::VectorXd reduced(interfaceSize);
+            for (int k = 0; k < interfaceSize; k++) reduced(k) = b(m_Interface[k]);
+            for (auto& domain : m_Domains) reduced -= domain->border * domain->interiorSolution;
+            interfaceSolution = m_SchurLU.solve(reduced);
+        }
+        x.resize(b.size());
+        for (int k = 0; k < interfaceSize; k++) x(m_Interface[k]) = interfaceSolution(k);
+        m_PartitionStats.schurSolveSeconds = SecondsSince(start);
+
+        // Back substitution x_d = y_d - A_dd^-1 A_dS x_S
+        m_Pool->Run(m_Domains.size(), [&](size_t index, int) {
+            auto start = Clock::now();
+            Domain& domain = *m_Domains[index];
+            if (interfaceSize > 0) domain.interiorSolution -= domain.solvedCoupling * interfaceSolution;
+            for (size_t k = 0; k < domain.rows.size(); k++) x(domain.rows[k]) = domain.interiorSolution(k);
+            m_PartitionStats.domainSolveSeconds[index] += SecondsSince(start);
+        });
+    }
+}
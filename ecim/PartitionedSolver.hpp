@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "LinearSolver.hpp"
+#include "Parallel.hpp"
+
+namespace ecim {
+    struct PartitionSettings {
+        int domains = 0;            // Subdomain count, 0 = one per worker thread
+        int threads = 0;            // Worker threads, 0 = DefaultThreadCount()
+        int minDomainSize = 64;     // Fewer rows per domain than this reduces the domain count
+    };
+
+    // Partition quality and per-domain timing of the last factorization and solve
+    struct PartitionStats {
+        int systemSize = 0;
+        int interfaceSize = 0;                      // Rows of the Schur complement
+        std::vector<int> domainSizes;               // Interior rows per domain
+        std::vector<double> domainFactorSeconds;    // Block factorization plus Schur contribution
+        std::vector<double> domainSolveSeconds;     // Both substitutions of the last solve
+        double schurFactorSeconds = 0.0;
+        double schurSolveSeconds = 0.0;
+        size_t partitions = 0;                      // Times the matrix graph was partitioned
+
+        int GetDomainCount() const { return static_cast<int>(domainSizes.size()); }
+        // Share of the system in the interface (0 = domains are independent)
+        double InterfaceFraction() const;
+        // Largest domain relative to the mean (1 = perfectly balanced)
+        double Imbalance() const;
+    };
+
+    // Schur-complement domain decomposition. The matrix graph is split into
+    // subdomains that only couple through a set of interface rows:
+    //
+    //     [ A_11         A_1S ] [x_1]   [b_1]
+    //     [       A_22   A_2S ] [x_2] = [b_2]
+    //     [ A_S1  A_S2   A_SS ] [x_S]   [b_S]
+    //
+    // The interior blocks A_dd are factored in parallel, each also contributing
+    // A_Sd A_dd^-1 A_dS to the dense interface Schur complement, which is factored
+    // last. Solves run the two substitutions of every domain in parallel around
+    // the small interface solve. The workers belong to the solver and live as long
+    // as the partition, so a step doesn't pay for starting threads. The partition is recomputed only when the
+    // sparsity pattern changes; systems too small to split, or whose blocks turn
+    // out singular, are handed to a sparse LU of the whole matrix.
+    class PartitionedSolver : public LinearSolver {
+        struct Domain {
+            std::vector<int> rows;                  // Global rows of the interior, in local order
+            std::vector<Eigen::Triplet<double>> interiorTriplets, couplingTriplets, borderTriplets;
+            SparseMatrix interior;                  // A_dd
+            SparseMatrix coupling;                  // A_dS
+            SparseMatrix border;                    // A_Sd
+            Eigen::SparseLU<SparseMatrix, Eigen::COLAMDOrdering<int>> lu;
+            bool analyzed = false;
+            bool factored = false;
+            Eigen::MatrixXd solvedCoupling;         // A_dd^-1 A_dS
+            Eigen::MatrixXd schurContribution;      // A_Sd A_dd^-1 A_dS
+            Eigen::VectorXd interiorSolution;       // A_dd^-1 b_d
+        };
+
+        PartitionSettings m_Settings;
+        PartitionStats m_PartitionStats;
+        SparsityPattern m_Pattern;
+        std::vector<std::unique_ptr<Domain>> m_Domains;
+        std::vector<int> m_Interface;               // Global rows of the interface, in local order
+        std::vector<int> m_DomainOf;                // Per global row: domain, or -1 for the interface
+        std::vector<int> m_LocalIndex;              // Per global row: index within its domain or the interface
+        Eigen::PartialPivLU<Eigen::MatrixXd> m_SchurLU;
+        SparseLUSolver m_Direct;
+        std::unique_ptr<ThreadPool> m_Pool;         // Kept across steps, sized by Partition()
+        bool m_Split = false;                       // The partition has at least two domains
+        bool m_UseDirect = true;                    // The last factorization went to m_Direct
+
+        void Partition(const SparseMatrix& A);
+        bool FactorDomains(const SparseMatrix& A);
+
+    protected:
+        bool DoFactorize(const SparseMatrix& A) override;
+        void DoSolve(const Eigen::VectorXd& b, Eigen::VectorXd& x) override;
+
+    public:
+        PartitionedSolver(const PartitionSettings& settings = PartitionSettings());
+
+        // Takes effect at the next Factorize(), which repartitions
+        void SetSettings(const PartitionSettings& settings);
+        const PartitionSettings& GetSettings() const { return m_Settings; }
+        const PartitionStats& GetPartitionStats() const { return m_PartitionStats; }
+
+        SolverType GetType() const override { return SolverType::Partitioned; }
+        const char* GetName() const override { return "Partitioned"; }
+        bool IsSparse() const override { return true; }
+    };
+}
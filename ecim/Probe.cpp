@@ -1,29 +1,30 @@
 #include "Probe.hpp"
 #include "Resistor.hpp"
 #include "VoltageSource.hpp"
+#include "NonlinearComponent.hpp"
 
 namespace ecim {
     Probe::Probe(Node* n) : m_Node(n), m_Component(nullptr) {}
     
-    Probe::Probe(Component* c) : m_Node(nullptr), m_Component(c) {}
+    Probe::Probe(Component* c) : m_Node(nullptr), m_Component(c) {
+        if (dynamic_cast<Resistor*>(c)) m_Kind = Kind::Resistor;
+        else if (dynamic_cast<VoltageSource*>(c)) m_Kind = Kind::VoltageSource;
+        else if (dynamic_cast<NonlinearComponent*>(c)) m_Kind = Kind::Nonlinear;
+    }
     
     double Probe::Voltage() const { 
         return m_Node ? m_Node->Voltage : 0.0; 
     }
     
     double Probe::Current() const {
-        if (!m_Component) return 0.0;
-        
-        // For resistors, use Ohm's law: I = (V1 - V2) / R
-        if (auto resistor = dynamic_cast<Resistor*>(m_Component)) {
-            return resistor->GetCurrent();
-        }
-        
-        // For voltage sources, the current is stored after solving
-        if (auto voltageSource = dynamic_cast<VoltageSource*>(m_Component)) {
-            return voltageSource->GetCurrent();
+        switch (m_Kind) {
+            // For resistors, use Ohm's law: I = (V1 - V2) / R
+            case Kind::Resistor: return static_cast<Resistor*>(m_Component)->GetCurrent();
+            // For voltage sources, the current is stored after solving
+            case Kind::VoltageSource: return static_cast<VoltageSource*>(m_Component)->GetCurrent();
+            // Nonlinear devices evaluate their linearization at the solved voltages
+            case Kind::Nonlinear: return static_cast<NonlinearComponent*>(m_Component)->GetCurrent();
+            default: return 0.0;
         }
-        
-        return 0.0;
     }
 }
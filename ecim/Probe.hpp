@@ -7,8 +7,12 @@ namespace ecim {
     class VoltageSource;
 
     class Probe {
+        // What the probed component is, resolved once so Current() needs no RTTI
+        enum class Kind { None, Resistor, VoltageSource, Nonlinear };
+
         Node* m_Node;
         Component* m_Component;
+        Kind m_Kind = Kind::None;
     public:
         Probe(Node* n);
         Probe(Component* c);
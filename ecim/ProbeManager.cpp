@@ -1,7 +1,15 @@
 #include "ProbeManager.hpp"
+#include <algorithm>
 #include <iomanip>
 
 namespace ecim {
+    namespace {
+        // Formats written through a shared per-stream writer instead of per probe
+        bool IsSinkFormat(ProbeOutputFormat format) {
+            return format == ProbeOutputFormat::WideCSV || format == ProbeOutputFormat::Binary;
+        }
+    }
+
     ProbeManager::~ProbeManager() {
         Clear();
     }
@@ -19,6 +27,12 @@ namespace ecim {
             return nullptr;
         }
         
+        if (config.continuous && config.stream && IsSinkFormat(config.format) &&
+            !AddSinkColumns(probe, config)) {
+            delete probe;
+            return nullptr;
+        }
+
         m_Probes.push_back(probe);
         m_Configs.push_back(config);
         m_HeaderWritten.push_back(false);  // CSV header not yet written
@@ -30,7 +44,7 @@ namespace ecim {
         for (size_t i = 0; i < m_Probes.size(); ++i) {
             const ProbeConfig& config = m_Configs[i];
             
-            if (!config.continuous || !config.stream) {
+            if (!config.continuous || !config.stream || IsSinkFormat(config.format)) {
                 continue;
             }
             
@@ -73,9 +87,57 @@ namespace ecim {
                         break;
                 }
                 
-                out << std::endl;
+                out << '\n';
             }
         }
+
+        for (auto& sink : m_Sinks) {
+            m_SinkValues.resize(sink.columns.size());
+            for (size_t k = 0; k < sink.columns.size(); k++) {
+                Probe* probe = sink.columns[k].first;
+                m_SinkValues[k] = sink.columns[k].second ? probe->Current() : probe->Voltage();
+            }
+            sink.writer->Append(time, m_SinkValues.data());
+        }
+    }
+
+    void ProbeManager::Flush() {
+        for (auto& sink : m_Sinks) sink.writer->Flush();
+        for (const auto& config : m_Configs) {
+            if (config.continuous && config.stream) config.stream->flush();
+        }
+    }
+
+    bool ProbeManager::AddSinkColumns(Probe* probe, const ProbeConfig& config) {
+        auto sink = std::find_if(m_Sinks.begin(), m_Sinks.end(),
+                                 [&](const ProbeSink& s) { return s.stream == config.stream; });
+        if (sink == m_Sinks.end()) {
+            std::unique_ptr<SampleWriter> writer;
+            if (config.format == ProbeOutputFormat::Binary) {
+                writer = std::make_unique<WaveformWriter>(*config.stream);
+            } else {
+                writer = std::make_unique<CSVTableWriter>(*config.stream);
+            }
+            m_Sinks.push_back({config.stream, config.format, std::move(writer), {}});
+            sink = m_Sinks.end() - 1;
+        }
+        if (sink->format != config.format || sink->writer->GetRowCount() > 0) return false;
+
+        // Same column names as the CSV header
+        const std::string prefix = config.label.empty() ? "" : config.label + "_";
+        const bool voltage = config.mode == ProbeMode::Voltage || (config.mode == ProbeMode::Both && config.node);
+        const bool current = config.mode == ProbeMode::Current || (config.mode == ProbeMode::Both && config.component);
+        // The writer refuses columns once it has written its header (a Flush() before
+        // the first sample does that too); both calls then fail alike
+        if (voltage) {
+            if (!sink->writer->AddColumn(prefix + "voltage", "V")) return false;
+            sink->columns.push_back({probe, false});
+        }
+        if (current) {
+            if (!sink->writer->AddColumn(prefix + "current", "A")) return false;
+            sink->columns.push_back({probe, true});
+        }
+        return true;
     }
 
     const std::vector<Probe*>& ProbeManager::GetProbes() const {
@@ -86,6 +148,7 @@ namespace ecim {
         for (auto probe : m_Probes) {
             delete probe;
         }
+        m_Sinks.clear();            // Unflushed samples are dropped; the streams may be gone by now
         m_Probes.clear();
         m_Configs.clear();
         m_HeaderWritten.clear();
@@ -133,7 +196,7 @@ namespace ecim {
                 break;
         }
         
-        out << std::endl;
+        out << '\n';
     }
 
     void ProbeManager::WriteCSVData(size_t probeIndex, Probe* probe, double time, std::ostream& out) {
@@ -165,6 +228,6 @@ namespace ecim {
                 break;
         }
         
-        out << std::endl;
+        out << '\n';
     }
 }
@@ -1,7 +1,10 @@
 #pragma once
 #include "Probe.hpp"
+#include "WaveformFile.hpp"
+#include "CSVTableWriter.hpp"
 #include <vector>
 #include <string>
+#include <memory>
 #include <ostream>
 #include <iostream>
 
@@ -14,13 +17,19 @@ namespace ecim {
 
     enum class ProbeOutputFormat {
         Standard,   // Human-readable format: "t=0.001s [Label] V=5.0V"
-        CSV         // CSV format: "0.001,5.0"
+        CSV,        // CSV format: "0.001,5.0"
+        WideCSV,    // One CSV table per stream (CSVTableWriter): a shared time column and a
+                    // column for every WideCSV probe on the stream, one row per step
+        Binary      // Raw doubles in a waveform file (WaveformWriter): every Binary probe on a
+                    // stream is one column of it. The stream must be opened in binary mode.
+                    // WideCSV and Binary samples are buffered, so the stream must stay open
+                    // until Flush() (which ends every Simulate run) has written the rest.
     };
 
     struct ProbeConfig {
         ProbeMode mode = ProbeMode::Voltage;
         bool continuous = false;              // Enable continuous streaming
-        std::ostream* stream = &std::cout;    // Output stream (default: stdout)
+        std::ostream* stream = &std::cout;    // Output stream (default: stdout), see Binary for its lifetime
         Node* node = nullptr;                 // Node to probe (for voltage)
         Component* component = nullptr;       // Component to probe (for current)
         std::string label = "";               // Optional label for output
@@ -32,19 +41,35 @@ namespace ecim {
         std::vector<ProbeConfig> m_Configs;
         std::vector<bool> m_HeaderWritten;  // Track if CSV header has been written
 
+        // WideCSV and Binary probes, one writer per stream
+        struct ProbeSink {
+            std::ostream* stream;
+            ProbeOutputFormat format;
+            std::unique_ptr<SampleWriter> writer;
+            std::vector<std::pair<Probe*, bool>> columns;   // Probe, and whether the column is its current
+        };
+        std::vector<ProbeSink> m_Sinks;
+        std::vector<double> m_SinkValues;
+
     public:
         ~ProbeManager();
         
-        // Add a probe with configuration
+        // Add a probe with configuration. Returns nullptr without a node or component,
+        // or for a WideCSV or Binary probe on a stream that already holds samples or
+        // that is shared with probes of the other of these two formats.
         Probe* AddProbe(const ProbeConfig& config);
         
         // Update all continuous probes (call this at each simulation step)
         void UpdateContinuousProbes(double time);
+
+        // Write out buffered samples and flush the probe streams. Text output isn't
+        // flushed per line; CircuitBuilder calls this at the end of every run.
+        void Flush();
         
         // Get all probes
         const std::vector<Probe*>& GetProbes() const;
         
-        // Clear all probes
+        // Clear all probes. Buffered WideCSV and Binary samples that weren't flushed are dropped.
         void Clear();
         
     private:
@@ -53,5 +78,8 @@ namespace ecim {
         
         // Write CSV data row for a probe
         void WriteCSVData(size_t probeIndex, Probe* probe, double time, std::ostream& out);
+
+        // Add the columns of a WideCSV or Binary probe to the writer of its stream
+        bool AddSinkColumns(Probe* probe, const ProbeConfig& config);
     };
 }
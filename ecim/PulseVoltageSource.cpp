@@ -0,0 +1,42 @@
+#include "PulseVoltageSource.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ecim {
+    PulseVoltageSource::PulseVoltageSource(double v1, double v2, double delay, double rise, double fall,
+                                           double width, double period)
+        : m_V1(v1), m_V2(v2), m_Delay(delay), m_Rise(std::max(rise, 0.0)), m_Fall(std::max(fall, 0.0)),
+          m_Width(std::max(width, 0.0)), m_Period(period) {
+        // A period shorter than one pulse would overlap the pulses, treat it as single
+        if (m_Period < m_Rise + m_Width + m_Fall) m_Period = 0.0;
+    }
+
+    double PulseVoltageSource::GetVoltage(double time) const {
+        if (time < m_Delay) return m_V1;
+        double t = time - m_Delay;
+        if (m_Period > 0.0) t -= std::floor(t / m_Period) * m_Period;
+
+        if (t < m_Rise) return m_V1 + (m_V2 - m_V1) * t / m_Rise;
+        t -= m_Rise;
+        if (t < m_Width) return m_V2;
+        t -= m_Width;
+        if (t < m_Fall) return m_V2 + (m_V1 - m_V2) * t / m_Fall;
+        return m_V1;
+    }
+
+    double PulseVoltageSource::GetNextBreakpoint(double time) const {
+        if (time < m_Delay) return m_Delay;
+
+        // Corners of the pulse containing time, else those of the next pulse
+        double start = m_Delay;
+        if (m_Period > 0.0) start += std::floor((time - m_Delay) / m_Period) * m_Period;
+        const double corners[4] = {0.0, m_Rise, m_Rise + m_Width, m_Rise + m_Width + m_Fall};
+        for (int pulse = 0; pulse < (m_Period > 0.0 ? 2 : 1); pulse++) {
+            for (double offset : corners) {
+                if (start + offset > time) return start + offset;
+            }
+            start += m_Period;
+        }
+        return INFINITY;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "VoltageSource.hpp"
+
+namespace ecim {
+    // Pulse Voltage Source - trapezoidal pulse train as in SPICE PULSE(V1 V2 TD TR TF PW PER)
+    // Starts at v1, after delay ramps to v2 over rise, holds for width, ramps back over fall
+    // and repeats every period (0 = a single pulse). A zero rise/fall is an ideal edge.
+    class PulseVoltageSource : public VoltageSource {
+    private:
+        double m_V1;         // Initial (low) voltage
+        double m_V2;         // Pulsed (high) voltage
+        double m_Delay;      // Time of the first rising edge
+        double m_Rise;
+        double m_Fall;
+        double m_Width;      // Time spent at v2
+        double m_Period;
+
+    public:
+        PulseVoltageSource(double v1, double v2, double delay, double rise, double fall,
+                           double width, double period = 0.0);
+        double GetVoltage(double time) const override;
+        double GetNextBreakpoint(double time) const override;
+        Component* Clone() const override { return new PulseVoltageSource(*this); }
+
+        double GetV1() const { return m_V1; }
+        double GetV2() const { return m_V2; }
+        double GetDelay() const { return m_Delay; }
+        double GetRise() const { return m_Rise; }
+        double GetFall() const { return m_Fall; }
+        double GetWidth() const { return m_Width; }
+        double GetPeriod() const { return m_Period; }
+    };
+
+    template <> struct ArenaSkipsDestructor<PulseVoltageSource> : std::true_type {};
+}
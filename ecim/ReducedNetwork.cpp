@@ -0,0 +1,142 @@
+#include "ReducedNetwork.hpp"
+#include <algorithm>
+
+namespace ecim {
+    ReducedNetwork::ReducedNetwork(int ports, const Eigen::MatrixXd& G, const Eigen::MatrixXd& C)
+        : m_G(G), m_C(C), m_PortCount(ports), m_Ports(ports, nullptr), m_History(G.rows()) {}
+
+    // With x' = alpha * x - beta for every port voltage and state, the model becomes
+    // (G + alpha C) [v; z] = [i; 0] + C beta. Eliminating z leaves i = Y v + I_hist.
+    void ReducedNetwork::Prepare(double alpha) {
+        const int p = m_PortCount;
+        const int q = GetStateCount();
+        Eigen::MatrixXd K = m_G + alpha * m_C;
+
+        m_Admittance = K.topLeftCorner(p, p);
+        if (q > 0) {
+            m_StateLU.compute(K.bottomRightCorner(q, q));
+            m_StateCoupling = m_StateLU.solve(K.bottomLeftCorner(q, p));
+            m_Admittance -= K.topRightCorner(p, q) * m_StateCoupling;
+        }
+        m_Alpha = alpha;
+        m_Prepared = true;
+    }
+
+    void ReducedNetwork::Stamp(SimulationState &state) {
+        if (state.dt <= 0.0) return;
+
+        m_Method = state.method;
+        m_StepDt = state.dt;
+        const int size = static_cast<int>(m_History.size());
+        m_Beta.resize(size);
+        double alpha = 0.0;
+        for (int k = 0; k < size; k++) m_History[k].Companion(state.dt, state.method, alpha, m_Beta(k));
+        if (!m_Prepared || alpha != m_Alpha) Prepare(alpha);
+
+        // I_hist = K_vz K_zz^-1 (C beta)_z - (C beta)_v
+        const int p = m_PortCount;
+        const int q = GetStateCount();
+        m_HistoryTerm = m_C * m_Beta;
+        m_HistoryCurrent = -m_HistoryTerm.head(p);
+        if (q > 0) {
+            Eigen::MatrixXd K = m_G.topRightCorner(p, q) + alpha * m_C.topRightCorner(p, q);
+            m_HistoryCurrent += K * m_StateLU.solve(m_HistoryTerm.tail(q));
+        }
+
+        for (int a = 0; a < p; a++) {
+            int i = m_Ports[a] ? m_Ports[a]->Index : -1;
+            if (i < 0) continue;
+            for (int b = 0; b < p; b++) {
+                int j = m_Ports[b] ? m_Ports[b]->Index : -1;
+                if (j >= 0) state.StampG(i, j, m_Admittance(a, b));
+            }
+            state.I(i) -= m_HistoryCurrent(a);
+        }
+    }
+
+    Eigen::VectorXd ReducedNetwork::GetPortVoltages() const {
+        Eigen::VectorXd voltages(m_PortCount);
+        for (int k = 0; k < m_PortCount; k++) voltages(k) = m_Ports[k] ? m_Ports[k]->Voltage : 0.0;
+        return voltages;
+    }
+
+    Eigen::VectorXd ReducedNetwork::GetSolvedStates() const {
+        const int p = m_PortCount;
+        const int q = GetStateCount();
+        Eigen::VectorXd x(p + q);
+        x.head(p) = GetPortVoltages();
+        if (q > 0) x.tail(q) = m_StateLU.solve(m_HistoryTerm.tail(q)) - m_StateCoupling * x.head(p);
+        return x;
+    }
+
+    void ReducedNetwork::UpdateState() {
+        if (m_StepDt <= 0.0 || !m_Prepared) return;
+
+        Eigen::VectorXd x = GetSolvedStates();
+        for (size_t k = 0; k < m_History.size(); k++) {
+            m_History[k].Accept(x(k), m_StepDt, m_Alpha * x(k) - m_Beta(k));
+        }
+    }
+
+    double ReducedNetwork::GetPortCurrent(int port) const {
+        if (!m_Prepared || m_HistoryCurrent.size() != m_PortCount) return 0.0;
+        return m_Admittance.row(port).dot(GetPortVoltages()) + m_HistoryCurrent(port);
+    }
+
+    void ReducedNetwork::StampOperatingPoint(SimulationState &state) {
+        const int p = m_PortCount;
+        const int q = GetStateCount();
+        Eigen::MatrixXd admittance = m_G.topLeftCorner(p, p);
+        if (q > 0) {
+            Eigen::PartialPivLU<Eigen::MatrixXd> lu(m_G.bottomRightCorner(q, q));
+            admittance -= m_G.topRightCorner(p, q) * lu.solve(m_G.bottomLeftCorner(q, p));
+        }
+
+        for (int a = 0; a < p; a++) {
+            int i = m_Ports[a] ? m_Ports[a]->Index : -1;
+            if (i < 0) continue;
+            for (int b = 0; b < p; b++) {
+                int j = m_Ports[b] ? m_Ports[b]->Index : -1;
+                if (j >= 0) state.StampG(i, j, admittance(a, b));
+            }
+        }
+    }
+
+    void ReducedNetwork::SaveState(double* values) const {
+        for (size_t k = 0; k < m_History.size(); k++) m_History[k].Save(values + k * IntegrationHistory::StateSize);
+    }
+
+    void ReducedNetwork::RestoreState(const double* values) {
+        for (size_t k = 0; k < m_History.size(); k++) m_History[k].Restore(values + k * IntegrationHistory::StateSize);
+    }
+
+    void ReducedNetwork::SetInitialState() {
+        const int p = m_PortCount;
+        const int q = GetStateCount();
+        Eigen::VectorXd x(p + q);
+        x.head(p) = GetPortVoltages();
+        if (q > 0) {
+            Eigen::PartialPivLU<Eigen::MatrixXd> lu(m_G.bottomRightCorner(q, q));
+            x.tail(q) = -lu.solve(m_G.bottomLeftCorner(q, p) * x.head(p));
+        }
+        for (size_t k = 0; k < m_History.size(); k++) m_History[k].Reset(x(k));
+    }
+
+    double ReducedNetwork::GetCompanionAlpha(double dt, IntegrationMethod method) const {
+        if (m_History.empty()) return 0.0;
+        double alpha, beta;
+        m_History[0].Companion(dt, method, alpha, beta);
+        return alpha;
+    }
+
+    double ReducedNetwork::EstimateError(double relTol, double absTol) const {
+        if (m_StepDt <= 0.0 || !m_Prepared) return 0.0;
+
+        Eigen::VectorXd x = GetSolvedStates();
+        double ratio = 0.0;
+        for (size_t k = 0; k < m_History.size(); k++) {
+            ratio = std::max(ratio, m_History[k].EstimateError(x(k), m_StepDt, m_Method, relTol, absTol));
+        }
+        return ratio;
+    }
+}
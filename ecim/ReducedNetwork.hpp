@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "Component.hpp"
+
+namespace ecim {
+    // Multi-port linear macro-model, e.g. an interconnect network reduced by
+    // InterconnectNetwork::Reduce(). The model is
+    //
+    //     G [v; z] + C d/dt [v; z] = [i; 0]
+    //
+    // with v the port voltages, i the currents flowing into the ports and z the
+    // reduced internal states. Each step the integration method turns it into a
+    // companion model; z is eliminated so only a dense port admittance and a
+    // history current are stamped, and no extra MNA rows are needed. The ports
+    // are connected with CircuitBuilder::AddComponent(component, ports).
+    class ReducedNetwork : public Component {
+        Eigen::MatrixXd m_G, m_C;                   // (ports + states) square, ports first
+        int m_PortCount = 0;
+        std::vector<Node*> m_Ports;
+        std::vector<IntegrationHistory> m_History;  // One per port voltage and state
+
+        // Companion model of the step being solved, rebuilt when alpha changes
+        IntegrationMethod m_Method = IntegrationMethod::BackwardEuler;
+        double m_StepDt = 0.0;
+        double m_Alpha = 0.0;
+        Eigen::VectorXd m_Beta;
+        Eigen::VectorXd m_HistoryTerm;              // C * beta
+        Eigen::PartialPivLU<Eigen::MatrixXd> m_StateLU;   // K_zz with K = G + alpha C
+        Eigen::MatrixXd m_StateCoupling;            // K_zz^-1 K_zv
+        Eigen::MatrixXd m_Admittance;               // K_vv - K_vz K_zz^-1 K_zv
+        Eigen::VectorXd m_HistoryCurrent;           // Port currents at zero port voltage
+        bool m_Prepared = false;
+
+        void Prepare(double alpha);
+        Eigen::VectorXd GetPortVoltages() const;
+        Eigen::VectorXd GetSolvedStates() const;    // [v; z] of the step being solved
+
+    public:
+        // G and C are (ports + states) square with the port rows first
+        ReducedNetwork(int ports, const Eigen::MatrixXd& G, const Eigen::MatrixXd& C);
+
+        void Stamp(SimulationState &state) override;
+        Component* Clone() const override { return new ReducedNetwork(*this); }
+        void UpdateState();
+        size_t GetStateSize() const override { return m_History.size() * IntegrationHistory::StateSize; }
+        void SaveState(double* values) const override;
+        void RestoreState(const double* values) override;
+
+        size_t GetPortCount() const override { return m_Ports.size(); }
+        Node* GetPort(size_t index) const override { return m_Ports[index]; }
+        void SetPort(size_t index, Node* node) override { m_Ports[index] = node; }
+
+        int GetStateCount() const { return static_cast<int>(m_G.rows()) - m_PortCount; }
+        const Eigen::MatrixXd& GetConductanceMatrix() const { return m_G; }
+        const Eigen::MatrixXd& GetCapacitanceMatrix() const { return m_C; }
+
+        // Current flowing into a port at the solved voltages
+        double GetPortCurrent(int port) const;
+
+        // DC operating point: capacitances open, the states eliminated
+        void StampOperatingPoint(SimulationState &state);
+
+        // Start the next transient from the DC state at the present port voltages
+        void SetInitialState();
+
+        // Changes whenever the companion admittance does (it is alpha of the integration formula)
+        double GetCompanionAlpha(double dt, IntegrationMethod method) const;
+
+        // Local truncation error of the step just solved over all port voltages and
+        // states, relative to relTol * |x| + absTol
+        double EstimateError(double relTol, double absTol) const;
+    };
+}
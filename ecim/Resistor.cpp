@@ -6,18 +6,18 @@ namespace ecim {
     void Resistor::Stamp(SimulationState &state) {
         double G_val = 1.0 / m_Resistance;
 
-        // Skip ground node (node ID 0)
-        int i = (m_Node1 && m_Node1->Id > 0) ? m_Node1->Id - 1 : -1;
-        int j = (m_Node2 && m_Node2->Id > 0) ? m_Node2->Id - 1 : -1;
+        // Skip ground node (index -1)
+        int i = m_Node1 ? m_Node1->Index : -1;
+        int j = m_Node2 ? m_Node2->Index : -1;
 
         // Diagonal contributions
-        if (i >= 0) state.G(i, i) += G_val;
-        if (j >= 0) state.G(j, j) += G_val;
+        if (i >= 0) state.StampG(i, i, G_val);
+        if (j >= 0) state.StampG(j, j, G_val);
 
         // Off-diagonal contributions
         if (i >= 0 && j >= 0) {
-            state.G(i, j) -= G_val;
-            state.G(j, i) -= G_val;
+            state.StampG(i, j, -G_val);
+            state.StampG(j, i, -G_val);
         }
 
         // No current source contribution for resistors
@@ -9,6 +9,12 @@ namespace ecim {
     public:
         Resistor(double resistance);
         void Stamp(SimulationState &state) override;
+        Component* Clone() const override { return new Resistor(*this); }
         double GetCurrent() const;
+
+        double GetResistance() const { return m_Resistance; }
+        void SetResistance(double resistance) { m_Resistance = resistance; }
     };
+
+    template <> struct ArenaSkipsDestructor<Resistor> : std::true_type {};
 }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ecim {
+    // Destination of rows of samples that share one time column, e.g. all the
+    // probes writing to one stream. Columns are fixed before the first row.
+    class SampleWriter {
+    public:
+        virtual ~SampleWriter() {}
+
+        // Returns false once rows have been added
+        virtual bool AddColumn(const std::string& label, const std::string& unit) = 0;
+        // One value per column
+        virtual void Append(double time, const double* values) = 0;
+        // Write out buffered rows and flush the stream
+        virtual void Flush() = 0;
+        virtual size_t GetRowCount() const = 0;
+    };
+}
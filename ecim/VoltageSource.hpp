@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.hpp"
+#include <cmath>
 
 namespace ecim {
     // Abstract base class for all voltage sources
@@ -13,9 +14,24 @@ namespace ecim {
         
         // Get the voltage at a specific time
         virtual double GetVoltage(double time) const = 0;
+
+        // First time after the given one at which the waveform has a corner or a jump,
+        // INFINITY if there is none. Simulate() and SimulateAdaptive() land steps on them.
+        virtual double GetNextBreakpoint(double time) const { return INFINITY; }
+
+        // Voltages at start, start + step, ... (count samples) into values. Used by
+        // Simulate() to evaluate the sources of many upcoming steps in one call; the
+        // default samples GetVoltage() one by one.
+        virtual void EvaluateBlock(double start, double step, int count, double* values) const;
         
         void Stamp(SimulationState &state) override;
+        // Stamp with an already evaluated source voltage
+        void StampValue(SimulationState &state, double voltage);
         void SetCurrent(double current);
         double GetCurrent() const;
+
+        size_t GetStateSize() const override { return 1; }
+        void SaveState(double* values) const override { values[0] = m_Current; }
+        void RestoreState(const double* values) override { m_Current = values[0]; }
     };
 }
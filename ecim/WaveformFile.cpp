@@ -0,0 +1,169 @@
+#include "WaveformFile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace ecim {
+    namespace {
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;     // ByteOrderMark as the writer stored it
+            uint32_t columnCount;   // Without the time column
+            uint32_t headerSize;    // Including the column names, multiple of 8
+        };
+
+        const char Magic[8] = {'E', 'C', 'I', 'M', 'W', 'A', 'V', 'E'};
+        const uint32_t ByteOrderMark = 0x01020304;
+
+        void AppendString(std::vector<char>& bytes, const std::string& text) {
+            const uint32_t length = static_cast<uint32_t>(text.size());
+            const char* raw = reinterpret_cast<const char*>(&length);
+            bytes.insert(bytes.end(), raw, raw + sizeof(length));
+            bytes.insert(bytes.end(), text.begin(), text.end());
+        }
+
+        bool ReadString(const char* data, size_t size, size_t& offset, std::string& text) {
+            uint32_t length;
+            if (size - offset < sizeof(length)) return false;
+            std::memcpy(&length, data + offset, sizeof(length));
+            offset += sizeof(length);
+            if (size - offset < length) return false;
+            text.assign(data + offset, length);
+            offset += length;
+            return true;
+        }
+    }
+
+    WaveformWriter::WaveformWriter(std::ostream& out, size_t blockRows)
+        : m_Out(out), m_BlockRows(std::max<size_t>(blockRows, 1)) {}
+
+    bool WaveformWriter::AddColumn(const std::string& label, const std::string& unit) {
+        if (m_HeaderWritten || m_Rows > 0) return false;
+        m_Labels.push_back(label);
+        m_Units.push_back(unit);
+        return true;
+    }
+
+    void WaveformWriter::WriteHeader() {
+        std::vector<char> names;
+        for (size_t k = 0; k < m_Labels.size(); k++) {
+            AppendString(names, m_Labels[k]);
+            AppendString(names, m_Units[k]);
+        }
+        names.resize((sizeof(Header) + names.size() + 7) / 8 * 8 - sizeof(Header), 0);
+
+        Header header = {};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.byteOrder = ByteOrderMark;
+        header.columnCount = static_cast<uint32_t>(m_Labels.size());
+        header.headerSize = static_cast<uint32_t>(sizeof(Header) + names.size());
+        m_Out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_Out.write(names.data(), names.size());
+        m_HeaderWritten = true;
+    }
+
+    void WaveformWriter::Append(double time, const double* values) {
+        const size_t columns = m_Labels.size() + 1;
+        if (m_Block.size() != columns * m_BlockRows) m_Block.resize(columns * m_BlockRows);
+
+        m_Block[m_Rows] = time;
+        for (size_t k = 1; k < columns; k++) m_Block[k * m_BlockRows + m_Rows] = values[k - 1];
+        m_Rows++;
+        m_TotalRows++;
+        if (m_Rows == m_BlockRows) Flush();
+    }
+
+    void WaveformWriter::Flush() {
+        if (m_HeaderWritten && m_Rows == 0) return;
+        if (!m_HeaderWritten) WriteHeader();
+        if (m_Rows > 0) {
+            // Columns are written back to back; a full block is one contiguous write
+            const uint64_t rows = m_Rows;
+            m_Out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+            const size_t columns = m_Labels.size() + 1;
+            if (m_Rows == m_BlockRows) {
+                m_Out.write(reinterpret_cast<const char*>(m_Block.data()), columns * m_Rows * sizeof(double));
+            } else {
+                for (size_t k = 0; k < columns; k++) {
+                    m_Out.write(reinterpret_cast<const char*>(&m_Block[k * m_BlockRows]), m_Rows * sizeof(double));
+                }
+            }
+            m_Rows = 0;
+        }
+        m_Out.flush();
+    }
+
+    bool WaveformReader::Fail(const std::string& message) {
+        m_Error = message;
+        return false;
+    }
+
+    bool WaveformReader::Open(const std::string& path) {
+        m_Labels.clear();
+        m_Units.clear();
+        m_Blocks.clear();
+        m_BlockStart.clear();
+        m_Rows = 0;
+        m_Error.clear();
+
+        if (!m_File.Open(path)) return Fail("Cannot read " + path);
+        const char* data = m_File.GetData();
+        const size_t size = m_File.GetSize();
+        Header header;
+        if (size < sizeof(Header)) return Fail("Not a waveform file");
+        std::memcpy(&header, data, sizeof(Header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return Fail("Not a waveform file");
+        if (header.byteOrder != ByteOrderMark) return Fail("Waveform file was written with the other byte order");
+        if (header.version != WaveformWriter::Version) return Fail("Unsupported waveform version " + std::to_string(header.version));
+        if (header.headerSize % 8 != 0 || header.headerSize > size || header.headerSize < sizeof(Header)) {
+            return Fail("Waveform header is damaged");
+        }
+        // Every column takes at least its two name lengths; bounds the allocation below
+        if (header.columnCount > (header.headerSize - sizeof(Header)) / 8) return Fail("Waveform header is damaged");
+
+        size_t offset = sizeof(Header);
+        m_Labels.resize(header.columnCount);
+        m_Units.resize(header.columnCount);
+        for (size_t k = 0; k < header.columnCount; k++) {
+            if (!ReadString(data, header.headerSize, offset, m_Labels[k]) ||
+                !ReadString(data, header.headerSize, offset, m_Units[k])) {
+                m_Labels.clear();
+                m_Units.clear();
+                return Fail("Waveform header is damaged");
+            }
+        }
+
+        // Complete blocks only; the mapping is page aligned and blocks keep 8-byte alignment
+        const size_t columns = header.columnCount + 1;
+        offset = header.headerSize;
+        while (size - offset >= sizeof(uint64_t)) {
+            uint64_t rows;
+            std::memcpy(&rows, data + offset, sizeof(rows));
+            const size_t available = (size - offset - sizeof(rows)) / sizeof(double);
+            if (rows == 0 || rows > available / columns) break;
+            m_BlockStart.push_back(m_Rows);
+            m_Blocks.push_back({reinterpret_cast<const double*>(data + offset + sizeof(rows)), static_cast<size_t>(rows)});
+            m_Rows += rows;
+            offset += sizeof(rows) + rows * columns * sizeof(double);
+        }
+        return true;
+    }
+
+    std::vector<double> WaveformReader::Gather(size_t column) const {
+        std::vector<double> values;
+        values.reserve(m_Rows);
+        for (const Block& block : m_Blocks) {
+            const double* first = block.data + column * block.rows;
+            values.insert(values.end(), first, first + block.rows);
+        }
+        return values;
+    }
+
+    double WaveformReader::Sample(size_t row, size_t column) const {
+        const size_t index = std::upper_bound(m_BlockStart.begin(), m_BlockStart.end(), row) - m_BlockStart.begin() - 1;
+        const Block& block = m_Blocks[index];
+        return block.data[column * block.rows + (row - m_BlockStart[index])];
+    }
+}
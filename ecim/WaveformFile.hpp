@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "SampleWriter.hpp"
+
+namespace ecim {
+    // Binary waveform file: a header naming the columns (label and unit), then
+    // blocks of samples. Each block holds a row count and then, column by column,
+    // that many raw doubles: the time column first, then one column per signal.
+    // Blocks are only ever appended, so a reader sees every complete block of a
+    // file that is still being written.
+    //
+    //     header   "ECIMWAVE", version, byte-order mark, column count, header size,
+    //              then per column: label length, label, unit length, unit (8-byte padded)
+    //     block    uint64 rows, rows x time, rows x column 0, rows x column 1, ...
+    //
+    // Values are in the machine's byte order; a reader with the other one rejects the file.
+    class WaveformWriter : public SampleWriter {
+        std::ostream& m_Out;
+        std::vector<std::string> m_Labels;
+        std::vector<std::string> m_Units;
+        size_t m_BlockRows;
+        std::vector<double> m_Block;        // Column-major, m_BlockRows per column
+        size_t m_Rows = 0;                  // Rows in m_Block
+        size_t m_TotalRows = 0;
+        bool m_HeaderWritten = false;
+
+        void WriteHeader();
+
+    public:
+        static const unsigned Version = 1;
+
+        // out must be opened in binary mode and outlive the writer. Samples are
+        // buffered and written blockRows rows at a time; the destructor doesn't
+        // write, so rows (and a header) that weren't flushed are dropped.
+        WaveformWriter(std::ostream& out, size_t blockRows = 4096);
+
+        // Columns are fixed once the first sample is added; returns false afterwards
+        bool AddColumn(const std::string& label, const std::string& unit) override;
+        size_t GetColumnCount() const { return m_Labels.size(); }
+
+        // One value per column
+        void Append(double time, const double* values) override;
+        // Write the buffered rows as a block (the header on first use) and flush the stream
+        void Flush() override;
+
+        size_t GetRowCount() const override { return m_TotalRows; }
+    };
+
+    // Reads a waveform file through a memory mapping. Open() again to pick up
+    // blocks written since; a partly written last block is left out.
+    class WaveformReader {
+        struct Block {
+            const double* data;             // Time column, then the others
+            size_t rows;
+        };
+
+        MappedFile m_File;
+        std::vector<std::string> m_Labels;
+        std::vector<std::string> m_Units;
+        std::vector<Block> m_Blocks;
+        std::vector<size_t> m_BlockStart;   // First row of every block
+        size_t m_Rows = 0;
+        std::string m_Error;
+
+        bool Fail(const std::string& message);
+        // Column 0 is the time
+        std::vector<double> Gather(size_t column) const;
+        double Sample(size_t row, size_t column) const;
+
+    public:
+        bool Open(const std::string& path);
+
+        size_t GetColumnCount() const { return m_Labels.size(); }
+        const std::string& GetLabel(size_t column) const { return m_Labels[column]; }
+        const std::string& GetUnit(size_t column) const { return m_Units[column]; }
+        size_t GetRowCount() const { return m_Rows; }
+
+        std::vector<double> GetTimes() const { return Gather(0); }
+        std::vector<double> GetColumn(size_t column) const { return Gather(column + 1); }
+        double GetTime(size_t row) const { return Sample(row, 0); }
+        double GetValue(size_t row, size_t column) const { return Sample(row, column + 1); }
+
+        const std::string& GetError() const { return m_Error; }
+    };
+}
@@ -1,14 +1,36 @@
 #pragma once
 
 #include "Node.hpp"
+#include "Arena.hpp"
+#include "Integration.hpp"
 #include "Component.hpp"
+#include "ComponentArrays.hpp"
 #include "VoltageSource.hpp"
 #include "DCVoltageSource.hpp"
 #include "ACVoltageSource.hpp"
 #include "CustomVoltageSource.hpp"
+#include "PulseVoltageSource.hpp"
+#include "PWLVoltageSource.hpp"
 #include "Resistor.hpp"
 #include "Capacitor.hpp"
 #include "Inductor.hpp"
+#include "NonlinearComponent.hpp"
+#include "Diode.hpp"
+#include "Mosfet.hpp"
+#include "ReducedNetwork.hpp"
+#include "InterconnectNetwork.hpp"
+#include "LinearSolver.hpp"
+#include "PartitionedSolver.hpp"
+#include "Checkpoint.hpp"
 #include "CircuitBuilder.hpp"
+#include "NetlistLoader.hpp"
+#include "CircuitSnapshot.hpp"
+#include "EnsembleSimulator.hpp"
+#include "GraphPartition.hpp"
+#include "Parallel.hpp"
+#include "ParameterSweep.hpp"
+#include "ACAnalysis.hpp"
 #include "Probe.hpp"
 #include "ProbeManager.hpp"
+#include "WaveformFile.hpp"
+#include "CSVTableWriter.hpp"
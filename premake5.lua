@@ -57,6 +57,7 @@ project "ecim"
 
    filter "system:linux"
       pic "On"
+      links { "pthread" }
 
    filter "configurations:Debug"
       symbols "On"
@@ -97,6 +98,7 @@ project "ecim_tests"
 
    filter "system:linux"
       pic "On"
+      links { "pthread" }
 
    filter "configurations:Debug"
       symbols "On"
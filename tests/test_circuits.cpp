@@ -1,6 +1,15 @@
 #include "test_framework.hpp"
 #include "../ecim/ecim.hpp"
+#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace ecim;
 using namespace TestFramework;
@@ -237,4 +246,746 @@ void runCircuitTests(TestRunner& runner) {
         ckt.Step(0.6); // Now at t=1.1s
         r.assertEqual(node1->Voltage, 12.0, 1e-3, "After step, voltage should be 12V");
     });
+
+    // Test sparse engine on a simple voltage divider
+    runner.runTest("Circuit: Sparse solver voltage divider", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::SparseLU);
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        
+        DCVoltageSource* vs = new DCVoltageSource(5.0);
+        Resistor* r1 = new Resistor(2000.0);
+        Resistor* r2 = new Resistor(3000.0);
+        
+        ckt.AddComponent(vs, node1, gnd);
+        ckt.AddComponent(r1, node1, node2);
+        ckt.AddComponent(r2, node2, gnd);
+        
+        ckt.Step(1e-6);
+        
+        r.assertTrue(ckt.GetSolverType() == SolverType::SparseLU, "Solver type should be sparse");
+        r.assertEqual(node1->Voltage, 5.0, 1e-9, "Source node should be 5V");
+        r.assertEqual(node2->Voltage, 3.0, 1e-9, "Voltage divider should be 3V");
+        r.assertEqual(vs->GetCurrent(), -0.001, 1e-12, "Source current should be -1mA");
+    });
+
+    // Test sparse engine with several voltage sources
+    runner.runTest("Circuit: Sparse solver multiple voltage sources", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::SparseLU);
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        
+        DCVoltageSource* vs1 = new DCVoltageSource(10.0);
+        DCVoltageSource* vs2 = new DCVoltageSource(5.0);
+        Resistor* r1 = new Resistor(1000.0);
+        
+        ckt.AddComponent(vs1, node1, gnd);
+        ckt.AddComponent(vs2, node2, gnd);
+        ckt.AddComponent(r1, node1, node2);
+        
+        ckt.Step(1e-6);
+        
+        r.assertEqual(node1->Voltage, 10.0, 1e-9, "Node1 should be 10V");
+        r.assertEqual(node2->Voltage, 5.0, 1e-9, "Node2 should be 5V");
+        r.assertEqual(r1->GetCurrent(), 0.005, 1e-12, "Current should be 5mA");
+    });
+
+    // Test that sparse and dense engines produce the same transient on an RC ladder
+    runner.runTest("Circuit: Sparse and dense solvers agree on RC ladder", [](TestRunner& r) {
+        const int sections = 40;
+        
+        auto simulateLadder = [sections](SolverType type) {
+            CircuitBuilder ckt;
+            ckt.SetSolverType(type);
+            
+            Node* gnd = ckt.GetGround();
+            std::vector<Node*> nodes;
+            for (int k = 0; k <= sections; k++) nodes.push_back(ckt.CreateNode());
+            
+            ckt.AddComponent(new DCVoltageSource(1.0), nodes[0], gnd);
+            for (int k = 0; k < sections; k++) {
+                ckt.AddComponent(new Resistor(100.0), nodes[k], nodes[k + 1]);
+                ckt.AddComponent(new Capacitor(1e-6), nodes[k + 1], gnd);
+            }
+            ckt.AddComponent(new Inductor(1e-3), nodes[sections], gnd);
+            
+            ckt.Simulate(2e-4, 1e-5);
+            
+            std::vector<double> voltages;
+            for (auto node : nodes) voltages.push_back(node->Voltage);
+            return voltages;
+        };
+        
+        std::vector<double> dense = simulateLadder(SolverType::DenseQR);
+        std::vector<double> sparse = simulateLadder(SolverType::SparseLU);
+        
+        r.assertTrue(dense.size() == sparse.size(), "Both runs should have the same node count");
+        for (size_t k = 0; k < dense.size(); k++) {
+            r.assertEqual(sparse[k], dense[k], 1e-9, "Sparse and dense node voltages should match");
+        }
+    });
+
+    // Test sparse engine on a long resistor chain (too large to be comfortable for dense QR)
+    runner.runTest("Circuit: Sparse solver large resistor chain", [](TestRunner& r) {
+        const int count = 5000;
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::SparseLU);
+        
+        Node* gnd = new Node();
+        std::vector<Node*> nodes;
+        for (int k = 0; k < count; k++) nodes.push_back(new Node());
+        
+        // count equal resistors in series from the source down to ground
+        ckt.AddComponent(new DCVoltageSource(10.0), nodes[0], gnd);
+        for (int k = 0; k + 1 < count; k++) {
+            ckt.AddComponent(new Resistor(10.0), nodes[k], nodes[k + 1]);
+        }
+        ckt.AddComponent(new Resistor(10.0), nodes[count - 1], gnd);
+        
+        ckt.Step(1e-6);
+        
+        // Node k sits (count - k) resistors above ground
+        for (int k = 0; k < count; k += 499) {
+            double expected = 10.0 * (count - k) / count;
+            r.assertEqual(nodes[k]->Voltage, expected, 1e-9, "Chain node voltage should follow the divider ratio");
+        }
+    });
+
+    // Test explicit compile phase and recompilation after the topology changes
+    runner.runTest("Circuit: Compile and recompile after adding components", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        
+        ckt.AddComponent(new DCVoltageSource(6.0), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(new Resistor(2000.0), node2, gnd);
+        
+        r.assertFalse(ckt.IsCompiled(), "Circuit should not be compiled before Compile()");
+        ckt.Compile();
+        r.assertTrue(ckt.IsCompiled(), "Circuit should be compiled after Compile()");
+        
+        ckt.Step(1e-6);
+        r.assertEqual(node2->Voltage, 4.0, 1e-9, "Divider should be 4V");
+        
+        // Adding a parallel 2k resistor invalidates the plan: 1k over 1k gives 3V
+        ckt.AddComponent(new Resistor(2000.0), node2, gnd);
+        r.assertFalse(ckt.IsCompiled(), "Adding a component should invalidate the plan");
+        
+        ckt.Step(1e-6);
+        r.assertTrue(ckt.IsCompiled(), "Step should recompile automatically");
+        r.assertEqual(node2->Voltage, 3.0, 1e-9, "Divider should be 3V after recompiling");
+    });
+
+    // Test that unused node IDs don't leave empty rows in the system
+    runner.runTest("Circuit: Compact node indices with gaps in node IDs", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::SparseLU);
+        
+        Node* gnd = new Node();
+        Node* unused1 = new Node();  // Consumes an ID but never joins the circuit
+        Node* node1 = new Node();
+        Node* unused2 = new Node();
+        Node* node2 = new Node();
+        
+        ckt.AddComponent(new DCVoltageSource(9.0), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(new Resistor(2000.0), node2, gnd);
+        
+        ckt.Step(1e-6);
+        
+        r.assertTrue(node1->Index >= 0 && node1->Index < 2, "Node1 should get a compact index");
+        r.assertTrue(node2->Index >= 0 && node2->Index < 2, "Node2 should get a compact index");
+        r.assertTrue(gnd->Index == -1, "Ground should not get a row");
+        r.assertEqual(node2->Voltage, 6.0, 1e-9, "Divider should be 6V");
+        
+        delete unused1;
+        delete unused2;
+    });
+
+    // Test every linear solver backend against the reference dense QR solution
+    runner.runTest("Circuit: All solver backends agree on RLC ladder", [](TestRunner& r) {
+        const int sections = 30;
+        
+        auto simulateLadder = [sections](SolverType type, SolverStats& stats) {
+            CircuitBuilder ckt;
+            ckt.SetSolverType(type);
+            ckt.GetLinearSolver().SetComputeResidual(true);
+            
+            Node* gnd = ckt.GetGround();
+            std::vector<Node*> nodes;
+            for (int k = 0; k <= sections; k++) nodes.push_back(ckt.CreateNode());
+            
+            ckt.AddComponent(new ACVoltageSource(2.0, 1000.0), nodes[0], gnd);
+            for (int k = 0; k < sections; k++) {
+                if (k % 3 == 2) ckt.AddComponent(new Inductor(1e-3), nodes[k], nodes[k + 1]);
+                else ckt.AddComponent(new Resistor(50.0 + k), nodes[k], nodes[k + 1]);
+                ckt.AddComponent(new Capacitor(1e-7), nodes[k + 1], gnd);
+            }
+            ckt.AddComponent(new Resistor(1000.0), nodes[sections], gnd);
+            
+            ckt.Simulate(1e-4, 1e-6);
+            stats = ckt.GetLinearSolver().GetStats();
+            
+            std::vector<double> voltages;
+            for (auto node : nodes) voltages.push_back(node->Voltage);
+            return voltages;
+        };
+        
+        SolverStats referenceStats;
+        std::vector<double> reference = simulateLadder(SolverType::DenseQR, referenceStats);
+        
+        const SolverType types[] = { SolverType::DenseLU, SolverType::SparseLU,
+                                     SolverType::SparseCholesky, SolverType::Iterative,
+                                     SolverType::Partitioned };
+        for (SolverType type : types) {
+            SolverStats stats;
+            std::vector<double> voltages = simulateLadder(type, stats);
+            
+            r.assertTrue(stats.factorizations == 1, "Each backend should factor the fixed-step system once");
+            r.assertTrue(stats.solves == 100, "Each backend should solve once per step");
+            r.assertTrue(stats.residual < 1e-8, "Backend residual should be small");
+            r.assertTrue(stats.totalSolveSeconds >= 0.0, "Solve time should be reported");
+            for (size_t k = 0; k < reference.size(); k++) {
+                r.assertEqual(voltages[k], reference[k], 1e-7, "Backend should match the dense QR solution");
+            }
+        }
+    });
+
+    // Test that the sparse Cholesky backend falls back to LU on indefinite MNA systems
+    runner.runTest("Circuit: Sparse Cholesky backend with voltage sources", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::SparseCholesky);
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        
+        ckt.AddComponent(new DCVoltageSource(5.0), node1, gnd);
+        ckt.AddComponent(new Resistor(2000.0), node1, node2);
+        ckt.AddComponent(new Resistor(3000.0), node2, gnd);
+        
+        ckt.Step(1e-6);
+        
+        r.assertTrue(ckt.GetLinearSolver().GetType() == SolverType::SparseCholesky, "Backend should be sparse Cholesky");
+        r.assertEqual(node2->Voltage, 3.0, 1e-9, "Voltage divider should be 3V");
+    });
+
+    // Test that the Cholesky backend keeps solving with the LU fallback after its statistics are cleared
+    runner.runTest("Circuit: Sparse Cholesky fallback outlives the statistics", [](TestRunner& r) {
+        std::vector<Eigen::Triplet<double>> entries = {
+            {0, 0, 4.0}, {0, 1, 1.0}, {1, 0, -2.0}, {1, 1, 3.0}, {1, 2, 1.0}, {2, 1, 0.5}, {2, 2, 5.0}
+        };
+        SparseMatrix A(3, 3);
+        A.setFromTriplets(entries.begin(), entries.end());
+        A.makeCompressed();
+        Eigen::VectorXd b(3);
+        b << 1.0, 2.0, 3.0;
+        Eigen::VectorXd x;
+
+        SparseCholeskySolver solver;
+        r.assertTrue(solver.Factorize(A), "Unsymmetric matrix is factored by the fallback");
+        r.assertTrue(solver.GetStats().fallback, "Fallback is reported");
+
+        solver.ResetStats();
+        solver.Solve(b, x);
+        r.assertTrue((A * x - b).norm() < 1e-12, "Solve after ResetStats uses the fallback factors");
+        r.assertFalse(solver.GetStats().fallback, "Statistics were cleared");
+    });
+
+    // Test that the sparse LU backend re-analyzes a changed pattern of the same size
+    runner.runTest("Circuit: Sparse LU ordering follows the pattern", [](TestRunner& r) {
+        const int n = 8;
+        // Arrow matrices, dense in the first and in the last row and column
+        auto arrow = [n](int dense) {
+            std::vector<Eigen::Triplet<double>> entries;
+            for (int k = 0; k < n; k++) {
+                entries.emplace_back(k, k, 4.0 + k);
+                if (k != dense) {
+                    entries.emplace_back(k, dense, 1.0);
+                    entries.emplace_back(dense, k, 1.0);
+                }
+            }
+            SparseMatrix A(n, n);
+            A.setFromTriplets(entries.begin(), entries.end());
+            A.makeCompressed();
+            return A;
+        };
+        SparseMatrix first = arrow(0);
+        SparseMatrix last = arrow(n - 1);
+        Eigen::VectorXd b = Eigen::VectorXd::LinSpaced(n, 1.0, 2.0);
+        Eigen::VectorXd x;
+
+        SparseLUSolver solver;
+        solver.Factorize(first);
+        solver.Solve(b, x);
+        r.assertTrue((first * x - b).norm() < 1e-12, "First pattern is solved");
+        r.assertTrue(*solver.GetColumnOrdering() == *SparseLUSolver::ComputeColumnOrdering(first), "Ordering of the first pattern");
+
+        solver.Factorize(last);
+        solver.Solve(b, x);
+        r.assertTrue((last * x - b).norm() < 1e-12, "Second pattern is solved");
+        r.assertTrue(*solver.GetColumnOrdering() == *SparseLUSolver::ComputeColumnOrdering(last), "New pattern gets a new ordering");
+        r.assertFalse(*solver.GetColumnOrdering() == *SparseLUSolver::ComputeColumnOrdering(first), "Orderings differ");
+
+        // An adopted ordering is kept whatever the pattern
+        ColumnOrdering adopted = SparseLUSolver::ComputeColumnOrdering(first);
+        solver.SetColumnOrdering(adopted);
+        solver.Factorize(last);
+        solver.Solve(b, x);
+        r.assertTrue((last * x - b).norm() < 1e-12, "Adopted ordering solves another pattern");
+        r.assertTrue(solver.GetColumnOrdering() == adopted, "Adopted ordering is kept");
+    });
+
+    // Test AC analysis of an RC low-pass filter against its transfer function
+    runner.runTest("Circuit: AC analysis RC low-pass", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        ckt.AddComponent(new ACVoltageSource(1.0, 50.0), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+        
+        ACAnalysis ac(ckt);
+        int in = ac.AddProbe(node1);
+        int out = ac.AddProbe(node2);
+        int ground = ac.AddProbe(gnd);
+        ac.SetThreadCount(4);
+        auto points = ac.Sweep(1.0, 1e6, 2000);
+        
+        r.assertTrue(points.size() == 2000, "One result per frequency");
+        r.assertEqual(points.front().frequency, 1.0, 1e-12, "Sweep starts at the start frequency");
+        r.assertEqual(points.back().frequency, 1e6, 1e-6, "Sweep ends at the stop frequency");
+        
+        // H(jw) = 1 / (1 + jwRC)
+        const double PI = 3.14159265358979323846;
+        bool matches = true;
+        for (auto& point : points) {
+            std::complex<double> expected = 1.0 / std::complex<double>(1.0, 2.0 * PI * point.frequency * 1e-3);
+            if (std::abs(point.values[out] - expected) > 1e-9) matches = false;
+            if (std::abs(point.values[in] - 1.0) > 1e-9 || point.values[ground] != 0.0) matches = false;
+        }
+        r.assertTrue(matches, "Every point matches the transfer function");
+        
+        // Corner frequency: -3dB and -45 degrees
+        auto corner = ac.Run({1.0 / (2.0 * PI * 1e-3)});
+        r.assertEqual(corner[0].Magnitude(out), 1.0 / std::sqrt(2.0), 1e-9, "Magnitude at the corner");
+        r.assertEqual(corner[0].MagnitudeDb(out), -3.0103, 1e-4, "Magnitude in dB at the corner");
+        r.assertEqual(corner[0].Phase(out), -PI / 4.0, 1e-9, "Phase at the corner");
+    });
+
+    // Test AC analysis of a series RLC resonance, driven through an overridden DC source
+    runner.runTest("Circuit: AC analysis RLC resonance", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        Node* node3 = new Node();
+        DCVoltageSource* vs = new DCVoltageSource(5.0);
+        ckt.AddComponent(vs, node1, gnd);
+        ckt.AddComponent(new Resistor(10.0), node1, node2);
+        ckt.AddComponent(new Inductor(1e-3), node2, node3);
+        ckt.AddComponent(new Capacitor(1e-6), node3, gnd);
+        
+        ACAnalysis ac(ckt);
+        int out = ac.AddProbe(node2);   // Voltage across L + C
+        
+        auto silent = ac.Run({1000.0});
+        r.assertEqual(silent[0].Magnitude(out), 0.0, 1e-12, "DC sources are small-signal shorts");
+        
+        ac.SetExcitation(vs, 1.0);
+        const double PI = 3.14159265358979323846;
+        const double f0 = 1.0 / (2.0 * PI * std::sqrt(1e-3 * 1e-6));
+        auto points = ac.Run({f0, f0 / 10.0, f0 * 10.0});
+        r.assertEqual(points[0].Magnitude(out), 0.0, 1e-9, "LC branch is a short at resonance");
+        r.assertTrue(points[1].Magnitude(out) > 0.9, "Capacitor blocks below resonance");
+        r.assertTrue(points[2].Magnitude(out) > 0.9, "Inductor blocks above resonance");
+        
+        // Same results regardless of the thread count
+        ac.SetThreadCount(1);
+        auto serial = ac.Run({f0, f0 / 10.0, f0 * 10.0});
+        for (int k = 0; k < 3; k++) {
+            r.assertTrue(serial[k].values[out] == points[k].values[out], "Thread count doesn't change results");
+        }
+    });
+
+    // Test a forward-biased diode against the Shockley equation
+    runner.runTest("Circuit: Diode forward bias", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        Diode* diode = new Diode(1e-14);
+        ckt.AddComponent(new DCVoltageSource(5.0), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(diode, node2, gnd);
+        
+        r.assertTrue(ckt.SolveOperatingPoint(), "Operating point converges");
+        double vd = node2->Voltage;
+        double current = (5.0 - vd) / 1000.0;
+        r.assertTrue(vd > 0.6 && vd < 0.8, "Silicon diode drop");
+        r.assertEqual(diode->GetCurrent(), current, 1e-9, "Diode current matches the resistor current");
+        r.assertEqual(1e-14 * (std::exp(vd / 0.025852) - 1.0), current, current * 1e-3, "Shockley equation holds");
+        
+        // A transient step reaches the same point
+        ckt.Step(1e-6);
+        r.assertEqual(node2->Voltage, vd, 1e-6, "Transient solve matches the operating point");
+        r.assertTrue(ckt.GetNewtonStats().failedSteps == 0, "Newton converges");
+        
+        // Reverse bias: only leakage
+        CircuitBuilder reverse;
+        gnd = reverse.GetGround();
+        node1 = reverse.CreateNode();
+        node2 = reverse.CreateNode();
+        Diode* blocking = new Diode(1e-14);
+        reverse.AddComponent(new DCVoltageSource(-5.0), node1, gnd);
+        reverse.AddComponent(new Resistor(1000.0), node1, node2);
+        reverse.AddComponent(blocking, node2, gnd);
+        reverse.Step(1e-6);
+        r.assertEqual(node2->Voltage, -5.0, 1e-6, "Reverse-biased diode blocks");
+        r.assertTrue(std::abs(blocking->GetCurrent()) < 1e-9, "Only leakage current flows");
+    });
+
+    // Test a common-source MOSFET stage in saturation and triode
+    runner.runTest("Circuit: MOSFET common-source bias", [](TestRunner& r) {
+        const double gates[] = {3.0, 5.0, 0.5};
+        for (double vg : gates) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* supply = ckt.CreateNode();
+            Node* drain = ckt.CreateNode();
+            Node* gate = ckt.CreateNode();
+            Mosfet* fet = new Mosfet(1e-3, 1.0);
+            fet->SetGate(gate);
+            ckt.AddComponent(new DCVoltageSource(5.0), supply, gnd);
+            ckt.AddComponent(new DCVoltageSource(vg), gate, gnd);
+            ckt.AddComponent(new Resistor(1000.0), supply, drain);
+            ckt.AddComponent(fet, drain, gnd);
+            
+            r.assertTrue(ckt.SolveOperatingPoint(), "Operating point converges");
+            double vd = drain->Voltage;
+            double vov = vg - 1.0;
+            double expected = 0.0;
+            if (vov > 0.0) {
+                expected = (vd >= vov) ? 0.5e-3 * vov * vov : 1e-3 * (vov * vd - 0.5 * vd * vd);
+            }
+            r.assertEqual((5.0 - vd) / 1000.0, expected, 1e-8, "Drain current follows the square law");
+            r.assertEqual(fet->GetCurrent(), (5.0 - vd) / 1000.0, 1e-8, "Device current matches the load");
+        }
+    });
+
+    // Test circuits built with the arena factory methods
+    runner.runTest("Circuit: Arena-built RC ladder matches heap-built one", [](TestRunner& r) {
+        const int stages = 200;
+
+        CircuitBuilder heap;
+        std::vector<Node*> heapNodes;
+        Node* heapGround = new Node();
+        for (int k = 0; k <= stages; k++) heapNodes.push_back(new Node());
+        heap.AddComponent(new DCVoltageSource(1.0), heapNodes[0], heapGround);
+        for (int k = 0; k < stages; k++) {
+            heap.AddComponent(new Resistor(100.0), heapNodes[k], heapNodes[k + 1]);
+            heap.AddComponent(new Capacitor(1e-9), heapNodes[k + 1], heapGround);
+        }
+        heap.Simulate(1e-5, 1e-7);
+
+        CircuitBuilder arena;
+        std::vector<Node*> nodes;
+        Node* ground = arena.GetGround();
+        for (int k = 0; k <= stages; k++) nodes.push_back(arena.CreateNode());
+        DCVoltageSource* source = arena.AddDCVoltageSource(nodes[0], ground, 1.0);
+        for (int k = 0; k < stages; k++) {
+            arena.AddResistor(nodes[k], nodes[k + 1], 100.0);
+            arena.AddCapacitor(nodes[k + 1], ground, 1e-9);
+        }
+        // Types without a named factory and heap components mix with arena ones
+        Node* spare = arena.CreateNode();
+        arena.Add<CustomVoltageSource>(spare, ground, [](double t) { return t; });
+        arena.AddComponent(new Resistor(1e12), nodes[stages], ground);
+        arena.Simulate(1e-5, 1e-7);
+
+        r.assertTrue(arena.GetArena().Owns(source) && arena.GetArena().Owns(ground), "Factory objects live in the arena");
+        r.assertTrue(arena.GetArena().GetBlockCount() < 10, "Arena grows in a few large blocks");
+        r.assertTrue(arena.GetArena().GetDestructorCount() == 1, "Only the custom source needs its destructor run");
+        r.assertTrue(arena.GetNodes().size() == nodes.size() + 2, "Factory nodes are tracked");
+        r.assertEqual(spare->Voltage, 1e-5, 1e-12, "Generic factory component is simulated");
+        r.assertEqual(source->GetCurrent(), heap.GetVoltageSources()[0]->GetCurrent(), 1e-9, "Source currents should match");
+        for (int k = 0; k <= stages; k += 20) {
+            r.assertEqual(nodes[k]->Voltage, heapNodes[k]->Voltage, 1e-9, "Arena-built ladder should match");
+        }
+    });
+
+    // Test that a thread pool runs many short parallel loops with the same workers
+    runner.runTest("Circuit: Thread pool reuses its workers", [](TestRunner& r) {
+        ThreadPool pool(4);
+        r.assertTrue(pool.GetThreadCount() == 4, "The caller counts as a worker");
+
+        const size_t count = 16;
+        std::vector<std::atomic<int>> hits(count);
+        std::atomic<int> badWorker(0);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        for (int round = 0; round < 2000; round++) {
+            pool.Run(count, [&](size_t index, int worker) {
+                hits[index]++;
+                if (worker < 0 || worker >= 4) badWorker++;
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            });
+        }
+        bool all = true;
+        for (auto& hit : hits) all = all && hit == 2000;
+        r.assertTrue(all, "Every index runs once per loop");
+        r.assertTrue(badWorker == 0, "Worker indices stay in range");
+        r.assertTrue(threads.size() <= 4, "No threads beyond the pool's");
+
+        int inlineRuns = 0;
+        pool.Run(0, [&](size_t, int) { inlineRuns++; });
+        pool.Run(1, [&](size_t, int worker) { inlineRuns += worker == 0 ? 1 : 100; });
+        r.assertTrue(inlineRuns == 1, "Tiny loops run on the caller");
+    });
+
+    // Test per-circuit node numbering and circuits built on several threads at once
+    runner.runTest("Circuit: Per-circuit ground and parallel construction", [](TestRunner& r) {
+        // Legacy nodes far from ID 0 work once the ground is named
+        Node::nextId = 1000;
+        CircuitBuilder legacy;
+        Node* gnd = new Node();
+        Node* top = new Node();
+        Node* mid = new Node();
+        legacy.SetGround(gnd);
+        legacy.AddComponent(new DCVoltageSource(6.0), top, gnd);
+        legacy.AddComponent(new Resistor(1000.0), top, mid);
+        legacy.AddComponent(new Resistor(2000.0), mid, gnd);
+        legacy.Step(1e-6);
+        r.assertEqual(mid->Voltage, 4.0, 1e-9, "Named ground works whatever the global IDs");
+        r.assertTrue(gnd->Index == -1, "Named ground has no row");
+
+        // Divider chains built and simulated concurrently, each with its own numbering
+        const int circuits = 32;
+        std::vector<double> outputs(circuits, 0.0);
+        std::vector<int> lastIds(circuits, 0);
+        ParallelFor(circuits, 4, [&](size_t index, int) {
+            CircuitBuilder ckt;
+            Node* ground = ckt.GetGround();
+            Node* input = ckt.CreateNode();
+            ckt.AddDCVoltageSource(input, ground, 1.0 + index);
+            Node* previous = input;
+            for (int k = 0; k < 50; k++) {
+                Node* next = ckt.CreateNode();
+                ckt.AddResistor(previous, next, 100.0);
+                previous = next;
+            }
+            ckt.AddResistor(previous, ground, 5000.0);
+            ckt.Step(1e-6);
+            outputs[index] = previous->Voltage;
+            lastIds[index] = previous->Id;
+        });
+        r.assertTrue(Node::nextId == 1003, "Factory nodes don't use the global counter");
+        for (int k = 0; k < circuits; k++) {
+            r.assertTrue(lastIds[k] == 51, "Every circuit numbers its nodes from 1");
+            r.assertEqual(outputs[k], 0.5 * (1.0 + k), 1e-9, "Every circuit solves its own divider");
+        }
+    });
+
+    // Test SPICE value parsing
+    runner.runTest("Netlist: Values with scale suffixes and units", [](TestRunner& r) {
+        double value = 0.0;
+        r.assertTrue(NetlistLoader::ParseValue("4.7k", value), "Suffix parses");
+        r.assertEqual(value, 4700.0, 1e-9, "k is 1e3");
+        NetlistLoader::ParseValue("10pF", value);
+        r.assertEqual(value, 10e-12, 1e-24, "Unit after the suffix is ignored");
+        NetlistLoader::ParseValue("2MEG", value);
+        r.assertEqual(value, 2e6, 1e-6, "meg is 1e6, case-insensitive");
+        NetlistLoader::ParseValue("3m", value);
+        r.assertEqual(value, 3e-3, 1e-15, "m is milli");
+        NetlistLoader::ParseValue("1e-3u", value);
+        r.assertEqual(value, 1e-9, 1e-21, "Exponent and suffix combine");
+        NetlistLoader::ParseValue("+5V", value);
+        r.assertEqual(value, 5.0, 1e-12, "Leading sign and bare unit");
+        NetlistLoader::ParseValue("10mil", value);
+        r.assertEqual(value, 254e-6, 1e-15, "mil is 25.4um");
+        r.assertFalse(NetlistLoader::ParseValue("abc", value), "Non-numbers are rejected");
+    });
+
+    // Test a netlist against the same circuit built by hand
+    runner.runTest("Netlist: RC filter from a netlist matches hand-built circuit", [](TestRunner& r) {
+        const char* text =
+            "RC low-pass\n"
+            "* pulse into an RC filter\n"
+            "Vin IN 0 PULSE(0 1 10u 1u 1u\n"
+            "+ 50u 100u)\n"
+            "R1 in Out 1k ; series resistor\n"
+            "C1 out GND 10nF\n"
+            ".option reltol=1e-4\n"
+            ".tran 0.1u 200u\n"
+            ".end\n"
+            "R2 out 0 1\n";
+        CircuitBuilder loaded;
+        NetlistLoader loader;
+        r.assertTrue(loader.LoadString(text, loaded), "Netlist loads");
+        const NetlistInfo& info = loader.GetInfo();
+        r.assertTrue(info.title == "RC low-pass", "First line is the title");
+        r.assertTrue(info.elements == 3 && loaded.GetComponents().size() == 3, "Elements after .end are skipped");
+        r.assertTrue(info.nodes == 4 && loaded.GetNodes().size() == 3, "Names are case-insensitive and 0/gnd share ground");
+        r.assertTrue(info.ignoredCommands == 1, "Unknown dot commands are counted");
+        r.assertTrue(info.hasTran, ".tran is read");
+        r.assertEqual(info.tranStep, 1e-7, 1e-19, "Transient step");
+        r.assertEqual(info.tranStop, 2e-4, 1e-16, "Transient stop");
+        r.assertTrue(loader.GetNode("OUT") == loader.GetNode("out") && loader.GetNode("0") == loaded.GetGround(),
+                     "Nodes can be looked up by name");
+
+        CircuitBuilder manual;
+        Node* ground = manual.GetGround();
+        Node* in = manual.CreateNode();
+        Node* out = manual.CreateNode();
+        manual.AddComponent(new PulseVoltageSource(0.0, 1.0, 10e-6, 1e-6, 1e-6, 50e-6, 100e-6), in, ground);
+        manual.AddComponent(new Resistor(1000.0), in, out);
+        manual.AddComponent(new Capacitor(10e-9), out, ground);
+
+        loaded.Simulate(info.tranStop, info.tranStep);
+        manual.Simulate(info.tranStop, info.tranStep);
+        r.assertEqual(loader.GetNode("out")->Voltage, out->Voltage, 1e-12, "Loaded circuit matches the hand-built one");
+    });
+
+    // Test error reporting and loading a large netlist from a file
+    runner.runTest("Netlist: Errors and large file load", [](TestRunner& r) {
+        CircuitBuilder bad;
+        NetlistLoader loader;
+        r.assertFalse(loader.LoadString("title\nR1 a 0 1k\n\nQ1 a b c model\n", bad), "Unsupported element fails");
+        r.assertTrue(loader.GetInfo().errorLine == 4, "Error line is reported");
+        r.assertFalse(loader.GetInfo().error.empty(), "Error message is set");
+        r.assertFalse(loader.LoadString("title\nVs a 0 PWL(0 0 1u)\n", bad), "Odd PWL list fails");
+        r.assertFalse(loader.LoadString("title\nR1 a 0 1k\n(, =)\n", bad), "Statement without a name fails");
+        r.assertTrue(loader.GetInfo().errorLine == 3, "Empty statement line is reported");
+        r.assertFalse(loader.LoadFile("/nonexistent/ladder.cir", bad), "Missing file fails");
+
+        // Resistor ladder: source into n0, n_k -> n_k+1 in series, each node loaded to ground
+        const int stages = 20000;
+        std::string text = "ladder\nV1 n0 0 DC 1\n";
+        for (int k = 0; k < stages; k++) {
+            text += "Rs" + std::to_string(k) + " n" + std::to_string(k) + " n" + std::to_string(k + 1) + " 1\n";
+            text += "Rp" + std::to_string(k) + " n" + std::to_string(k + 1) + " 0 1meg\n";
+        }
+        std::string path = "ecim_netlist_test.cir";
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << text;
+        }
+        CircuitBuilder ladder;
+        ladder.SetSolverType(SolverType::SparseLU);
+        bool loaded = loader.LoadFile(path, ladder);
+        std::remove(path.c_str());
+        r.assertTrue(loaded, "Ladder loads from a file");
+        const NetlistInfo& info = loader.GetInfo();
+        r.assertTrue(info.elements == 2 * stages + 1, "All elements are added");
+        r.assertTrue(info.nodes == stages + 2, "All nodes are named once");
+        r.assertTrue(info.readSeconds >= 0.0 && info.parseSeconds > 0.0, "Load time is reported");
+
+        ladder.Step(1e-6);
+        r.assertEqual(loader.GetNode("n0")->Voltage, 1.0, 1e-9, "Source drives the first node");
+        r.assertTrue(loader.GetNode("n20000")->Voltage > 0.0 && loader.GetNode("n20000")->Voltage < loader.GetNode("n1")->Voltage,
+                     "Ladder attenuates along its length");
+    });
+
+    // Test saving a compiled circuit and starting from the binary image
+    runner.runTest("Snapshot: Reloaded circuit has the same layout and results", [](TestRunner& r) {
+        // One of every savable component type
+        auto build = [](CircuitBuilder& ckt, Node*& probe) {
+            Node* ground = ckt.GetGround();
+            Node* supply = ckt.CreateNode();
+            Node* drain = ckt.CreateNode();
+            Node* gate = ckt.CreateNode();
+            Node* pulse = ckt.CreateNode();
+            Node* filtered = ckt.CreateNode();
+            Node* ac = ckt.CreateNode();
+            Node* far = ckt.CreateNode();
+            ckt.AddDCVoltageSource(supply, ground, 5.0);
+            ckt.Add<PWLVoltageSource>(gate, ground, std::vector<std::pair<double, double>>{{0.0, 0.0}, {1e-5, 3.0}});
+            ckt.Add<PulseVoltageSource>(pulse, ground, 0.0, 1.0, 1e-6, 1e-7, 1e-7, 5e-6, 1e-5);
+            ckt.AddACVoltageSource(ac, ground, 0.5, 1e5, 0.3);
+            ckt.AddResistor(supply, drain, 1000.0);
+            Mosfet* fet = ckt.Add<Mosfet>(drain, ground, 1e-3, 1.0, 0.01);
+            fet->SetGate(gate);
+            ckt.AddResistor(pulse, filtered, 100.0);
+            ckt.AddCapacitor(filtered, ground, 1e-9);
+            ckt.Add<Diode>(filtered, ground, 1e-14, 1.5);
+            ckt.AddInductor(ac, far, 1e-4);
+
+            InterconnectNetwork line(1);
+            int previous = 0;
+            for (int k = 0; k < 20; k++) {
+                int next = line.AddNode();
+                line.AddResistor(previous, next, 10.0);
+                line.AddCapacitor(next, -1, 1e-11);
+                previous = next;
+            }
+            line.AddResistor(previous, -1, 1000.0);
+            ckt.AddComponent(line.Reduce(), std::vector<Node*>{far});
+            probe = far;
+            return drain;
+        };
+
+        CircuitBuilder original;
+        Node* originalProbe = nullptr;
+        Node* originalDrain = build(original, originalProbe);
+        original.SetSolverType(SolverType::SparseLU);
+        original.SetIntegrationMethod(IntegrationMethod::Trapezoidal);
+        original.Compile();
+        ColumnOrdering ordering = original.AnalyzeOrdering(1e-8);
+        original.SetColumnOrdering(ordering);
+
+        const std::string path = "ecim_snapshot_test.bin";
+        CircuitSnapshot snapshot;
+        r.assertTrue(snapshot.Save(original, path), "Compiled circuit saves");
+
+        CircuitBuilder loaded;
+        r.assertTrue(snapshot.Load(path, loaded), "Snapshot loads");
+        r.assertTrue(snapshot.GetError().empty() && snapshot.GetLoadSeconds() > 0.0, "Load time is reported");
+        r.assertTrue(loaded.GetMatrixSize() == original.GetMatrixSize() &&
+                     loaded.GetNodeRowCount() == original.GetNodeRowCount(), "Matrix layout is kept");
+        r.assertTrue(loaded.GetComponents().size() == original.GetComponents().size(), "Every component is restored");
+        r.assertTrue(loaded.GetSolverType() == SolverType::SparseLU &&
+                     loaded.GetIntegrationMethod() == IntegrationMethod::Trapezoidal, "Settings are restored");
+        r.assertTrue(loaded.GetColumnOrdering() && *loaded.GetColumnOrdering() == *ordering, "Ordering is restored");
+
+        Node* loadedProbe = snapshot.GetNode(originalProbe->Id);
+        Node* loadedDrain = snapshot.GetNode(originalDrain->Id);
+        r.assertTrue(loadedProbe && loadedProbe->Index == originalProbe->Index, "Nodes keep their rows");
+
+        original.Simulate(2e-5, 1e-8);
+        loaded.Simulate(2e-5, 1e-8);
+        r.assertEqual(loadedProbe->Voltage, originalProbe->Voltage, 1e-12, "Reloaded circuit simulates the same");
+        r.assertEqual(loadedDrain->Voltage, originalDrain->Voltage, 1e-12, "Devices are restored");
+
+        // Damaged and unsavable inputs are rejected
+        CircuitBuilder notEmpty;
+        notEmpty.CreateNode();
+        r.assertFalse(snapshot.Load(path, notEmpty), "Target must be empty");
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), bytes.size() / 2);
+        }
+        CircuitBuilder truncated;
+        r.assertFalse(snapshot.Load(path, truncated), "Truncated file is rejected");
+        std::remove(path.c_str());
+
+        CircuitBuilder custom;
+        custom.Add<CustomVoltageSource>(custom.CreateNode(), custom.GetGround(), [](double t) { return t; });
+        custom.Compile();
+        r.assertFalse(snapshot.Save(custom, path), "Custom sources have no binary form");
+        r.assertFalse(snapshot.GetError().empty(), "Save error is reported");
+        std::remove(path.c_str());
+    });
 }
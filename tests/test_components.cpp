@@ -1,6 +1,8 @@
 #include "test_framework.hpp"
 #include "../ecim/ecim.hpp"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 using namespace ecim;
 using namespace TestFramework;
@@ -91,6 +93,49 @@ void runBasicComponentTests(TestRunner& runner) {
         delete node2;
     });
 
+    // Test that packed stamps match the per-component stamps
+    runner.runTest("TwoTerminalArrays: Stamps match component stamps", [](TestRunner& r) {
+        Node* a = new Node();
+        Node* b = new Node();
+        a->Index = 0;
+        b->Index = 1;
+        Capacitor* c1 = new Capacitor(1e-6);
+        Capacitor* c2 = new Capacitor(2e-6);
+        c1->Connect(a, b);
+        c2->Connect(b, nullptr);
+        c1->SetInitialVoltage(0.5);
+        c2->SetInitialVoltage(-1.0);
+        std::vector<Capacitor*> capacitors = {c1, c2};
+
+        Eigen::MatrixXd G = Eigen::MatrixXd::Zero(2, 2), packedG = G;
+        Eigen::VectorXd I = Eigen::VectorXd::Zero(2), packedI = I;
+        SimulationState state{&G, nullptr, I, 1e-4, -1, 0.0};
+        for (auto capacitor : capacitors) capacitor->Stamp(state);
+
+        TwoTerminalArrays arrays;
+        arrays.Assign(capacitors);
+        for (size_t k = 0; k < capacitors.size(); k++) {
+            capacitors[k]->BeginStep(1e-4, IntegrationMethod::BackwardEuler, arrays.conductance[k], arrays.current[k]);
+        }
+        SimulationState packed{&packedG, nullptr, packedI, 1e-4, -1, 0.0};
+        arrays.StampConductances(packed);
+        arrays.StampCurrents(packedI);
+
+        r.assertTrue(arrays.row2[1] == -1, "Unconnected terminal is ground");
+        r.assertEqual((G - packedG).norm(), 0.0, 1e-15, "Packed conductances should match");
+        r.assertEqual((I - packedI).norm(), 0.0, 1e-15, "Packed currents should match");
+
+        Eigen::VectorXd x(2);
+        x << 2.0, 0.5;
+        r.assertEqual(arrays.Voltage(x, 0), 1.5, 1e-15, "Voltage across the first entry");
+        r.assertEqual(arrays.Voltage(x, 1), 0.5, 1e-15, "Voltage across the grounded entry");
+
+        delete c1;
+        delete c2;
+        delete a;
+        delete b;
+    });
+
     // Test Probe with Node
     runner.runTest("Probe: Node voltage measurement", [](TestRunner& r) {
         Node* node = new Node();
@@ -211,4 +256,67 @@ void runBasicComponentTests(TestRunner& runner) {
         
         delete vs;
     });
+
+    // Test PulseVoltageSource waveform and breakpoints
+    runner.runTest("PulseVoltageSource: Waveform and breakpoints", [](TestRunner& r) {
+        // 0 -> 5V after 1ms, 0.1ms edges, 0.4ms high, every 2ms
+        PulseVoltageSource* vs = new PulseVoltageSource(0.0, 5.0, 1e-3, 1e-4, 1e-4, 4e-4, 2e-3);
+
+        r.assertEqual(vs->GetVoltage(0.5e-3), 0.0, 1e-9, "Low before the delay");
+        r.assertEqual(vs->GetVoltage(1.05e-3), 2.5, 1e-9, "Halfway up the rising edge");
+        r.assertEqual(vs->GetVoltage(1.3e-3), 5.0, 1e-9, "High during the width");
+        r.assertEqual(vs->GetVoltage(1.55e-3), 2.5, 1e-9, "Halfway down the falling edge");
+        r.assertEqual(vs->GetVoltage(2.0e-3), 0.0, 1e-9, "Low after the pulse");
+        r.assertEqual(vs->GetVoltage(3.3e-3), 5.0, 1e-9, "Next period repeats");
+
+        r.assertEqual(vs->GetNextBreakpoint(0.0), 1.0e-3, 1e-12, "First breakpoint is the delay");
+        r.assertEqual(vs->GetNextBreakpoint(1.0e-3), 1.1e-3, 1e-12, "Top of the rising edge");
+        r.assertEqual(vs->GetNextBreakpoint(1.2e-3), 1.5e-3, 1e-12, "Start of the falling edge");
+        r.assertEqual(vs->GetNextBreakpoint(1.55e-3), 1.6e-3, 1e-12, "Bottom of the falling edge");
+        r.assertEqual(vs->GetNextBreakpoint(1.7e-3), 3.0e-3, 1e-12, "Start of the next period");
+
+        PulseVoltageSource single(1.0, 0.0, 0.0, 0.0, 0.0, 1e-3);
+        r.assertEqual(single.GetVoltage(0.0), 0.0, 1e-9, "Ideal edge applies at its time");
+        r.assertEqual(single.GetVoltage(1e-3), 1.0, 1e-9, "Back to v1 after the width");
+        r.assertTrue(std::isinf(single.GetNextBreakpoint(1e-3)), "Single pulse has no breakpoints after it");
+
+        delete vs;
+    });
+
+    // Test PWLVoltageSource interpolation and breakpoints
+    runner.runTest("PWLVoltageSource: Interpolation and breakpoints", [](TestRunner& r) {
+        PWLVoltageSource* vs = new PWLVoltageSource({{0.0, 0.0}, {2e-3, 0.0}, {1e-3, 2.0}, {3e-3, 1.0}});
+
+        r.assertTrue(vs->GetPointCount() == 4, "All points kept");
+        r.assertEqual(vs->GetVoltage(-1.0), 0.0, 1e-9, "First value before the first point");
+        r.assertEqual(vs->GetVoltage(0.5e-3), 1.0, 1e-9, "Interpolated on the first segment");
+        r.assertEqual(vs->GetVoltage(1.5e-3), 1.0, 1e-9, "Points are sorted by time");
+        r.assertEqual(vs->GetVoltage(2.5e-3), 0.5, 1e-9, "Interpolated on the last segment");
+        r.assertEqual(vs->GetVoltage(5e-3), 1.0, 1e-9, "Last value after the last point");
+
+        r.assertEqual(vs->GetNextBreakpoint(0.0), 1e-3, 1e-12, "Breakpoints are the points");
+        r.assertEqual(vs->GetNextBreakpoint(2.5e-3), 3e-3, 1e-12, "Breakpoints are the points");
+        r.assertTrue(std::isinf(vs->GetNextBreakpoint(3e-3)), "No breakpoint after the last point");
+
+        delete vs;
+    });
+
+    // Test that block evaluation matches sample-by-sample evaluation
+    runner.runTest("VoltageSource: Block evaluation matches GetVoltage", [](TestRunner& r) {
+        ACVoltageSource ac(2.0, 1234.5, 0.3);
+        DCVoltageSource dc(1.5);
+        CustomVoltageSource custom([](double t) { return t * t; });
+        PWLVoltageSource pwl({{1e-4, 0.0}, {2e-4, 1.0}, {2e-4, 3.0}, {5e-4, -1.0}});
+        PulseVoltageSource pulse(0.0, 1.0, 1e-4, 2e-5, 2e-5, 1e-4, 3e-4);
+
+        const int count = 1000;
+        const double start = 1e-5, step = 1e-6;
+        std::vector<double> values(count);
+        for (const VoltageSource* source : std::vector<const VoltageSource*>{&ac, &dc, &custom, &pwl, &pulse}) {
+            source->EvaluateBlock(start, step, count, values.data());
+            double error = 0.0;
+            for (int k = 0; k < count; k++) error = std::max(error, std::abs(values[k] - source->GetVoltage(start + k * step)));
+            r.assertTrue(error < 1e-12, "Block samples should match GetVoltage");
+        }
+    });
 }
@@ -1,6 +1,14 @@
 #include "test_framework.hpp"
 #include "../ecim/ecim.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace ecim;
 using namespace TestFramework;
@@ -220,4 +228,1263 @@ void runTransientTests(TestRunner& runner) {
         // After 5 seconds (5τ), should be > 99% charged (≈ 9.9V)
         r.assertTrue(node2->Voltage > 9.0, "After 5τ, capacitor should be nearly fully charged");
     });
+
+    // Test that a fixed-timestep LTI transient factors the matrix only once
+    runner.runTest("Transient: Factorization reuse at fixed timestep", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        
+        DCVoltageSource* vs = new DCVoltageSource(10.0);
+        Resistor* res = new Resistor(100.0);
+        Capacitor* cap = new Capacitor(0.01);    // τ = 1s
+        
+        ckt.AddComponent(vs, node1, gnd);
+        ckt.AddComponent(res, node1, node2);
+        ckt.AddComponent(cap, node2, gnd);
+        
+        ckt.Simulate(1.0, 0.01);
+        r.assertTrue(ckt.GetFactorizationCount() == 1, "Fixed-step LTI run should factor once");
+        r.assertTrue(node2->Voltage > 6.0 && node2->Voltage < 6.6, "After 1τ, capacitor should be ~63% charged");
+        
+        // A new timestep changes G
+        ckt.Simulate(0.1, 0.02);
+        r.assertTrue(ckt.GetFactorizationCount() == 2, "Changing dt should refactor once");
+        
+        // So does a new component value
+        res->SetResistance(50.0);
+        ckt.Step(0.02);
+        r.assertTrue(ckt.GetFactorizationCount() == 3, "Changing a resistance should refactor");
+        ckt.Step(0.02);
+        r.assertTrue(ckt.GetFactorizationCount() == 3, "Unchanged values should reuse the factorization");
+    });
+
+    // Test that a factorization the backend rejected is not cached
+    runner.runTest("Transient: Failed factorization is not reused", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::DenseLU);
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        Node* node3 = new Node();
+        
+        ckt.AddComponent(new DCVoltageSource(10.0), node1, gnd);
+        ckt.AddComponent(new Resistor(100.0), node1, gnd);
+        ckt.AddComponent(new Resistor(100.0), node2, node3);    // Floating pair: G is singular
+        
+        ckt.Step(0.01);
+        ckt.Step(0.01);
+        r.assertTrue(ckt.GetLinearSolver().GetStats().failedFactorizations == 2, "Singular G should fail to factor");
+        r.assertTrue(ckt.GetFactorizationCount() == 2, "A failed factorization should be retried");
+    });
+
+    // Test that the cached sparse factorization gives the same waveform as refactoring every step
+    runner.runTest("Transient: Sparse factorization reuse matches per-step refactoring", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::SparseLU);
+        
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        Node* node3 = new Node();
+        
+        Resistor* r1 = new Resistor(100.0);
+        ckt.AddComponent(new ACVoltageSource(5.0, 50.0), node1, gnd);
+        ckt.AddComponent(r1, node1, node2);
+        ckt.AddComponent(new Inductor(0.05), node2, node3);
+        ckt.AddComponent(new Capacitor(1e-4), node3, gnd);
+        
+        const double dt = 1e-4;
+        std::vector<double> cached;
+        for (int i = 0; i < 200; i++) {
+            ckt.Step(dt);
+            cached.push_back(node3->Voltage);
+        }
+        r.assertTrue(ckt.GetFactorizationCount() == 1, "Sparse fixed-step run should factor once");
+        
+        CircuitBuilder ref;
+        ref.SetSolverType(SolverType::SparseLU);
+        Node* rgnd = ref.GetGround();
+        Node* rnode1 = ref.CreateNode();
+        Node* rnode2 = ref.CreateNode();
+        Node* rnode3 = ref.CreateNode();
+        Resistor* rr1 = new Resistor(100.0);
+        ref.AddComponent(new ACVoltageSource(5.0, 50.0), rnode1, rgnd);
+        ref.AddComponent(rr1, rnode1, rnode2);
+        ref.AddComponent(new Inductor(0.05), rnode2, rnode3);
+        ref.AddComponent(new Capacitor(1e-4), rnode3, rgnd);
+        // Nudging the resistance by one ulp-scale step forces a refactorization every step
+        for (int i = 0; i < 200; i++) {
+            rr1->SetResistance(i % 2 ? 100.0 : 100.0 * (1.0 + 1e-15));
+            ref.Step(dt);
+            r.assertEqual(rnode3->Voltage, cached[i], 1e-9, "Cached and refactored waveforms should match");
+        }
+        r.assertTrue(ref.GetFactorizationCount() == 200, "Reference run should refactor every step");
+    });
+
+    // Test the warm-started iterative solver on an RC mesh against sparse LU
+    runner.runTest("Transient: Iterative solver warm start on RC mesh", [](TestRunner& r) {
+        const int side = 15;
+        
+        auto simulateMesh = [side](SolverType type, const IterativeSettings& settings, SolverStats& stats) {
+            CircuitBuilder ckt;
+            ckt.SetSolverType(type);
+            ckt.SetIterativeSettings(settings);
+            
+            Node* gnd = ckt.GetGround();
+            std::vector<Node*> grid;
+            for (int k = 0; k < side * side; k++) grid.push_back(ckt.CreateNode());
+            
+            ckt.AddComponent(new ACVoltageSource(1.0, 200.0), grid[0], gnd);
+            for (int y = 0; y < side; y++) {
+                for (int x = 0; x < side; x++) {
+                    Node* node = grid[y * side + x];
+                    if (x + 1 < side) ckt.AddComponent(new Resistor(10.0), node, grid[y * side + x + 1]);
+                    if (y + 1 < side) ckt.AddComponent(new Resistor(10.0), node, grid[(y + 1) * side + x]);
+                    ckt.AddComponent(new Capacitor(1e-6), node, gnd);
+                }
+            }
+            
+            ckt.Simulate(1e-3, 1e-5);
+            stats = ckt.GetLinearSolver().GetStats();
+            
+            std::vector<double> voltages;
+            for (auto node : grid) voltages.push_back(node->Voltage);
+            return voltages;
+        };
+        
+        IterativeSettings settings;
+        settings.fillFactor = 1;  // Sparse ILU so each step needs several iterations
+        SolverStats directStats, warmStats, coldStats, gmresStats;
+        std::vector<double> direct = simulateMesh(SolverType::SparseLU, settings, directStats);
+        std::vector<double> warm = simulateMesh(SolverType::Iterative, settings, warmStats);
+        
+        settings.warmStart = false;
+        simulateMesh(SolverType::Iterative, settings, coldStats);
+        
+        settings.warmStart = true;
+        settings.method = KrylovMethod::GMRES;
+        settings.preconditioner = Preconditioner::Jacobi;
+        std::vector<double> gmres = simulateMesh(SolverType::Iterative, settings, gmresStats);
+        
+        r.assertTrue(warmStats.converged && gmresStats.converged, "Iterative solves should converge");
+        r.assertTrue(warmStats.iterations > 0, "Iterations per step should be reported");
+        r.assertTrue(warmStats.totalIterations < coldStats.totalIterations,
+                     "Warm start should need fewer iterations than a cold start");
+        for (size_t k = 0; k < direct.size(); k++) {
+            r.assertEqual(warm[k], direct[k], 1e-7, "BiCGSTAB/ILU result should match sparse LU");
+            r.assertEqual(gmres[k], direct[k], 1e-7, "GMRES/Jacobi result should match sparse LU");
+        }
+    });
+
+    // Test the iteration limit control
+    runner.runTest("Transient: Iterative solver iteration limit", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        ckt.SetSolverType(SolverType::Iterative);
+        
+        IterativeSettings settings;
+        settings.method = KrylovMethod::GMRES;
+        settings.maxIterations = 1;
+        settings.preconditioner = Preconditioner::Jacobi;
+        settings.tolerance = 1e-14;
+        ckt.SetIterativeSettings(settings);
+        
+        Node* gnd = new Node();
+        std::vector<Node*> nodes;
+        for (int k = 0; k < 20; k++) nodes.push_back(new Node());
+        ckt.AddComponent(new DCVoltageSource(1.0), nodes[0], gnd);
+        for (int k = 0; k + 1 < 20; k++) ckt.AddComponent(new Resistor(1.0 + k), nodes[k], nodes[k + 1]);
+        ckt.AddComponent(new Resistor(1.0), nodes[19], gnd);
+        
+        ckt.Step(1e-6);
+        
+        const SolverStats& stats = ckt.GetLinearSolver().GetStats();
+        r.assertTrue(stats.iterations <= 1, "Solve should stop at the iteration limit");
+        r.assertFalse(stats.converged, "A single Jacobi iteration should not converge on a 20-node chain");
+    });
+
+    // Test the Schur-complement partitioned backend on an RC mesh against sparse LU
+    runner.runTest("Transient: Partitioned solver on RC mesh", [](TestRunner& r) {
+        const int side = 24;
+
+        auto simulateMesh = [side](SolverType type, PartitionStats& partition, SolverStats& stats) {
+            CircuitBuilder ckt;
+            ckt.SetSolverType(type);
+            PartitionSettings settings;
+            settings.domains = 4;
+            settings.threads = 4;
+            ckt.SetPartitionSettings(settings);
+
+            Node* gnd = ckt.GetGround();
+            std::vector<Node*> grid;
+            for (int k = 0; k < side * side; k++) grid.push_back(ckt.CreateNode());
+
+            ckt.AddComponent(new ACVoltageSource(1.0, 200.0), grid[0], gnd);
+            ckt.AddComponent(new DCVoltageSource(0.5), grid[side * side / 2 + side / 2], gnd);
+            for (int y = 0; y < side; y++) {
+                for (int x = 0; x < side; x++) {
+                    Node* node = grid[y * side + x];
+                    if (x + 1 < side) ckt.AddComponent(new Resistor(10.0), node, grid[y * side + x + 1]);
+                    if (y + 1 < side) ckt.AddComponent(new Resistor(10.0), node, grid[(y + 1) * side + x]);
+                    ckt.AddComponent(new Capacitor(1e-6), node, gnd);
+                }
+            }
+            ckt.GetLinearSolver().SetComputeResidual(true);
+
+            ckt.Simulate(1e-3, 1e-5);
+            stats = ckt.GetLinearSolver().GetStats();
+            if (auto partitioned = dynamic_cast<PartitionedSolver*>(&ckt.GetLinearSolver())) {
+                partition = partitioned->GetPartitionStats();
+            }
+
+            std::vector<double> voltages;
+            for (auto node : grid) voltages.push_back(node->Voltage);
+            return voltages;
+        };
+
+        PartitionStats partition, unused;
+        SolverStats directStats, stats;
+        std::vector<double> direct = simulateMesh(SolverType::SparseLU, unused, directStats);
+        std::vector<double> split = simulateMesh(SolverType::Partitioned, partition, stats);
+
+        r.assertTrue(partition.GetDomainCount() == 4, "Mesh should be split into the requested domains");
+        r.assertTrue(partition.partitions == 1, "Partition is computed once for a fixed pattern");
+        r.assertTrue(partition.interfaceSize > 0, "Domains should couple through an interface");
+        r.assertTrue(partition.InterfaceFraction() < 0.2, "Interface should be a small part of the system");
+        r.assertTrue(partition.Imbalance() < 1.5, "Domains should be balanced");
+        r.assertTrue(partition.domainFactorSeconds.size() == 4 && partition.domainSolveSeconds.size() == 4,
+                     "Timing should be reported per domain");
+        r.assertFalse(stats.fallback, "Partitioned factorization should not fall back to sparse LU");
+        r.assertTrue(stats.residual < 1e-10, "Partitioned residual should be small");
+        for (size_t k = 0; k < direct.size(); k++) {
+            r.assertEqual(split[k], direct[k], 1e-9, "Partitioned result should match sparse LU");
+        }
+    });
+
+    // Test that the multirate mode freezes an idle block and wakes it when its source steps
+    runner.runTest("Transient: Multirate freezes idle partitions", [](TestRunner& r) {
+        const int stages = 32;
+
+        // Block A is driven by a sine, block B sits at its DC level until its source steps at 2ms
+        auto simulate = [stages](bool latency, LatencyStats& stats, std::vector<double>& held, std::string& csv) {
+            CircuitBuilder ckt;
+            ckt.SetSolverType(SolverType::SparseLU);
+            LatencySettings settings;
+            settings.enabled = latency;
+            ckt.SetLatencySettings(settings);
+
+            Node* gnd = ckt.GetGround();
+            std::vector<Node*> a, b;
+            for (int k = 0; k < stages; k++) a.push_back(ckt.CreateNode());
+            for (int k = 0; k < stages; k++) b.push_back(ckt.CreateNode());
+
+            ckt.AddComponent(new ACVoltageSource(1.0, 1000.0), a[0], gnd);
+            ckt.AddComponent(new CustomVoltageSource([](double t) { return t < 2e-3 ? 1.0 : 2.0; }), b[0], gnd);
+            for (int k = 0; k + 1 < stages; k++) {
+                ckt.AddComponent(new Resistor(100.0), a[k], a[k + 1]);
+                ckt.AddComponent(new Resistor(100.0), b[k], b[k + 1]);
+            }
+            for (int k = 0; k < stages; k++) {
+                ckt.AddComponent(new Capacitor(1e-7), a[k], gnd);
+                ckt.AddComponent(new Capacitor(1e-7), b[k], gnd);
+            }
+            ckt.AddComponent(new Resistor(1e4), b[stages - 1], gnd);
+
+            std::ostringstream out;
+            ProbeConfig config;
+            config.continuous = true;
+            config.stream = &out;
+            config.node = b[stages - 1];
+            config.format = ProbeOutputFormat::CSV;
+            ckt.AddProbe(config);
+
+            ckt.SolveOperatingPoint();
+            ckt.Simulate(1.9e-3, 1e-5);
+            held.clear();
+            for (auto node : b) held.push_back(node->Voltage);
+            ckt.Simulate(2e-3, 1e-5);
+
+            stats = ckt.GetLatencyStats();
+            csv = out.str();
+            std::vector<double> voltages;
+            for (auto node : a) voltages.push_back(node->Voltage);
+            for (auto node : b) voltages.push_back(node->Voltage);
+            return voltages;
+        };
+
+        LatencyStats stats, referenceStats;
+        std::vector<double> held, referenceHeld;
+        std::string csv, referenceCsv;
+        std::vector<double> voltages = simulate(true, stats, held, csv);
+        std::vector<double> reference = simulate(false, referenceStats, referenceHeld, referenceCsv);
+
+        r.assertTrue(referenceStats.steps == 0, "Latency is off by default");
+        r.assertTrue(stats.steps == 390, "Every step goes through the multirate path");
+        r.assertTrue(stats.freezes >= 2, "Idle block B should be frozen");
+        r.assertTrue(stats.wakeups >= 2, "Source step should wake block B");
+        r.assertTrue(stats.LatentFraction() > 0.2, "Block B should be frozen until its source steps");
+        r.assertTrue(std::count(csv.begin(), csv.end(), '\n') == std::count(referenceCsv.begin(), referenceCsv.end(), '\n'),
+                     "Continuous probes record every step of frozen nodes");
+        for (size_t k = 0; k < held.size(); k++) {
+            r.assertEqual(held[k], referenceHeld[k], 1e-5, "Frozen block holds its DC level");
+        }
+        for (size_t k = 0; k < reference.size(); k++) {
+            r.assertEqual(voltages[k], reference[k], 1e-4, "Multirate result should match the full solve");
+        }
+    });
+
+    // Test that a reduced interconnect model tracks the element-by-element network
+    runner.runTest("Transient: Reduced interconnect matches full network", [](TestRunner& r) {
+        // 400-segment RC line with a series inductance at the near end, ports at both ends
+        const int segments = 400;
+        InterconnectNetwork line(2);
+        int previous = line.AddNode();
+        line.AddInductor(0, previous, 1e-9);
+        for (int k = 0; k < segments; k++) {
+            int next = k + 1 < segments ? line.AddNode() : 1;
+            line.AddResistor(previous, next, 2.5);
+            line.AddCapacitor(next, -1, 25e-15);
+            previous = next;
+        }
+
+        ReductionReport report;
+        ReducedNetwork* reduced = line.Reduce(ReductionSettings(), &report);
+        r.assertTrue(reduced != nullptr, "Line has a DC path from every node");
+        if (!reduced) return;
+        r.assertTrue(report.fullOrder == segments + 1, "Full order counts internal nodes and inductor currents");
+        r.assertTrue(report.reducedOrder > 0 && report.reducedOrder <= 16, "Reduced order is a few block moments");
+        r.assertTrue(report.frequencies.size() == report.errors.size(), "One error per check frequency");
+        r.assertTrue(report.dcError < 1e-9, "DC admittance is matched exactly");
+        r.assertTrue(report.maxError < 1e-2, "Port admittance stays accurate over the checked band");
+
+        auto simulate = [&line, &r](ReducedNetwork* model, std::vector<double>& far) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* source = ckt.CreateNode();
+            Node* nearEnd = ckt.CreateNode();
+            Node* farEnd = ckt.CreateNode();
+
+            ckt.AddComponent(new DCVoltageSource(1.0), source, gnd);
+            ckt.AddComponent(new Resistor(50.0), source, nearEnd);
+            ckt.AddComponent(new Resistor(10e3), farEnd, gnd);
+            ckt.AddComponent(new Capacitor(1e-12), farEnd, gnd);
+            if (model) {
+                ckt.AddComponent(model, {nearEnd, farEnd});
+            } else {
+                line.Expand(ckt, {nearEnd, farEnd}, gnd);
+                bool numbered = true;
+                for (Node* node : ckt.GetNodes()) {
+                    numbered = numbered && ckt.GetArena().Owns(node) && (node == gnd || node->Id > 0);
+                }
+                r.assertTrue(numbered, "Expanded nodes are numbered by the circuit and live in its arena");
+            }
+
+            for (int step = 0; step < 1000; step++) {
+                ckt.Step(0.1e-9);
+                far.push_back(farEnd->Voltage);
+            }
+            return ckt.GetMatrixSize();
+        };
+
+        std::vector<double> fullWave, reducedWave;
+        int fullSize = simulate(nullptr, fullWave);
+        int reducedSize = simulate(reduced, reducedWave);
+
+        r.assertTrue(reducedSize < fullSize / 10, "Reduced circuit has no internal rows");
+        r.assertTrue(fullWave.back() > 0.85, "Far end charges towards the divided source voltage");
+        for (size_t k = 0; k < fullWave.size(); k++) {
+            r.assertEqual(reducedWave[k], fullWave[k], 5e-3, "Reduced far-end waveform should match the full line");
+        }
+    });
+
+    // Test that an ensemble run matches separate simulations of each instance
+    runner.runTest("Transient: Ensemble matches individual simulations", [](TestRunner& r) {
+        const int instances = 6;
+        const double resistances[instances] = { 900.0, 950.0, 1000.0, 1050.0, 1100.0, 1000.0 };
+        const double gains[instances] = { 1.0, 1.0, 1.0, 1.0, 1.0, 0.5 };
+        const double dt = 1e-4;
+        const int steps = 50;
+        
+        // Reference: one CircuitBuilder per instance
+        std::vector<double> reference;
+        for (int k = 0; k < instances; k++) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            Node* node3 = ckt.CreateNode();
+            ckt.AddComponent(new ACVoltageSource(5.0 * gains[k], 200.0), node1, gnd);
+            ckt.AddComponent(new Resistor(resistances[k]), node1, node2);
+            ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+            ckt.AddComponent(new Resistor(2000.0), node2, node3);
+            ckt.AddComponent(new Capacitor(4.7e-7), node3, gnd);
+            for (int i = 0; i < steps; i++) {
+                ckt.Step(dt);
+                reference.push_back(node3->Voltage);
+            }
+        }
+        
+        // Ensemble: one topology, per-instance values
+        CircuitBuilder ckt;
+        Node* gnd = ckt.GetGround();
+        Node* node1 = ckt.CreateNode();
+        Node* node2 = ckt.CreateNode();
+        Node* node3 = ckt.CreateNode();
+        ACVoltageSource* vs = new ACVoltageSource(5.0, 200.0);
+        Resistor* r1 = new Resistor(1000.0);
+        ckt.AddComponent(vs, node1, gnd);
+        ckt.AddComponent(r1, node1, node2);
+        ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+        ckt.AddComponent(new Resistor(2000.0), node2, node3);
+        ckt.AddComponent(new Capacitor(4.7e-7), node3, gnd);
+        
+        EnsembleSimulator ensemble(ckt, instances);
+        double* values = ensemble.ResistanceValues(r1);
+        double* sourceGains = ensemble.SourceGains(vs);
+        r.assertNotNull(values, "Resistor should have per-instance values");
+        r.assertNotNull(sourceGains, "Source should have per-instance gains");
+        for (int k = 0; k < instances; k++) {
+            values[k] = resistances[k];
+            sourceGains[k] = gains[k];
+        }
+        int probe = ensemble.AddProbe(node3);
+        
+        ensemble.Simulate(steps * dt, dt);
+        
+        r.assertTrue(ensemble.GetSampleCount() == static_cast<size_t>(steps), "One sample per step");
+        r.assertTrue(ensemble.GetSamples().size() == static_cast<size_t>(steps * instances), "Samples share one buffer");
+        for (int k = 0; k < instances; k++) {
+            for (int i = 0; i < steps; i++) {
+                r.assertEqual(ensemble.GetSample(i, probe, k), reference[k * steps + i], 1e-9,
+                              "Ensemble instance should match its individual simulation");
+            }
+        }
+    });
+
+    // Test ensemble inductor state against the analytic RL step response
+    runner.runTest("Transient: Ensemble RL step response", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        Inductor* ind = new Inductor(0.1);
+        ckt.AddComponent(new DCVoltageSource(10.0), node1, gnd);
+        ckt.AddComponent(new Resistor(100.0), node1, node2);
+        ckt.AddComponent(ind, node2, gnd);
+        
+        // τ = L/R: 1ms and 2ms
+        EnsembleSimulator ensemble(ckt, 2);
+        ensemble.InductanceValues(ind)[1] = 0.2;
+        int probe = ensemble.AddProbe(node2);
+        
+        const double dt = 1e-6;
+        ensemble.Simulate(1e-3, dt);
+        
+        // Inductor voltage decays as 10 * e^(-t/τ)
+        size_t last = ensemble.GetSampleCount() - 1;
+        r.assertEqual(ensemble.GetSample(last, probe, 0), 10.0 * std::exp(-1.0), 1e-2, "τ=1ms instance after 1ms");
+        r.assertEqual(ensemble.GetSample(last, probe, 1), 10.0 * std::exp(-0.5), 1e-2, "τ=2ms instance after 1ms");
+    });
+
+    // Test that the ensemble refuses circuits it would simulate wrongly
+    runner.runTest("Transient: Ensemble refuses unsupported circuits", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* ground = ckt.GetGround();
+        Node* in = ckt.CreateNode();
+        Node* out = ckt.CreateNode();
+        ckt.AddDCVoltageSource(in, ground, 5.0);
+        ckt.AddResistor(in, out, 1000.0);
+        ckt.Add<Diode>(out, ground);
+
+        EnsembleSimulator ensemble(ckt, 4);
+        ensemble.AddProbe(out);
+        r.assertFalse(ensemble.GetError().empty(), "Nonlinear devices are refused");
+        r.assertFalse(ensemble.Simulate(1e-5, 1e-6), "Simulate() refuses to run");
+        r.assertTrue(ensemble.GetSampleCount() == 0, "Nothing is recorded");
+
+        CircuitBuilder interconnect;
+        Node* source = interconnect.CreateNode();
+        Node* far = interconnect.CreateNode();
+        interconnect.AddDCVoltageSource(source, interconnect.GetGround(), 1.0);
+        interconnect.AddResistor(far, interconnect.GetGround(), 1e4);
+        InterconnectNetwork line(2);
+        int middle = line.AddNode();
+        line.AddResistor(0, middle, 10.0);
+        line.AddResistor(middle, 1, 10.0);
+        line.AddCapacitor(middle, -1, 1e-12);
+        interconnect.AddComponent(line.Reduce(), {source, far});
+
+        EnsembleSimulator reduced(interconnect, 4);
+        r.assertFalse(reduced.GetError().empty(), "Reduced networks are refused");
+        r.assertFalse(reduced.Simulate(1e-9, 1e-10), "Simulate() refuses to run");
+    });
+
+    // Test a large ensemble: dense batched factors of this size would need gigabytes
+    runner.runTest("Transient: Ensemble of a large RC ladder", [](TestRunner& r) {
+        const int sections = 3000;
+        const int instances = 256;
+        const double dt = 1e-6;
+        const int steps = 20;
+
+        auto build = [sections](CircuitBuilder& ckt, double scale, std::vector<Resistor*>& resistors) {
+            ckt.SetSolverType(SolverType::SparseLU);
+            Node* ground = ckt.GetGround();
+            Node* previous = ckt.CreateNode();
+            ckt.AddACVoltageSource(previous, ground, 1.0, 10000.0);
+            for (int k = 0; k < sections; k++) {
+                Node* next = ckt.CreateNode();
+                resistors.push_back(ckt.AddResistor(previous, next, 10.0 * scale));
+                ckt.AddCapacitor(next, ground, 1e-9);
+                previous = next;
+            }
+            return previous;
+        };
+
+        std::vector<Resistor*> resistors;
+        CircuitBuilder ckt;
+        Node* end = build(ckt, 1.0, resistors);
+        Node* middle = ckt.GetNodes()[sections / 2];
+        EnsembleSimulator ensemble(ckt, instances);
+        for (Resistor* resistor : resistors) {
+            double* values = ensemble.ResistanceValues(resistor);
+            for (int k = 0; k < instances; k++) values[k] = 10.0 * (1.0 + 0.002 * k);
+        }
+        int endProbe = ensemble.AddProbe(end);
+        int middleProbe = ensemble.AddProbe(middle);
+        ensemble.Simulate(steps * dt, dt);
+        r.assertTrue(ensemble.GetSampleCount() == static_cast<size_t>(steps), "One sample per step");
+
+        // Spot-check a few instances against plain simulations
+        for (int k : {0, 101, instances - 1}) {
+            std::vector<Resistor*> unused;
+            CircuitBuilder reference;
+            Node* referenceEnd = build(reference, 1.0 + 0.002 * k, unused);
+            Node* referenceMiddle = reference.GetNodes()[sections / 2];
+            reference.Simulate(steps * dt, dt);
+            r.assertEqual(ensemble.GetSample(steps - 1, endProbe, k), referenceEnd->Voltage, 1e-9, "Ladder end matches");
+            r.assertEqual(ensemble.GetSample(steps - 1, middleProbe, k), referenceMiddle->Voltage, 1e-9, "Ladder middle matches");
+        }
+    });
+
+    // Test parallel parameter sweep against serial simulations of each value
+    runner.runTest("Transient: Parameter sweep matches serial simulations", [](TestRunner& r) {
+        const std::vector<double> resistances = {500.0, 1000.0, 1500.0, 2200.0, 3300.0, 4700.0, 6800.0};
+        const double dt = 1e-5;
+        const int steps = 100;
+        
+        auto build = [](CircuitBuilder& ckt, Resistor* r1, Node*& out) {
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            out = ckt.CreateNode();
+            ckt.SetSolverType(SolverType::SparseLU);
+            ckt.AddComponent(new ACVoltageSource(5.0, 200.0), node1, gnd);
+            ckt.AddComponent(r1, node1, node2);
+            ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+            ckt.AddComponent(new Resistor(2000.0), node2, out);
+            ckt.AddComponent(new Capacitor(4.7e-7), out, gnd);
+        };
+        
+        // Serial reference: one circuit per value
+        std::vector<std::vector<double>> reference;
+        for (double resistance : resistances) {
+            CircuitBuilder ckt;
+            Node* out = nullptr;
+            build(ckt, new Resistor(resistance), out);
+            std::vector<double> samples;
+            for (int i = 0; i < steps; i++) {
+                ckt.Step(dt);
+                samples.push_back(out->Voltage);
+            }
+            reference.push_back(samples);
+        }
+        
+        CircuitBuilder ckt;
+        Node* out = nullptr;
+        Resistor* r1 = new Resistor(1000.0);
+        build(ckt, r1, out);
+        ParameterSweep sweep(ckt, r1, SweepParameter::Resistance);
+        int voltageProbe = sweep.AddProbe(out);
+        int currentProbe = sweep.AddProbe(r1);
+        r.assertTrue(voltageProbe == 0, "First probe index");
+        r.assertTrue(currentProbe == 1, "Second probe index");
+        Node foreign;
+        r.assertTrue(sweep.AddProbe(&foreign) == -1, "Foreign node is rejected");
+        sweep.SetThreadCount(4);
+        
+        auto results = sweep.Run(resistances, steps * dt, dt);
+        
+        r.assertTrue(results.size() == resistances.size(), "One result per value");
+        for (size_t k = 0; k < results.size(); k++) {
+            r.assertEqual(results[k].value, resistances[k], 1e-12, "Results keep the value order");
+            r.assertTrue(results[k].times.size() == static_cast<size_t>(steps), "One sample per step");
+            for (int i = 0; i < steps; i++) {
+                r.assertEqual(results[k].GetSample(i, voltageProbe), reference[k][i], 1e-9,
+                              "Sweep point should match its serial simulation");
+            }
+        }
+        r.assertEqual(r1->GetResistance(), 1000.0, 1e-12, "Original circuit keeps its value");
+        r.assertEqual(ckt.GetCurrentTime(), 0.0, 1e-12, "Original circuit isn't advanced");
+        r.assertFalse(ckt.IsCompiled(), "The ordering is analyzed on a clone");
+        r.assertTrue(ckt.GetLinearSolver().GetColumnOrdering() == nullptr, "Original circuit doesn't adopt the ordering");
+        
+        // A parameter the target doesn't have
+        ParameterSweep invalid(ckt, r1, SweepParameter::Frequency);
+        r.assertTrue(invalid.Run(resistances, steps * dt, dt).empty(), "Mismatched parameter yields no results");
+    });
+
+    // Test that sweep points step exactly like Simulate(), breakpoints included
+    runner.runTest("Transient: Parameter sweep lands on source breakpoints", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* ground = ckt.GetGround();
+        Node* in = ckt.CreateNode();
+        Node* out = ckt.CreateNode();
+        ckt.Add<PulseVoltageSource>(in, ground, 0.0, 1.0, 3.3e-5, 2e-6, 2e-6, 4.1e-5, 1e-4);
+        Resistor* resistor = ckt.AddResistor(in, out, 1000.0);
+        ckt.AddCapacitor(out, ground, 1e-8);
+
+        const std::vector<double> resistances = {500.0, 1000.0, 2000.0};
+        const double dt = 1e-5;
+        ParameterSweep sweep(ckt, resistor, SweepParameter::Resistance);
+        int probe = sweep.AddProbe(out);
+        auto results = sweep.Run(resistances, 3e-4, dt);
+        r.assertTrue(results.size() == resistances.size(), "One result per value");
+
+        for (size_t k = 0; k < results.size(); k++) {
+            auto reference = ckt.Clone();
+            ParameterSweep::SetParameter(reference->GetComponents()[1], SweepParameter::Resistance, resistances[k]);
+            Node* referenceOut = reference->GetNodes()[2];
+            std::vector<double> times, samples;
+            reference->Simulate(3e-4, dt, [&]() {
+                times.push_back(reference->GetCurrentTime());
+                samples.push_back(referenceOut->Voltage);
+            });
+
+            r.assertTrue(results[k].times.size() == times.size(), "Same steps as Simulate()");
+            r.assertTrue(times.size() > 30, "Breakpoints add steps");
+            bool same = results[k].times.size() == times.size();
+            for (size_t i = 0; same && i < times.size(); i++) {
+                same = results[k].times[i] == times[i] && results[k].GetSample(i, probe) == samples[i];
+            }
+            r.assertTrue(same, "Sweep point reproduces its Simulate() run");
+        }
+    });
+
+    // Test adaptive timestep against the analytic response of a sine-driven RC circuit
+    runner.runTest("Transient: Adaptive timestep RC sine response", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        ckt.AddComponent(new ACVoltageSource(5.0, 50.0), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+        
+        std::stringstream output;
+        ProbeConfig config;
+        config.node = node2;
+        config.continuous = true;
+        config.stream = &output;
+        config.format = ProbeOutputFormat::CSV;
+        ckt.AddProbe(config);
+        
+        AdaptiveSettings settings;
+        settings.relTol = 1e-3;
+        settings.initialStep = 1e-5;
+        ckt.SimulateAdaptive(40e-3, settings);
+        
+        const AdaptiveStats& stats = ckt.GetAdaptiveStats();
+        r.assertEqual(ckt.GetCurrentTime(), 40e-3, 1e-12, "Run ends exactly at the requested time");
+        r.assertTrue(stats.acceptedSteps < 1000, "Steps grow beyond the initial step");
+        
+        // Continuous probe rows: one per accepted step with its actual time.
+        // v(t) = A/(1+(ωτ)²) * (sin ωt - ωτ cos ωt + ωτ e^(-t/τ))
+        const double tau = 1e-3;
+        const double PI = 3.14159265358979323846;
+        const double omega = 2.0 * PI * 50.0;
+        const double wt = omega * tau;
+        std::string line;
+        std::getline(output, line);  // Header
+        size_t rows = 0;
+        double lastTime = 0.0;
+        double maxError = 0.0;
+        while (std::getline(output, line)) {
+            double t = std::stod(line.substr(0, line.find(',')));
+            double v = std::stod(line.substr(line.find(',') + 1));
+            r.assertTrue(t > lastTime, "Probe timestamps increase");
+            lastTime = t;
+            rows++;
+            double expected = 5.0 / (1.0 + wt * wt) * (std::sin(omega * t) - wt * std::cos(omega * t) + wt * std::exp(-t / tau));
+            maxError = std::max(maxError, std::abs(v - expected));
+        }
+        r.assertTrue(rows == stats.acceptedSteps, "Probes only see accepted steps");
+        r.assertEqual(lastTime, 40e-3, 1e-9, "Last probe sample at the end time");
+        r.assertTrue(maxError < 0.05, "Adaptive response tracks the analytic solution");
+    });
+
+    // Test step rejection and recovery at a source edge
+    runner.runTest("Transient: Adaptive timestep rejects steps at an edge", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        ckt.AddComponent(new CustomVoltageSource([](double t) { return t >= 5e-3 ? 5.0 : 0.0; }), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+        
+        AdaptiveSettings settings;
+        settings.initialStep = 1e-5;
+        ckt.SimulateAdaptive(20e-3, settings);
+        
+        const AdaptiveStats& stats = ckt.GetAdaptiveStats();
+        r.assertTrue(stats.rejectedSteps > 0, "The edge rejects steps");
+        r.assertTrue(stats.largestStep > 100.0 * stats.smallestStep, "Steps shrink at the edge and grow afterwards");
+        r.assertEqual(ckt.GetCurrentTime(), 20e-3, 1e-12, "Run ends exactly at the requested time");
+        r.assertEqual(node2->Voltage, 5.0, 1e-3, "Capacitor settles after 15 time constants");
+    });
+
+    // Test that fixed-step runs land on pulse breakpoints instead of stepping over edges
+    runner.runTest("Transient: Steps land on pulse breakpoints", [](TestRunner& r) {
+        const double tau = 1e-3;
+        // 0 -> 1V over 10us at 0.35ms, back down over 10us at 2.36ms
+        auto pulse = [](double t) {
+            PulseVoltageSource source(0.0, 1.0, 0.35e-3, 1e-5, 1e-5, 2e-3);
+            return source.GetVoltage(t);
+        };
+        // RC response with each edge approximated by an ideal step at its midpoint
+        auto expected = [tau](double t) {
+            if (t < 0.355e-3) return 0.0;
+            double top = 1.0 - std::exp(-(std::min(t, 2.365e-3) - 0.355e-3) / tau);
+            return t < 2.365e-3 ? top : top * std::exp(-(t - 2.365e-3) / tau);
+        };
+
+        auto simulate = [&](bool native, std::vector<double>& times) {
+            CircuitBuilder ckt;
+            ckt.SetIntegrationMethod(IntegrationMethod::Trapezoidal);
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            if (native) ckt.AddComponent(new PulseVoltageSource(0.0, 1.0, 0.35e-3, 1e-5, 1e-5, 2e-3), node1, gnd);
+            else ckt.AddComponent(new CustomVoltageSource(pulse), node1, gnd);
+            ckt.AddComponent(new Resistor(1000.0), node1, node2);
+            ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+
+            std::stringstream output;
+            ProbeConfig config;
+            config.node = node2;
+            config.continuous = true;
+            config.stream = &output;
+            config.format = ProbeOutputFormat::CSV;
+            ckt.AddProbe(config);
+            ckt.Simulate(4e-3, 1e-4);
+
+            std::string line;
+            std::getline(output, line);  // Header
+            double error = 0.0;
+            while (std::getline(output, line)) {
+                double t = std::stod(line.substr(0, line.find(',')));
+                double v = std::stod(line.substr(line.find(',') + 1));
+                times.push_back(t);
+                error = std::max(error, std::abs(v - expected(t)));
+            }
+            return error;
+        };
+
+        std::vector<double> times, customTimes;
+        double error = simulate(true, times);
+        double customError = simulate(false, customTimes);
+
+        for (double breakpoint : {0.35e-3, 0.36e-3, 2.36e-3, 2.37e-3}) {
+            bool hit = false;
+            for (double t : times) hit = hit || std::abs(t - breakpoint) < 1e-12;
+            r.assertTrue(hit, "A step ends on every breakpoint");
+        }
+        r.assertTrue(times.size() < customTimes.size() + 8, "Breakpoints add only a few steps");
+        r.assertTrue(times.back() > 4e-3 - 1e-5, "Run covers the duration");
+        r.assertTrue(error < 0.01, "Response with breakpoints tracks the analytic solution");
+        r.assertTrue(error < 0.5 * customError, "Landing on the edges beats stepping over them");
+    });
+
+    // Test that block-evaluated sources give the same transient as per-step evaluation
+    runner.runTest("Transient: Block-evaluated sources match per-step evaluation", [](TestRunner& r) {
+        auto simulate = [](int blockSize) {
+            CircuitBuilder ckt;
+            ckt.SetSourceBlockSize(blockSize);
+            Node* gnd = ckt.GetGround();
+            Node* sum = ckt.CreateNode();
+            std::vector<Node*> inputs;
+            for (int k = 0; k < 3; k++) inputs.push_back(ckt.CreateNode());
+
+            ckt.AddComponent(new ACVoltageSource(1.0, 730.0, 0.2), inputs[0], gnd);
+            ckt.AddComponent(new PWLVoltageSource({{0.0, 0.0}, {1e-3, 2.0}, {2.5e-3, -1.0}}), inputs[1], gnd);
+            ckt.AddComponent(new CustomVoltageSource([](double t) { return std::exp(-t / 1e-3); }), inputs[2], gnd);
+            for (auto input : inputs) ckt.AddComponent(new Resistor(1000.0), input, sum);
+            ckt.AddComponent(new Capacitor(1e-6), sum, gnd);
+
+            std::vector<double> trace;
+            for (int chunk = 0; chunk < 6; chunk++) {
+                ckt.Simulate(0.5e-3, 1e-5);
+                trace.push_back(sum->Voltage);
+            }
+            return trace;
+        };
+
+        std::vector<double> blocked = simulate(64);
+        std::vector<double> single = simulate(0);
+        r.assertTrue(blocked.size() == single.size(), "Same number of samples");
+        for (size_t k = 0; k < blocked.size(); k++) {
+            r.assertEqual(blocked[k], single[k], 1e-9, "Block evaluation should not change the response");
+        }
+    });
+
+    // Test second-order methods against the analytic sine-driven RC response
+    runner.runTest("Transient: Trapezoidal and BDF2 accuracy", [](TestRunner& r) {
+        const double PI = 3.14159265358979323846;
+        const double tau = 1e-3;
+        const double omega = 2.0 * PI * 50.0;
+        const double wt = omega * tau;
+        
+        // Largest error over 20-40ms (after the start-up transient) with a given method and step
+        auto maxError = [&](IntegrationMethod method, double dt) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            ckt.AddComponent(new ACVoltageSource(5.0, 50.0), node1, gnd);
+            ckt.AddComponent(new Resistor(1000.0), node1, node2);
+            ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+            ckt.SetIntegrationMethod(method);
+            
+            double error = 0.0;
+            int steps = static_cast<int>(40e-3 / dt + 0.5);
+            for (int i = 0; i < steps; i++) {
+                ckt.Step(dt);
+                double t = ckt.GetCurrentTime();
+                if (t < 20e-3) continue;
+                double expected = 5.0 / (1.0 + wt * wt) * (std::sin(omega * t) - wt * std::cos(omega * t) + wt * std::exp(-t / tau));
+                error = std::max(error, std::abs(node2->Voltage - expected));
+            }
+            return error;
+        };
+        
+        double euler = maxError(IntegrationMethod::BackwardEuler, 1e-5);
+        double trapezoidal = maxError(IntegrationMethod::Trapezoidal, 1e-4);
+        double bdf2 = maxError(IntegrationMethod::BDF2, 1e-4);
+        
+        // Second-order methods with a 10x larger step are still more accurate
+        r.assertTrue(trapezoidal < euler, "Trapezoidal at 10x dt beats backward Euler");
+        r.assertTrue(bdf2 < euler, "BDF2 at 10x dt beats backward Euler");
+        
+        // Error scales with h^2: 10x smaller step, ~100x smaller error
+        r.assertTrue(maxError(IntegrationMethod::Trapezoidal, 1e-5) < trapezoidal / 50.0, "Trapezoidal is second order");
+        r.assertTrue(maxError(IntegrationMethod::BDF2, 1e-5) < bdf2 / 50.0, "BDF2 is second order");
+    });
+
+    // Test the exact inductor current against the analytic RL step response
+    runner.runTest("Transient: Inductor current tracks RL step response", [](TestRunner& r) {
+        const IntegrationMethod methods[] = {
+            IntegrationMethod::BackwardEuler, IntegrationMethod::Trapezoidal, IntegrationMethod::BDF2
+        };
+        const double tolerances[] = {1e-3, 1e-5, 1e-5};
+        
+        for (int m = 0; m < 3; m++) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            Inductor* ind = new Inductor(0.1);
+            ckt.AddComponent(new DCVoltageSource(10.0), node1, gnd);
+            ckt.AddComponent(new Resistor(100.0), node1, node2);
+            ckt.AddComponent(ind, node2, gnd);
+            ckt.SetIntegrationMethod(methods[m]);
+            
+            // τ = L/R = 1ms, I(t) = 0.1 * (1 - e^(-t/τ))
+            ckt.Simulate(1e-3, 1e-5);
+            r.assertEqual(ind->GetCurrent(), 0.1 * (1.0 - std::exp(-1.0)), tolerances[m], "Inductor current after one time constant");
+            r.assertEqual(node2->Voltage, 10.0 - 100.0 * ind->GetCurrent(), 1e-9, "Inductor current matches the resistor drop");
+        }
+    });
+
+    // Test that start-up, steady stepping and method changes reuse the factorization
+    runner.runTest("Transient: Second-order factorization reuse", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        ckt.AddComponent(new ACVoltageSource(5.0, 50.0), node1, gnd);
+        ckt.AddComponent(new Resistor(1000.0), node1, node2);
+        ckt.AddComponent(new Capacitor(1e-6), node2, gnd);
+        ckt.SetIntegrationMethod(IntegrationMethod::BDF2);
+        
+        ckt.Simulate(1e-2, 1e-5);
+        
+        // Backward Euler start-up step, then constant-step BDF2
+        r.assertTrue(ckt.GetFactorizationCount() == 2, "BDF2 refactors once after start-up");
+        
+        ckt.SetIntegrationMethod(IntegrationMethod::Trapezoidal);
+        ckt.Simulate(1e-2, 1e-5);
+        r.assertTrue(ckt.GetFactorizationCount() == 3, "Switching method refactors once");
+    });
+
+    // Test DC operating point of an RC divider and a transient starting from it
+    runner.runTest("Transient: DC operating point seeds capacitor state", [](TestRunner& r) {
+        const IntegrationMethod methods[] = {
+            IntegrationMethod::BackwardEuler, IntegrationMethod::Trapezoidal, IntegrationMethod::BDF2
+        };
+        for (auto method : methods) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            Node* node3 = ckt.CreateNode();
+            DCVoltageSource* vs = new DCVoltageSource(10.0);
+            Capacitor* c1 = new Capacitor(1e-6);
+            ckt.AddComponent(vs, node1, gnd);
+            ckt.AddComponent(new Resistor(1000.0), node1, node2);
+            ckt.AddComponent(new Resistor(1000.0), node2, gnd);
+            ckt.AddComponent(c1, node2, gnd);
+            ckt.AddComponent(new Capacitor(1e-6), node2, node3);   // node3 is only reached through a capacitor
+            ckt.AddComponent(new Capacitor(1e-6), node3, gnd);
+            ckt.SetIntegrationMethod(method);
+            
+            r.assertTrue(ckt.SolveOperatingPoint(), "Operating point solves");
+            r.assertEqual(node2->Voltage, 5.0, 1e-6, "Divider midpoint");
+            r.assertEqual(c1->GetVoltage(), 5.0, 1e-6, "Capacitor voltage is seeded");
+            r.assertEqual(vs->GetCurrent(), -5e-3, 1e-9, "Source current (flows out of the positive terminal)");
+            r.assertEqual(node3->Voltage, 0.0, 1e-6, "Capacitor-only node held by gmin");
+            r.assertEqual(ckt.GetCurrentTime(), 0.0, 1e-15, "Operating point doesn't advance time");
+            
+            // The transient starts in steady state instead of charging from zero
+            ckt.Simulate(1e-3, 1e-5);
+            r.assertEqual(node2->Voltage, 5.0, 1e-6, "Transient stays at the operating point");
+        }
+    });
+
+    // Test DC operating point with an inductor as a short
+    runner.runTest("Transient: DC operating point seeds inductor current", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* gnd = new Node();
+        Node* node1 = new Node();
+        Node* node2 = new Node();
+        Inductor* ind = new Inductor(0.1);
+        ckt.AddComponent(new DCVoltageSource(10.0), node1, gnd);
+        ckt.AddComponent(new Resistor(100.0), node1, node2);
+        ckt.AddComponent(ind, node2, gnd);
+        ckt.SetSolverType(SolverType::DenseLU);
+        
+        r.assertTrue(ckt.SolveOperatingPoint(), "Operating point solves");
+        r.assertEqual(ind->GetCurrent(), 0.1, 1e-9, "Inductor carries the full current");
+        r.assertEqual(node2->Voltage, 0.0, 1e-9, "Shorted inductor has no voltage");
+        
+        ckt.Simulate(1e-3, 1e-5);
+        r.assertEqual(ind->GetCurrent(), 0.1, 1e-9, "Transient stays at the operating point");
+    });
+
+    // Test a half-wave rectifier and the Newton bypass / Jacobian reuse statistics
+    runner.runTest("Transient: Half-wave rectifier with Newton-Raphson", [](TestRunner& r) {
+        // Peak output and Newton statistics for a given setting
+        auto run = [](bool reuse, double bypass, double& peak) {
+            CircuitBuilder ckt;
+            Node* gnd = ckt.GetGround();
+            Node* node1 = ckt.CreateNode();
+            Node* node2 = ckt.CreateNode();
+            Diode* diode = new Diode();
+            ckt.AddComponent(new ACVoltageSource(5.0, 50.0), node1, gnd);
+            ckt.AddComponent(diode, node1, node2);
+            ckt.AddComponent(new Resistor(1000.0), node2, gnd);
+            ckt.AddComponent(new Capacitor(1e-4), node2, gnd);
+            
+            NewtonSettings settings;
+            settings.reuseJacobian = reuse;
+            settings.bypassTolerance = bypass;
+            ckt.SetNewtonSettings(settings);
+            
+            peak = 0.0;
+            for (int i = 0; i < 4000; i++) {
+                ckt.Step(1e-5);
+                peak = std::max(peak, node2->Voltage);
+            }
+            return ckt.GetNewtonStats();
+        };
+        
+        double peak = 0.0, referencePeak = 0.0;
+        NewtonStats stats = run(true, 1e-6, peak);
+        NewtonStats reference = run(false, 0.0, referencePeak);
+        
+        r.assertTrue(stats.steps == 4000, "One Newton solve per step");
+        r.assertTrue(stats.failedSteps == 0 && reference.failedSteps == 0, "Every step converges");
+        r.assertTrue(peak > 4.0 && peak < 4.6, "Output charges to the peak minus a diode drop");
+        // Both runs stop at the Newton tolerance (relTol 1e-3 of ~4.3 V)
+        r.assertEqual(peak, referencePeak, 5e-3, "Bypass and Jacobian reuse stay within the Newton tolerance");
+        r.assertTrue(stats.IterationsPerStep() < 4.0, "Few iterations per step");
+        r.assertTrue(stats.BypassRate() > 0.0, "Devices are bypassed");
+        r.assertTrue(stats.factorizations < reference.factorizations, "Jacobian reuse saves factorizations");
+        r.assertTrue(reference.factorizations == reference.iterations, "Full Newton factors every iteration");
+    });
+
+    // Test checkpoints: resume a run, continue it in another circuit and fork it
+    runner.runTest("Transient: Checkpoint resumes and forks a run", [](TestRunner& r) {
+        // Pulse into an RC filter and a series RL load, trapezoidal, optionally with a clamp diode
+        auto build = [](CircuitBuilder& ckt, bool diode) {
+            Node* ground = ckt.GetGround();
+            Node* in = ckt.CreateNode();
+            Node* filtered = ckt.CreateNode();
+            Node* mid = ckt.CreateNode();
+            ckt.Add<PulseVoltageSource>(in, ground, 0.0, 2.0, 1e-6, 2e-7, 2e-7, 3e-6, 8e-6);
+            ckt.AddResistor(in, filtered, 500.0);
+            ckt.AddCapacitor(filtered, ground, 2e-9);
+            ckt.AddInductor(filtered, mid, 1e-3);
+            ckt.AddResistor(mid, ground, 200.0);
+            if (diode) ckt.Add<Diode>(filtered, ground, 1e-14, 1.0);
+            ckt.SetIntegrationMethod(IntegrationMethod::Trapezoidal);
+            return filtered;
+        };
+
+        for (bool diode : {false, true}) {
+            CircuitBuilder reference, prefix, resumed;
+            Node* referenceOut = build(reference, diode);
+            Node* prefixOut = build(prefix, diode);
+            Node* resumedOut = build(resumed, diode);
+
+            reference.Simulate(1e-5, 1e-8);
+            reference.Simulate(1e-5, 1e-8);
+
+            prefix.Simulate(1e-5, 1e-8);
+            const std::string path = "ecim_checkpoint_test.bin";
+            r.assertTrue(prefix.SaveCheckpoint().Write(path), "Checkpoint file is written");
+            Checkpoint checkpoint;
+            r.assertTrue(checkpoint.Read(path), "Checkpoint file is read back");
+            std::remove(path.c_str());
+
+            r.assertTrue(resumed.RestoreCheckpoint(checkpoint), "Checkpoint fits a circuit of the same layout");
+            r.assertEqual(resumed.GetCurrentTime(), 1e-5, 1e-18, "Clock is restored");
+            resumed.Simulate(1e-5, 1e-8);
+            // Exact for the linear circuit; with the diode the refactored Jacobian
+            // converges to a slightly different point within the Newton tolerance
+            const double tolerance = diode ? 1e-3 : 1e-12;
+            r.assertEqual(resumedOut->Voltage, referenceOut->Voltage, tolerance, "Resumed run continues the reference");
+            r.assertEqual(resumed.GetInductors()[0]->GetCurrent(), reference.GetInductors()[0]->GetCurrent(),
+                          tolerance * 1e-2, "Inductor current continues");
+            if (diode) continue;
+
+            // Fork what-if continuations from the same prefix
+            Checkpoint fork = prefix.SaveCheckpoint();
+            prefix.Simulate(1e-5, 1e-8);
+            r.assertEqual(prefixOut->Voltage, referenceOut->Voltage, 1e-12, "Saving doesn't disturb the run");
+            Resistor* prefixLoad = prefix.GetResistors()[1];
+            prefixLoad->SetResistance(50.0);
+            r.assertTrue(prefix.RestoreCheckpoint(fork), "Circuit returns to its own checkpoint");
+            prefix.Simulate(1e-5, 1e-8);
+            const double heavy = prefix.GetInductors()[0]->GetCurrent();
+            prefixLoad->SetResistance(200.0);
+            prefix.RestoreCheckpoint(fork);
+            prefix.Simulate(1e-5, 1e-8);
+            r.assertEqual(prefixOut->Voltage, referenceOut->Voltage, 1e-12, "Unchanged fork repeats the reference");
+            r.assertTrue(std::abs(heavy) > std::abs(prefix.GetInductors()[0]->GetCurrent()), "Heavier load draws more current");
+
+            CircuitBuilder other;
+            other.AddResistor(other.CreateNode(), other.GetGround(), 1.0);
+            r.assertFalse(other.RestoreCheckpoint(fork), "Checkpoint doesn't fit another layout");
+            r.assertFalse(checkpoint.Read("/nonexistent/checkpoint.bin"), "Missing file fails");
+        }
+    });
+
+    // Test binary waveform output of continuous probes, read back while the run goes on
+    runner.runTest("Probe: Binary waveform output readable during the run", [](TestRunner& r) {
+        const std::string path = "ecim_waveform_test.bin";
+        CircuitBuilder ckt;
+        Node* ground = ckt.GetGround();
+        Node* in = ckt.CreateNode();
+        Node* out = ckt.CreateNode();
+        ckt.AddACVoltageSource(in, ground, 5.0, 50.0);
+        Resistor* resistor = ckt.AddResistor(in, out, 1000.0);
+        ckt.AddCapacitor(out, ground, 1e-6);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        std::ostringstream csv;
+        ProbeConfig config;
+        config.continuous = true;
+        config.format = ProbeOutputFormat::Binary;
+        config.stream = &file;
+        config.node = out;
+        config.label = "out";
+        r.assertTrue(ckt.AddProbe(config) != nullptr, "Binary voltage probe");
+        config.node = nullptr;
+        config.component = resistor;
+        config.mode = ProbeMode::Current;
+        config.label = "r1";
+        r.assertTrue(ckt.AddProbe(config) != nullptr, "Binary current probe shares the file");
+        config.format = ProbeOutputFormat::CSV;
+        config.stream = &csv;
+        ckt.AddProbe(config);
+
+        // Several full blocks and a partial one, then more samples appended
+        ckt.Simulate(10000 * 1e-5, 1e-5);
+        WaveformReader reader;
+        r.assertTrue(reader.Open(path), "File is readable during the run");
+        r.assertTrue(reader.GetRowCount() == 10000, "Every step is written by the end of Simulate()");
+        r.assertTrue(reader.GetColumnCount() == 2, "One column per probe");
+        r.assertTrue(reader.GetLabel(0) == "out_voltage" && reader.GetUnit(0) == "V", "Voltage column name and unit");
+        r.assertTrue(reader.GetLabel(1) == "r1_current" && reader.GetUnit(1) == "A", "Current column name and unit");
+        r.assertEqual(reader.GetValue(9999, 0), out->Voltage, 0.0, "Samples are raw doubles");
+        r.assertEqual(reader.GetValue(9999, 1), resistor->GetCurrent(), 0.0, "Current samples");
+
+        ckt.Simulate(500 * 1e-5, 1e-5);
+        r.assertTrue(ckt.AddProbe(config) != nullptr, "Text probes can still be added");
+        config.format = ProbeOutputFormat::Binary;
+        config.stream = &file;
+        r.assertTrue(ckt.AddProbe(config) == nullptr, "Columns are fixed once samples are written");
+
+        r.assertTrue(reader.Open(path) && reader.GetRowCount() == 10500, "Reopening picks up appended samples");
+        std::vector<double> times = reader.GetTimes();
+        std::vector<double> currents = reader.GetColumn(1);
+        r.assertTrue(times.size() == 10500 && currents.size() == 10500, "Whole columns");
+        bool increasing = true;
+        for (size_t k = 1; k < times.size(); k++) increasing = increasing && times[k] > times[k - 1];
+        r.assertTrue(increasing, "Times increase across blocks");
+        r.assertEqual(reader.GetTime(4096), times[4096], 0.0, "Row access across a block boundary");
+
+        std::string line;
+        std::istringstream rows(csv.str());
+        std::getline(rows, line);
+        for (size_t k = 0; k < 5000 && std::getline(rows, line); k++) {
+            if (k % 997 != 0) continue;
+            r.assertEqual(std::stod(line.substr(line.find(',') + 1)), currents[k], 1e-9, "Binary and CSV output agree");
+        }
+
+        // A partly written block at the end is left out
+        file.write("\x05\0\0\0\0\0\0\0\0\0", 10);
+        file.flush();
+        r.assertTrue(reader.Open(path) && reader.GetRowCount() == 10500, "Incomplete trailing block is ignored");
+        file.close();
+
+        // A column count the header can't hold fails instead of allocating it
+        std::string damaged;
+        {
+            std::ifstream in(path, std::ios::binary);
+            damaged.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        damaged.replace(16, 4, "\xff\xff\xff\x7f", 4);
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(damaged.data(), damaged.size());
+        r.assertFalse(reader.Open(path), "Oversized column count is rejected");
+        r.assertFalse(reader.GetError().empty(), "Damaged header is reported");
+        std::remove(path.c_str());
+        r.assertFalse(reader.Open(path), "Missing file fails");
+
+        // A flush before the first sample writes the header, which fixes the columns too
+        std::ostringstream early(std::ios::binary);
+        ProbeManager manager;
+        ProbeConfig first;
+        first.continuous = true;
+        first.format = ProbeOutputFormat::Binary;
+        first.stream = &early;
+        first.node = out;
+        r.assertTrue(manager.AddProbe(first) != nullptr, "First column");
+        manager.Flush();
+        first.label = "late";
+        r.assertTrue(manager.AddProbe(first) == nullptr, "No column after the header is written");
+        manager.UpdateContinuousProbes(1.0);
+        manager.Flush();
+        r.assertTrue(early.str().size() == 24 + 16 + 8 + 2 * sizeof(double), "Samples have only the first column");
+
+        // Without a Flush() nothing is written, not even from the destructor, so the
+        // stream may go away before the probes do
+        {
+            ProbeManager unflushed;
+            auto stream = std::make_unique<std::ostringstream>(std::ios::binary);
+            first.stream = stream.get();
+            r.assertTrue(unflushed.AddProbe(first) != nullptr, "Probe on a short-lived stream");
+            unflushed.UpdateContinuousProbes(1.0);
+            r.assertTrue(stream->str().empty(), "Samples stay buffered until Flush()");
+            stream.reset();
+        }
+    });
+
+    // Test the wide CSV sink: all probes of a stream in one table with a shared time column
+    runner.runTest("Probe: Wide CSV sink writes one row per step", [](TestRunner& r) {
+        CircuitBuilder ckt;
+        Node* ground = ckt.GetGround();
+        Node* in = ckt.CreateNode();
+        Node* out = ckt.CreateNode();
+        ckt.AddACVoltageSource(in, ground, 5.0, 50.0);
+        Resistor* resistor = ckt.AddResistor(in, out, 1000.0);
+        ckt.AddCapacitor(out, ground, 1e-6);
+
+        std::ostringstream table;
+        std::ostringstream csv;
+        std::ostringstream binary;
+        ProbeConfig config;
+        config.continuous = true;
+        config.format = ProbeOutputFormat::WideCSV;
+        config.stream = &table;
+        config.node = out;
+        config.label = "out";
+        r.assertTrue(ckt.AddProbe(config) != nullptr, "Wide CSV voltage probe");
+        config.node = nullptr;
+        config.component = resistor;
+        config.mode = ProbeMode::Current;
+        config.label = "r1";
+        r.assertTrue(ckt.AddProbe(config) != nullptr, "Wide CSV current probe shares the table");
+        config.format = ProbeOutputFormat::Binary;
+        r.assertTrue(ckt.AddProbe(config) == nullptr, "A table stream can't also hold a waveform file");
+        config.format = ProbeOutputFormat::CSV;
+        config.stream = &csv;
+        ckt.AddProbe(config);
+
+        ckt.Simulate(2000 * 1e-5, 1e-5);
+        config.format = ProbeOutputFormat::WideCSV;
+        config.stream = &table;
+        r.assertTrue(ckt.AddProbe(config) == nullptr, "Columns are fixed once rows are written");
+
+        std::string line;
+        std::istringstream rows(table.str());
+        std::getline(rows, line);
+        r.assertTrue(line == "time,out_voltage,r1_current", "Header names every column once");
+        std::istringstream perProbe(csv.str());
+        std::string csvLine;
+        std::getline(perProbe, csvLine);
+        size_t count = 0;
+        std::string last;
+        while (std::getline(rows, line)) {
+            std::getline(perProbe, csvLine);
+            if (count % 331 == 0) {
+                r.assertEqual(std::stod(line), std::stod(csvLine), 1e-9, "Shared time column");
+                r.assertEqual(std::stod(line.substr(line.rfind(',') + 1)),
+                              std::stod(csvLine.substr(csvLine.find(',') + 1)), 1e-9, "Wide and per-probe CSV agree");
+            }
+            last = line;
+            count++;
+        }
+        r.assertTrue(count == 2000, "One row per step");
+        const size_t first = last.find(',');
+        const size_t second = last.find(',', first + 1);
+        r.assertEqual(std::stod(last.substr(first + 1, second - first - 1)), out->Voltage, 0.0, "Values round-trip exactly");
+        r.assertEqual(std::stod(last.substr(second + 1)), resistor->GetCurrent(), 0.0, "Current values round-trip exactly");
+
+        // Rows go out in whole chunks: a small buffer writes before Flush(), and only complete rows
+        std::ostringstream chunked;
+        CSVTableWriter writer(chunked, 256);
+        r.assertTrue(writer.AddColumn("a") && writer.AddColumn("b"), "Columns before the first row");
+        const double values[2] = {0.1, -2.5e-300};
+        for (int k = 0; k < 100; k++) writer.Append(k / 1000.0, values);
+        r.assertFalse(writer.AddColumn("c"), "No columns after the first row");
+        const std::string partial = chunked.str();
+        r.assertTrue(!partial.empty() && partial.back() == '\n', "Buffer is written out in whole rows");
+        writer.Flush();
+        const std::string all = chunked.str();
+        r.assertTrue(writer.GetRowCount() == 100 && std::count(all.begin(), all.end(), '\n') == 101, "Every row after Flush()");
+        r.assertTrue(all.find("\n0.099,0.1,-2.5e-300\n") != std::string::npos, "Shortest round-trip formatting");
+
+        // Rows that were never flushed are dropped rather than written from the destructor
+        std::ostringstream dropped;
+        {
+            CSVTableWriter unflushed(dropped);
+            unflushed.AddColumn("a");
+            unflushed.Append(0.0, values);
+        }
+        r.assertTrue(dropped.str() == "time,a\n", "Destructor doesn't write buffered rows");
+    });
 }